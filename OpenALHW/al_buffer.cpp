@@ -4,7 +4,9 @@
 #include <sce_atomic.h>
 
 #include "common.h"
+#include "record.h"
 #include "context.h"
+#include "device.h"
 #include "named_object.h"
 
 using namespace al;
@@ -61,9 +63,11 @@ ALint Buffer::init()
 
 	m_frequency = 44100;
 	m_channels = 1;
-	m_data = (ALint)m_storage;
+	m_data = (intptr_t)m_storage;
 	m_size = 64;
 
+	_alCounterAdd(Counter_BufferBytes, m_size);
+
 	return AL_NO_ERROR;
 }
 
@@ -73,6 +77,8 @@ ALint Buffer::release()
 	{
 		AL_FREE(m_storage);
 		m_storage = NULL;
+
+		_alCounterAdd(Counter_BufferBytes, -m_size);
 	}
 
 	m_initialized = AL_FALSE;
@@ -99,6 +105,7 @@ AL_API void AL_APIENTRY alGenBuffers(ALsizei n, ALuint* buffers)
 	Buffer *pBuf = NULL;
 	ALint ret = AL_NO_ERROR;
 	Context *ctx = (Context *)alcGetCurrentContext();
+	DeviceNGS *ngsDev = NULL;
 
 	AL_TRACE_CALL
 
@@ -108,6 +115,8 @@ AL_API void AL_APIENTRY alGenBuffers(ALsizei n, ALuint* buffers)
 		return;
 	}
 
+	ngsDev = (DeviceNGS *)ctx->getDevice();
+
 	if (buffers == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_VALUE);
@@ -125,10 +134,14 @@ AL_API void AL_APIENTRY alGenBuffers(ALsizei n, ALuint* buffers)
 			return;
 		}
 
-		ctx->m_bufferStack.push_back(pBuf);
+		ngsDev->lockBuffers();
+		ngsDev->m_bufferStack.push_back(pBuf);
+		ngsDev->unlockBuffers();
 
-		buffers[i] = _alNamedObjectAdd((ALint)pBuf);
+		buffers[i] = _alNamedObjectAdd((intptr_t)pBuf);
 	}
+
+	AL_RECORD_OBJECTS(RecordOp_GenBuffers, 0, n, buffers)
 }
 
 AL_API void AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint* buffers)
@@ -136,15 +149,20 @@ AL_API void AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint* buffers)
 	Buffer *pBuf = NULL;
 	ALint ret = AL_NO_ERROR;
 	Context *ctx = (Context *)alcGetCurrentContext();
+	DeviceNGS *ngsDev = NULL;
 
 	AL_TRACE_CALL
 
+	AL_RECORD_OBJECTS(RecordOp_DeleteBuffers, 0, n, buffers)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
 		return;
 	}
 
+	ngsDev = (DeviceNGS *)ctx->getDevice();
+
 	if (buffers == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_VALUE);
@@ -176,7 +194,9 @@ AL_API void AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint* buffers)
 
 		_alNamedObjectRemove(buffers[i]);
 
-		ctx->m_bufferStack.erase(std::remove(ctx->m_bufferStack.begin(), ctx->m_bufferStack.end(), pBuf), ctx->m_bufferStack.end());
+		ngsDev->lockBuffers();
+		ngsDev->m_bufferStack.erase(std::remove(ngsDev->m_bufferStack.begin(), ngsDev->m_bufferStack.end(), pBuf), ngsDev->m_bufferStack.end());
+		ngsDev->unlockBuffers();
 
 		delete pBuf;
 	}
@@ -186,7 +206,7 @@ AL_API ALboolean AL_APIENTRY alIsBuffer(ALuint bid)
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, 0)
 
 	if (ctx == NULL)
 	{
@@ -207,7 +227,9 @@ AL_API void AL_APIENTRY alBufferData(ALuint bid, ALenum format, const ALvoid* da
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, size)
+
+	AL_RECORD_BUFFER_DATA(bid, format, data, size, freq)
 
 	if (ctx == NULL)
 	{
@@ -268,6 +290,8 @@ AL_API void AL_APIENTRY alBufferData(ALuint bid, ALenum format, const ALvoid* da
 	{
 		AL_FREE(buf->m_storage);
 		buf->m_storage = NULL;
+
+		_alCounterAdd(Counter_BufferBytes, -buf->m_size);
 	}
 
 	if (buf->m_bits == 8)
@@ -281,7 +305,10 @@ AL_API void AL_APIENTRY alBufferData(ALuint bid, ALenum format, const ALvoid* da
 		}
 
 		buf->m_size = size * 2;
-		buf->m_data = (ALint)data;
+
+		_alCounterAdd(Counter_BufferBytes, buf->m_size);
+
+		buf->m_data = (intptr_t)data;
 		buf->m_frequency = freq;
 		buf->m_bits = 16;
 
@@ -304,7 +331,10 @@ AL_API void AL_APIENTRY alBufferData(ALuint bid, ALenum format, const ALvoid* da
 		}
 
 		buf->m_size = size;
-		buf->m_data = (ALint)data;
+
+		_alCounterAdd(Counter_BufferBytes, buf->m_size);
+
+		buf->m_data = (intptr_t)data;
 		buf->m_frequency = freq;
 
 		memcpy(buf->m_storage, data, size);
@@ -316,7 +346,7 @@ AL_API void AL_APIENTRY alBufferf(ALuint bid, ALenum param, ALfloat value)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -340,7 +370,7 @@ AL_API void AL_APIENTRY alBuffer3f(ALuint bid, ALenum param, ALfloat value1, ALf
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -364,7 +394,7 @@ AL_API void AL_APIENTRY alBufferfv(ALuint bid, ALenum param, const ALfloat* valu
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -388,7 +418,7 @@ AL_API void AL_APIENTRY alBufferi(ALuint bid, ALenum param, ALint value)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -412,7 +442,7 @@ AL_API void AL_APIENTRY alBuffer3i(ALuint bid, ALenum param, ALint value1, ALint
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -436,7 +466,7 @@ AL_API void AL_APIENTRY alBufferiv(ALuint bid, ALenum param, const ALint* values
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -460,7 +490,7 @@ AL_API void AL_APIENTRY alGetBufferf(ALuint bid, ALenum param, ALfloat* value)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -490,7 +520,7 @@ AL_API void AL_APIENTRY alGetBuffer3f(ALuint bid, ALenum param, ALfloat* value1,
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -520,7 +550,7 @@ AL_API void AL_APIENTRY alGetBufferfv(ALuint bid, ALenum param, ALfloat* values)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -550,7 +580,7 @@ AL_API void AL_APIENTRY alGetBufferi(ALuint bid, ALenum param, ALint* value)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -597,7 +627,7 @@ AL_API void AL_APIENTRY alGetBuffer3i(ALuint bid, ALenum param, ALint* value1, A
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	if (ctx == NULL)
 	{
@@ -624,7 +654,7 @@ AL_API void AL_APIENTRY alGetBuffer3i(ALuint bid, ALenum param, ALint* value1, A
 
 AL_API void AL_APIENTRY alGetBufferiv(ALuint bid, ALenum param, ALint* values)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(bid, param)
 
 	switch (param)
 	{
@@ -4,6 +4,7 @@
 #include <ctype.h>
 
 #include "common.h"
+#include "record.h"
 #include "context.h"
 #include "panner.h"
 #include "device.h"
@@ -22,7 +23,15 @@ AL_API void AL_APIENTRY alEnable(ALenum capability)
 		return;
 	}
 
-	AL_SET_ERROR(AL_INVALID_ENUM);
+	switch (capability)
+	{
+	case AL_TRACE_NGS:
+		g_traceEnabled = AL_TRUE;
+		break;
+	default:
+		AL_SET_ERROR(AL_INVALID_ENUM);
+		break;
+	}
 }
 
 AL_API void AL_APIENTRY alDisable(ALenum capability)
@@ -37,7 +46,15 @@ AL_API void AL_APIENTRY alDisable(ALenum capability)
 		return;
 	}
 
-	AL_SET_ERROR(AL_INVALID_ENUM);
+	switch (capability)
+	{
+	case AL_TRACE_NGS:
+		g_traceEnabled = AL_FALSE;
+		break;
+	default:
+		AL_SET_ERROR(AL_INVALID_ENUM);
+		break;
+	}
 }
 
 AL_API ALboolean AL_APIENTRY alIsEnabled(ALenum capability)
@@ -53,11 +70,60 @@ AL_API ALboolean AL_APIENTRY alIsEnabled(ALenum capability)
 		return value;
 	}
 
-	AL_SET_ERROR(AL_INVALID_ENUM);
+	switch (capability)
+	{
+	case AL_TRACE_NGS:
+		value = g_traceEnabled;
+		break;
+	default:
+		AL_SET_ERROR(AL_INVALID_ENUM);
+		break;
+	}
 
 	return value;
 }
 
+AL_API void AL_APIENTRY alTraceDumpNGS(const ALchar *path)
+{
+	AL_TRACE_CALL
+
+	if (path == NULL)
+	{
+		AL_SET_ERROR(AL_INVALID_VALUE);
+		return;
+	}
+
+	if (!_alTraceDump(path))
+	{
+		AL_SET_ERROR(AL_INVALID_OPERATION);
+		return;
+	}
+}
+
+AL_API void AL_APIENTRY alRecordStartNGS(const ALchar *path)
+{
+	AL_TRACE_CALL
+
+	if (path == NULL)
+	{
+		AL_SET_ERROR(AL_INVALID_VALUE);
+		return;
+	}
+
+	if (!_alRecordStart(path))
+	{
+		AL_SET_ERROR(AL_INVALID_OPERATION);
+		return;
+	}
+}
+
+AL_API void AL_APIENTRY alRecordStopNGS(void)
+{
+	AL_TRACE_CALL
+
+	_alRecordStop();
+}
+
 AL_API const ALchar* AL_APIENTRY alGetString(ALenum param)
 {
 	const ALCchar *value = NULL;
@@ -204,11 +270,46 @@ AL_API ALboolean AL_APIENTRY alGetBoolean(ALenum param)
 
 AL_API ALint AL_APIENTRY alGetInteger(ALenum param)
 {
+	int64_t value = 0;
+
 	AL_TRACE_CALL
 
+	// Counters are process wide and lock-free, they do not need a current context
+	if (_alCounterGet(param, &value))
+	{
+		return (value > INT32_MAX) ? INT32_MAX : (ALint)value;
+	}
+
 	return (ALint)alGetFloat(param);
 }
 
+AL_API void AL_APIENTRY alGetInteger64vNGS(ALenum param, ALint64NGS *values)
+{
+	int64_t value = 0;
+
+	AL_TRACE_CALL
+
+	if (values == NULL)
+	{
+		AL_SET_ERROR(AL_INVALID_VALUE);
+		return;
+	}
+
+	if (_alCounterGet(param, &value))
+	{
+		*values = value;
+		return;
+	}
+
+	// Lock statistics fill a calls, wait time, deferred, timeouts, histogram array
+	if (_alLockStatsGet(param, (int64_t *)values) != 0)
+	{
+		return;
+	}
+
+	*values = (ALint64NGS)alGetFloat(param);
+}
+
 AL_API ALfloat AL_APIENTRY alGetFloat(ALenum param)
 {
 	ALfloat value = 0.0f;
@@ -327,6 +428,8 @@ AL_API void AL_APIENTRY alDopplerFactor(ALfloat value)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_DopplerFactor, 0, 0, 1, &value)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -355,6 +458,8 @@ AL_API void AL_APIENTRY alDopplerVelocity(ALfloat value)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_DopplerVelocity, 0, 0, 1, &value)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -377,6 +482,8 @@ AL_API void AL_APIENTRY alSpeedOfSound(ALfloat value)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_SpeedOfSound, 0, 0, 1, &value)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -406,6 +513,8 @@ AL_API void AL_APIENTRY alDistanceModel(ALenum distanceModel)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_DistanceModel, 0, 0, 1, &distanceModel)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -435,6 +544,8 @@ AL_API void AL_APIENTRY alDeferUpdatesSOFT(void)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_DeferUpdates, 0, 0, 0, NULL)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -456,6 +567,8 @@ AL_API void AL_APIENTRY alProcessUpdatesSOFT(void)
 
 	AL_TRACE_CALL
 
+	AL_RECORD_VALUES(RecordOp_ProcessUpdates, 0, 0, 0, NULL)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "common.h"
+#include "record.h"
 #include "context.h"
 
 using namespace al;
@@ -12,7 +13,9 @@ AL_API void AL_APIENTRY alListenerf(ALenum param, ALfloat value)
 	ALint ret = AL_NO_ERROR;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
+
+	AL_RECORD_VALUES(RecordOp_Listenerf, 0, param, 1, &value)
 
 	if (ctx == NULL)
 	{
@@ -44,7 +47,9 @@ AL_API void AL_APIENTRY alListener3f(ALenum param, ALfloat value1, ALfloat value
 	SceFVector4 value;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
+
+	AL_RECORD_VALUES3F(RecordOp_Listener3f, 0, param, value1, value2, value3)
 
 	if (ctx == NULL)
 	{
@@ -60,6 +65,14 @@ AL_API void AL_APIENTRY alListener3f(ALenum param, ALfloat value1, ALfloat value
 		value.z = value3;
 		ctx->beginParamUpdate();
 		ret = ctx->m_panner.setListenerPosition(value);
+		if (ret == AL_NO_ERROR && ctx->m_listenerMotion.m_enabled == AL_TRUE)
+		{
+			ret = ctx->m_listenerMotion.track(value, sceKernelGetProcessTimeWide(), ctx->m_panner.m_speedOfSound * 0.5f, &value);
+			if (ret == AL_NO_ERROR)
+			{
+				ret = ctx->m_panner.setListenerVelocity(value);
+			}
+		}
 		ctx->endParamUpdate();
 		if (ret != AL_NO_ERROR)
 		{
@@ -93,7 +106,7 @@ AL_API void AL_APIENTRY alListenerfv(ALenum param, const ALfloat* values)
 	SceFVector4 value2;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (values == NULL)
 	{
@@ -121,6 +134,8 @@ AL_API void AL_APIENTRY alListenerfv(ALenum param, const ALfloat* values)
 	switch (param)
 	{
 	case AL_ORIENTATION:
+		// Only the orientation reads six values, an unknown param may point at fewer
+		AL_RECORD_VALUES(RecordOp_Listenerfv, 0, param, 6, values)
 		value1.x = values[0];
 		value1.y = values[1];
 		value1.z = values[2];
@@ -144,14 +159,33 @@ AL_API void AL_APIENTRY alListenerfv(ALenum param, const ALfloat* values)
 
 AL_API void AL_APIENTRY alListeneri(ALenum param, ALint value)
 {
-	AL_TRACE_CALL
+	Context *ctx = (Context *)alcGetCurrentContext();
+
+	AL_TRACE_CALL_ARGS(0, param)
 
-	alListenerf(param, (ALfloat)value);
+	switch (param)
+	{
+	case AL_VELOCITY_FROM_POSITION_NGS:
+		AL_RECORD_VALUES(RecordOp_Listeneri, 0, param, 1, &value)
+		if (ctx == NULL)
+		{
+			AL_SET_ERROR(AL_INVALID_OPERATION);
+			return;
+		}
+		ctx->beginParamUpdate();
+		ctx->m_listenerMotion.m_enabled = (value != AL_FALSE);
+		ctx->m_listenerMotion.reset();
+		ctx->endParamUpdate();
+		break;
+	default:
+		alListenerf(param, (ALfloat)value);
+		break;
+	}
 }
 
 AL_API void AL_APIENTRY alListener3i(ALenum param, ALint value1, ALint value2, ALint value3)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	alListener3f(param, (ALfloat)value1, (ALfloat)value2, (ALfloat)value3);
 }
@@ -160,7 +194,7 @@ AL_API void AL_APIENTRY alListeneriv(ALenum param, const ALint* values)
 {
 	ALfloat fvalues[6];
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (values == NULL)
 	{
@@ -196,7 +230,7 @@ AL_API void AL_APIENTRY alGetListenerf(ALenum param, ALfloat* value)
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (ctx == NULL)
 	{
@@ -225,7 +259,7 @@ AL_API void AL_APIENTRY alGetListener3f(ALenum param, ALfloat *value1, ALfloat *
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (ctx == NULL)
 	{
@@ -261,7 +295,7 @@ AL_API void AL_APIENTRY alGetListenerfv(ALenum param, ALfloat* values)
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (values == NULL)
 	{
@@ -305,8 +339,9 @@ AL_API void AL_APIENTRY alGetListenerfv(ALenum param, ALfloat* values)
 AL_API void AL_APIENTRY alGetListeneri(ALenum param, ALint* value)
 {
 	ALfloat ret = 0;
+	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (value == NULL)
 	{
@@ -314,6 +349,17 @@ AL_API void AL_APIENTRY alGetListeneri(ALenum param, ALint* value)
 		return;
 	}
 
+	if (param == AL_VELOCITY_FROM_POSITION_NGS)
+	{
+		if (ctx == NULL)
+		{
+			AL_SET_ERROR(AL_INVALID_OPERATION);
+			return;
+		}
+		*value = (ALint)ctx->m_listenerMotion.m_enabled;
+		return;
+	}
+
 	alGetListenerf(param, &ret);
 
 	*value = (ALint)ret;
@@ -323,7 +369,7 @@ AL_API void AL_APIENTRY alGetListener3i(ALenum param, ALint *value1, ALint *valu
 {
 	ALfloat ret[3];
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (value1 == NULL || value2 == NULL || value3 == NULL)
 	{
@@ -342,7 +388,7 @@ AL_API void AL_APIENTRY alGetListeneriv(ALenum param, ALint* values)
 {
 	ALfloat fret[6];
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(0, param)
 
 	if (values == NULL)
 	{
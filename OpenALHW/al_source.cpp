@@ -5,6 +5,7 @@
 #include <sce_atomic.h>
 
 #include "common.h"
+#include "record.h"
 #include "context.h"
 #include "device.h"
 #include "named_object.h"
@@ -60,42 +61,39 @@ ALboolean Source::validate(Source *src)
 	return AL_TRUE;
 }
 
-ALvoid Source::streamCallback(const SceNgsCallbackInfo *pCallbackInfo)
+ALvoid Source::streamCallback(Voice *pVoice, VoiceEvent event, ALint bufferIdx, ALvoid *pUserData)
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
-	Source *src = (Source *)pCallbackInfo->pUserData;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+	Source *src = (Source *)pUserData;
 	ALint bufferFlag = 0;
 	SceInt32 idx = 0;
 
-	//sceClibPrintf("pb of 0x%08X with type 0x%X reported %d\n", src, src->m_altype, pCallbackInfo->nCallbackData);
+	//sceClibPrintf("pb of 0x%08X with type 0x%X reported %d\n", src, src->m_altype, event);
 
-	if (pCallbackInfo->nCallbackData == SCE_NGS_PLAYER_SWAPPED_BUFFER)
+	if (event == VoiceEvent_SwappedBuffer)
 	{
 		if ((volatile ALboolean)src->m_looping != AL_TRUE)
 		{
-			idx = pCallbackInfo->nCallbackData2;
+			idx = bufferIdx;
 
 			bufferFlag = (1 << idx);
 
-			ret = _alLockNgsResource(pCallbackInfo->hVoiceHandle, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-			if (ret != SCE_NGS_OK)
+			ret = pVoice->lockPlayer(&pPcmParams, LockSite_Callback);
+			if (ret != AL_NO_ERROR)
 			{
 				AL_WARNING("Error has occured in streamCallback: 0x%08X\n", ret);
 				return;
 			}
 
-			pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 			src->m_curIdx = pPcmParams->buffs[idx].nNextBuff;
 
 			pPcmParams->buffs[idx].nNumBytes = 0;
 			pPcmParams->buffs[idx].nLoopCount = 0;
-			pPcmParams->buffs[idx].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+			pPcmParams->buffs[idx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 
-			ret = sceNgsVoiceUnlockParams(pCallbackInfo->hVoiceHandle, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-			if (ret != SCE_NGS_OK)
+			ret = pVoice->unlockPlayer();
+			if (ret != AL_NO_ERROR)
 			{
 				AL_WARNING("Error has occured in streamCallback: 0x%08X\n", ret);
 				return;
@@ -105,24 +103,23 @@ ALvoid Source::streamCallback(const SceNgsCallbackInfo *pCallbackInfo)
 			src->m_processedBuffers |= bufferFlag;
 		}
 	}
-	else if (pCallbackInfo->nCallbackData == SCE_NGS_PLAYER_END_OF_DATA)
+	else if (event == VoiceEvent_EndOfData)
 	{
 		bufferFlag = (1 << src->m_curIdx);
 
-		ret = _alLockNgsResource(pCallbackInfo->hVoiceHandle, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-		if (ret != SCE_NGS_OK)
+		ret = pVoice->lockPlayer(&pPcmParams, LockSite_Callback);
+		if (ret != AL_NO_ERROR)
 		{
 			AL_WARNING("Error has occured in streamCallback: 0x%08X\n", ret);
 			return;
 		}
 
-		pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
 		pPcmParams->buffs[src->m_curIdx].nNumBytes = 0;
 		pPcmParams->buffs[src->m_curIdx].nLoopCount = 0;
-		pPcmParams->buffs[src->m_curIdx].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+		pPcmParams->buffs[src->m_curIdx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 
-		ret = sceNgsVoiceUnlockParams(pCallbackInfo->hVoiceHandle, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-		if (ret != SCE_NGS_OK)
+		ret = pVoice->unlockPlayer();
+		if (ret != AL_NO_ERROR)
 		{
 			AL_WARNING("Error has occured in streamCallback: 0x%08X\n", ret);
 			return;
@@ -134,21 +131,101 @@ ALvoid Source::streamCallback(const SceNgsCallbackInfo *pCallbackInfo)
 	}
 }
 
+ALvoid Source::captureCallback(Voice *pVoice, VoiceEvent event, ALint bufferIdx, ALvoid *pUserData)
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+	Source *src = (Source *)pUserData;
+	SceInt32 idx = 0;
+
+	if (event == VoiceEvent_SwappedBuffer)
+	{
+		idx = bufferIdx;
+	}
+	else if (event == VoiceEvent_EndOfData)
+	{
+		idx = src->m_curIdx;
+	}
+	else
+	{
+		return;
+	}
+
+	ret = pVoice->lockPlayer(&pPcmParams, LockSite_Callback);
+	if (ret != AL_NO_ERROR)
+	{
+		AL_WARNING("Error has occured in captureCallback: 0x%08X\n", ret);
+		return;
+	}
+
+	if (event == VoiceEvent_SwappedBuffer)
+	{
+		src->m_curIdx = pPcmParams->buffs[idx].nNextBuff;
+	}
+
+	pPcmParams->buffs[idx].pBuffer = NULL;
+	pPcmParams->buffs[idx].nNumBytes = 0;
+	pPcmParams->buffs[idx].nLoopCount = 0;
+	pPcmParams->buffs[idx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+
+	ret = pVoice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
+	{
+		AL_WARNING("Error has occured in captureCallback: 0x%08X\n", ret);
+		return;
+	}
+
+	src->m_queueBuffers &= ~(1 << idx);
+
+	// The slice has been played out, the capture thread may reuse it now
+	src->m_capture->releaseSlice();
+
+	if (event == VoiceEvent_EndOfData)
+	{
+		// Capture fell behind the player, the update thread restarts the voice once slices are ready again
+		src->m_captureStalled = AL_TRUE;
+		return;
+	}
+
+	src->pushCaptureSlices();
+}
+
 Source::Source(Context *ctx)
-	: m_voice(AL_INVALID_NGS_HANDLE),
-	m_patch(AL_INVALID_NGS_HANDLE),
-	m_voiceIdx(-1),
+	: m_voice(NULL),
 	m_minGain(0.0f),
 	m_maxGain(1.0f),
 	m_altype(AL_UNDETERMINED),
 	m_looping(AL_FALSE),
 	m_afterSeek(AL_FALSE),
 	m_paramsDirty(AL_FALSE),
+	m_extrapolate(AL_FALSE),
+	m_positionTime(0),
 	m_queueBuffers(0),
 	m_processedBuffers(0),
 	m_lastPushedIdx(3),
-	m_curIdx(0)
+	m_curIdx(0),
+	m_outputChannels(2),
+	m_curPitch(1.0f),
+	m_targetPitch(1.0f),
+	m_rampSteps(0),
+	m_rampSnap(AL_TRUE),
+	m_capture(NULL),
+	m_captureNext(0),
+	m_captureRunning(AL_FALSE),
+	m_captureStalled(AL_FALSE),
+	m_frequency(0),
+	m_channels(1),
+	m_snapshotSeq(0),
+	m_snapshotGeneration(0)
 {
+	m_curVolume[0] = 1.0f;
+	m_curVolume[1] = 1.0f;
+	m_targetVolume[0] = 1.0f;
+	m_targetVolume[1] = 1.0f;
+
+	memset(&m_snapshot, 0, sizeof(SourceSnapshot));
+	m_snapshot.generation = -1;
+
 	m_ctx = ctx;
 	m_type = ObjectType_Source;
 }
@@ -160,163 +237,172 @@ Source::~Source()
 
 ALint Source::init()
 {
-	SceInt32 ret = SCE_NGS_OK;
-	DeviceNGS *ngsDev = (DeviceNGS *)m_ctx->getDevice();
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
-	SceNgsPatchSetupInfo patchInfo;
-	SceNgsPatchRouteInfo patchRouteInfo;
-
-	for (int i = 0; i < ngsDev->getMaxMonoVoiceCount() + ngsDev->getMaxStereoVoiceCount(); i++)
-	{
-		if (m_ctx->m_voiceUsed[i] == false)
-		{
-			m_voiceIdx = i;
-			break;
-		}
-	}
+	ALint ret = AL_NO_ERROR;
 
-	if (m_voiceIdx == -1)
+	m_voice = m_ctx->m_backend->acquireVoice();
+	if (m_voice == NULL)
 	{
+		_alCounterAdd(Counter_VoiceAllocFailures, 1);
 		return AL_OUT_OF_MEMORY;
 	}
 
-	ret = sceNgsRackGetVoiceHandle(m_ctx->m_sourceRack, m_voiceIdx, &m_voice);
-	if (ret != SCE_NGS_OK)
-	{
-		return _alErrorNgs2Al(ret);
-	}
+	_alCounterAdd(Counter_ActiveVoices, 1);
 
-	sceNgsVoiceBypassModule(m_voice, SCE_NGS_SIMPLE_VOICE_EQ, SCE_NGS_MODULE_FLAG_BYPASSED);
+	m_outputChannels = m_voice->getOutputChannels();
 
-	ret = sceNgsVoiceLockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = setPatchVolumes(m_curVolume);
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
-	memset(bufferInfo.data, 0, bufferInfo.size);
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-	pPcmParams->desc.id = SCE_NGS_PLAYER_PARAMS_STRUCT_ID;
-	pPcmParams->desc.size = sizeof(SceNgsPlayerParams);
+	sceKernelCreateLwMutex(&m_lock, "OpenALHW::SrcMtx", 0, 0, NULL);
 
-	pPcmParams->fPlaybackScalar = 1.0f;
-	pPcmParams->nLeadInSamples = 0;
-	pPcmParams->nLimitNumberOfSamplesPlayed = 0;
-	pPcmParams->nChannels = 1;
+	m_initialized = AL_TRUE;
 
-	pPcmParams->nType = SCE_NGS_PLAYER_TYPE_PCM;
-	pPcmParams->nStartBuffer = 0;
-	pPcmParams->nStartByte = 0;
+	return AL_NO_ERROR;
+}
 
-	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+ALint Source::release()
+{
+	if (m_capture != NULL)
 	{
-		return _alErrorNgs2Al(ret);
-	}
+		stopCapture();
 
-	patchInfo.hVoiceSource = m_voice;
-	patchInfo.nSourceOutputIndex = 0;
-	patchInfo.nSourceOutputSubIndex = SCE_NGS_VOICE_PATCH_AUTO_SUBINDEX;
-	patchInfo.hVoiceDestination = m_ctx->m_masterVoice;
-	patchInfo.nTargetInputIndex = 0;
+		m_voice->setCallback(NULL, NULL);
+		m_voice->kill();
 
-	ret = sceNgsPatchCreateRouting(&patchInfo, &m_patch);
-	if (ret != SCE_NGS_OK)
-	{
-		return _alErrorNgs2Al(ret);
+		m_capture->endMonitor();
+		m_capture = NULL;
 	}
 
-	ret = sceNgsPatchGetInfo(m_patch, &patchRouteInfo, NULL);
-	if (ret != SCE_NGS_OK)
+	if (m_voice != NULL)
 	{
-		return _alErrorNgs2Al(ret);
+		m_ctx->m_backend->releaseVoice(m_voice);
+		m_voice = NULL;
+
+		_alCounterAdd(Counter_ActiveVoices, -1);
 	}
 
-	if (patchRouteInfo.nOutputChannels == 1)
+	sceKernelDeleteLwMutex(&m_lock);
+
+	m_initialized = AL_FALSE;
+
+	return AL_NO_ERROR;
+}
+
+ALint Source::rebind(Voice *pVoice)
+{
+	ALint ret = AL_NO_ERROR;
+	ALint state = AL_STOPPED;
+	ALint bufferBytes = 0;
+	ALint frameBytes = 0;
+	PlayerParams *pPcmParams;
+	PlayerParams player;
+	PlayerState playerState;
+
+	state = m_voice->getState();
+
+	memset(&playerState, 0, sizeof(PlayerState));
+	m_voice->getPlayerState(&playerState);
+
+	m_voice->setCallback(NULL, NULL);
+	m_voice->kill();
+
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		patchRouteInfo.vols.m[0][0] = 1.0f; // left to left
-		patchRouteInfo.vols.m[0][1] = 1.0f; // left to right
+		AL_WARNING("Error has occured in rebind: 0x%08X\n", ret);
+		memset(&player, 0, sizeof(PlayerParams));
 	}
 	else
 	{
-		patchRouteInfo.vols.m[0][0] = 1.0f; // left to left
-		patchRouteInfo.vols.m[0][1] = 0.0f; // left to right
-		patchRouteInfo.vols.m[1][0] = 0.0f; // right to left
-		patchRouteInfo.vols.m[1][1] = 1.0f; // right to right
+		player = *pPcmParams;
+		m_voice->unlockPlayer();
 	}
 
-	ret = sceNgsVoicePatchSetVolumesMatrix(m_patch, &patchRouteInfo.vols);
-	if (ret != SCE_NGS_OK)
+	m_ctx->m_backend->releaseVoice(m_voice);
+
+	if (state == AL_PLAYING || state == AL_PAUSED)
 	{
-		return _alErrorNgs2Al(ret);
+		// Voices only report progress since key-on, so the offset is only recoverable while still inside the key-on buffer
+		bufferBytes = player.buffs[m_curIdx].nNumBytes;
+		frameBytes = 2 * player.nChannels;
+
+		player.nStartByte = (m_curIdx == player.nStartBuffer && bufferBytes > 0 && frameBytes > 0) ?
+			((player.nStartByte + playerState.nBytesConsumedSinceKeyOn) % bufferBytes) / frameBytes * frameBytes : 0;
+		player.nStartBuffer = m_curIdx;
 	}
 
-	sceKernelCreateLwMutex(&m_lock, "OpenALHW::SrcMtx", 0, 0, NULL);
+	m_voice = pVoice;
+	m_outputChannels = m_voice->getOutputChannels();
 
-	m_ctx->m_voiceUsed[m_voiceIdx] = true;
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
+	{
+		AL_WARNING("Error has occured in rebind: 0x%08X\n", ret);
+		return AL_STOPPED;
+	}
 
-	m_initialized = AL_TRUE;
+	*pPcmParams = player;
 
-	return AL_NO_ERROR;
-}
+	m_voice->unlockPlayer();
 
-ALint Source::release()
-{
-	sceNgsSystemLock(m_ctx->m_system);
-	sceNgsVoiceKill(m_voice);
-	sceNgsVoiceSetModuleCallback(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL);
-	sceNgsPatchRemoveRouting(m_patch);
-	sceNgsSystemUnlock(m_ctx->m_system);
+	setPatchVolumes(m_curVolume);
 
-	if (m_voiceIdx != -1)
-		m_ctx->m_voiceUsed[m_voiceIdx] = false;
+	beginParamUpdate();
+	m_rampSnap = AL_TRUE;
+	endParamUpdate();
+	update();
 
-	sceKernelDeleteLwMutex(&m_lock);
+	if (state == AL_PLAYING || state == AL_PAUSED)
+	{
+		m_voice->setCallback((m_capture != NULL) ? Source::captureCallback : Source::streamCallback, this);
+		m_voice->play();
 
-	m_initialized = AL_FALSE;
+		if (state == AL_PAUSED)
+		{
+			m_voice->pause();
+		}
+	}
 
-	return AL_NO_ERROR;
+	invalidateSnapshot();
+
+	return state;
 }
 
 ALint Source::dropAllBuffers()
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
 
-	sceNgsVoiceSetModuleCallback(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL);
+	m_voice->setCallback(NULL, NULL);
 
-	sceNgsVoiceKill(m_voice);
+	m_voice->kill();
 
-	ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 	pPcmParams->fPlaybackFrequency = 0;
 	pPcmParams->nChannels = 1;
 
 	pPcmParams->nStartBuffer = 0;
 	pPcmParams->nStartByte = 0;
 
-	for (int i = 0; i < SCE_NGS_PLAYER_MAX_BUFFERS; i++)
+	for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
 	{
 		if (pPcmParams->buffs[i].pBuffer != NULL)
 		{
-			for (Buffer *buf : m_ctx->m_bufferStack)
+			Buffer *buf = ((DeviceNGS *)m_ctx->getDevice())->findBuffer(pPcmParams->buffs[i].pBuffer);
+			if (buf != NULL)
 			{
-				if (pPcmParams->buffs[i].pBuffer == buf->m_storage)
+				buf->deref();
+				if (buf->m_refCounter == 0)
 				{
-					buf->deref();
-					if (buf->m_refCounter == 0)
-					{
-						buf->m_state = AL_UNUSED;
-					}
-					break;
+					buf->m_state = AL_UNUSED;
 				}
 			}
 		}
@@ -324,13 +410,13 @@ ALint Source::dropAllBuffers()
 		pPcmParams->buffs[i].pBuffer = NULL;
 		pPcmParams->buffs[i].nNumBytes = 0;
 		pPcmParams->buffs[i].nLoopCount = 0;
-		pPcmParams->buffs[i].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+		pPcmParams->buffs[i].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 	}
 
-	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
 	beginParamUpdate();
@@ -338,19 +424,22 @@ ALint Source::dropAllBuffers()
 	m_altype = AL_UNDETERMINED;
 	m_lastPushedIdx = 3;
 	m_curIdx = 0;
+	m_frequency = 0;
+	m_channels = 1;
 	sceAtomicStore32AcqRel(&m_processedBuffers, 0);
 	sceAtomicStore32AcqRel(&m_queueBuffers, 0);
 
 	endParamUpdate();
 
+	invalidateSnapshot();
+
 	return AL_NO_ERROR;
 }
 
 ALint Source::switchToStaticBuffer(ALint frequency, ALint channels, Buffer *buf)
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
 
 	ret = dropAllBuffers();
 	if (ret != AL_NO_ERROR)
@@ -358,50 +447,42 @@ ALint Source::switchToStaticBuffer(ALint frequency, ALint channels, Buffer *buf)
 		return ret;
 	}
 
-	ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 	pPcmParams->fPlaybackFrequency = frequency;
 	pPcmParams->nChannels = channels;
-	if (channels == 1)
-	{
-		pPcmParams->nChannelMap[0] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-		pPcmParams->nChannelMap[1] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-	}
-	else
-	{
-		pPcmParams->nChannelMap[0] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-		pPcmParams->nChannelMap[1] = SCE_NGS_PLAYER_RIGHT_CHANNEL;
-	}
 
 	pPcmParams->buffs[0].pBuffer = buf->m_storage;
 	pPcmParams->buffs[0].nNumBytes = buf->m_size;
 	if (m_looping == AL_TRUE)
 	{
-		pPcmParams->buffs[0].nLoopCount = SCE_NGS_PLAYER_LOOP_CONTINUOUS;
+		pPcmParams->buffs[0].nLoopCount = AL_PLAYER_LOOP_CONTINUOUS;
 	}
 	else
 	{
 		pPcmParams->buffs[0].nLoopCount = 0;
 	}
-	pPcmParams->buffs[0].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+	pPcmParams->buffs[0].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 
-	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
 	m_altype = AL_STATIC;
 	m_curIdx = 0;
+	m_frequency = frequency;
+	m_channels = channels;
 	buf->ref();
 	sceAtomicStore32AcqRel(&m_queueBuffers, NGS_BUFFER_IDX_0);
 
+	invalidateSnapshot();
+
 	return AL_NO_ERROR;
 }
 
@@ -416,42 +497,83 @@ ALvoid Source::endParamUpdate()
 	sceKernelUnlockLwMutex(&m_lock, 1);
 }
 
+ALint Source::setPatchVolumes(const float32_t *volumeMatrix)
+{
+	float32_t vols[2][2];
+
+	memset(vols, 0, sizeof(vols));
+
+	if (m_outputChannels == 1)
+	{
+		vols[0][0] = volumeMatrix[0]; // left to left
+		vols[0][1] = volumeMatrix[1]; // left to right
+	}
+	else
+	{
+		vols[0][0] = volumeMatrix[0]; // left to left
+		vols[1][1] = volumeMatrix[1]; // right to right
+	}
+
+	return m_voice->setPatchVolumes(vols);
+}
+
 ALvoid Source::update()
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
-	SceNgsFilterParams *pFilterParams;
-	SceNgsPatchRouteInfo patchRouteInfo;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+	SourceParams params;
 	float32_t volumeMatrix[2];
 	float32_t lowpassCutoff = 1.0f;
 	float32_t dopplerShift = 1.0f;
+	float32_t elapsed = 0.0f;
+	ALboolean extrapolating = AL_FALSE;
 
 	sceKernelLockLwMutex(&m_lock, 1, NULL);
 
-	if (m_paramsDirty == AL_TRUE) {
+	if (m_extrapolate == AL_TRUE)
+	{
+		extrapolating = (m_params.vVelocity.x != 0.0f || m_params.vVelocity.y != 0.0f || m_params.vVelocity.z != 0.0f);
+	}
+
+	if (m_paramsDirty == AL_TRUE || extrapolating == AL_TRUE) {
+
+		params = m_params;
+
+		if (extrapolating == AL_TRUE)
+		{
+			elapsed = (float32_t)std::min(sceKernelGetProcessTimeWide() - m_positionTime, (SceUInt64)NGS_MAX_EXTRAPOLATION_US) / 1000000.0f;
+
+			params.vPosition.x += params.vVelocity.x * elapsed;
+			params.vPosition.y += params.vVelocity.y * elapsed;
+			params.vPosition.z += params.vVelocity.z * elapsed;
+		}
 
-		m_ctx->m_panner.calculate(&m_params, 2, volumeMatrix, &dopplerShift, &lowpassCutoff);
+		m_ctx->m_panner.calculate(&params, 2, volumeMatrix, &dopplerShift, &lowpassCutoff);
 
-		volumeMatrix[0] *= m_params.fGainMul;
-		volumeMatrix[1] *= m_params.fGainMul;
+		m_targetVolume[0] = volumeMatrix[0] * m_params.fGainMul;
+		m_targetVolume[1] = volumeMatrix[1] * m_params.fGainMul;
+		m_targetPitch = dopplerShift * m_params.fPitchMul;
 
-		ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-		if (ret != SCE_NGS_OK)
+		// Busy params are left dirty and written on the next tick instead of sleeping on the update thread
+		ret = m_voice->tryLockPlayer(&pPcmParams, LockSite_Update);
+		if (ret != AL_NO_ERROR)
 		{
-			goto updateFilter;
+			goto deferred;
 		}
 
-		pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-		pPcmParams->fPlaybackScalar = dopplerShift * m_params.fPitchMul;
+		// Otherwise the output thread ramps the scalar towards the new target
+		if (m_rampSnap == AL_TRUE)
+		{
+			pPcmParams->fPlaybackScalar = m_targetPitch;
+		}
 
 		if (m_looping == AL_TRUE)
 		{
 			if (m_altype == AL_STATIC)
 			{
-				pPcmParams->buffs[0].nLoopCount = SCE_NGS_PLAYER_LOOP_CONTINUOUS;
+				pPcmParams->buffs[0].nLoopCount = AL_PLAYER_LOOP_CONTINUOUS;
 			}
-			else if (m_altype == AL_STREAMING)
+			else if (m_altype == AL_STREAMING && m_capture == NULL)
 			{
 				ALint flags = sceAtomicLoad32AcqRel(&m_queueBuffers);
 				ALint searchIdx = m_lastPushedIdx - 1;
@@ -489,61 +611,91 @@ ALvoid Source::update()
 			{
 				pPcmParams->buffs[0].nLoopCount = 0;
 			}
-			else if (m_altype == AL_STREAMING)
+			else if (m_altype == AL_STREAMING && m_capture == NULL)
 			{
-				pPcmParams->buffs[m_lastPushedIdx].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+				pPcmParams->buffs[m_lastPushedIdx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 			}
 		}
 
-		sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
+		m_voice->unlockPlayer();
 
-	updateFilter:
-
-		ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER, SCE_NGS_FILTER_PARAMS_STRUCT_ID, &bufferInfo);
-		if (ret != SCE_NGS_OK)
+		ret = m_voice->setFilter(20.0f + ((22000.0f - 20.0f) * lowpassCutoff));
+		if (ret != AL_NO_ERROR)
 		{
-			goto updatePatch;
+			goto deferred;
 		}
 
-		pFilterParams = (SceNgsFilterParams *)bufferInfo.data;
-
-		for (uint32_t chan = 0; chan < bufferInfo.size / sizeof(SceNgsFilterParams); chan++)
+		if (m_rampSnap == AL_TRUE)
 		{
-			pFilterParams->eFilterMode = SCE_NGS_FILTER_LOWPASS_ONEPOLE;
-			pFilterParams->fResonance = 1.0f;
-			pFilterParams->fFrequency = 20.0f + ((22000.0f - 20.0f) * lowpassCutoff);
+			m_curVolume[0] = m_targetVolume[0];
+			m_curVolume[1] = m_targetVolume[1];
+			m_curPitch = m_targetPitch;
+			m_rampSteps = 0;
+			m_rampSnap = AL_FALSE;
 
-			pFilterParams++;
+			setPatchVolumes(m_curVolume);
+		}
+		else
+		{
+			m_rampSteps = m_ctx->m_rampGranules;
 		}
 
-		sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER);
+		m_paramsDirty = AL_FALSE;
+	}
 
-	updatePatch:
+deferred:
 
-		ret = sceNgsPatchGetInfo(m_patch, &patchRouteInfo, NULL);
-		if (ret != SCE_NGS_OK)
-		{
-			goto updateEnd;
-		}
+	if (m_captureRunning == AL_TRUE && m_captureStalled == AL_TRUE)
+	{
+		restartCapture();
+	}
 
-		if (patchRouteInfo.nOutputChannels == 1)
-		{
-			patchRouteInfo.vols.m[0][0] = volumeMatrix[0]; // left to left
-			patchRouteInfo.vols.m[0][1] = volumeMatrix[1]; // left to right
-		}
-		else
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Source::applyRamp()
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+	float32_t pitch = 1.0f;
+
+	if (m_rampSteps <= 0)
+	{
+		return;
+	}
+
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		return;
+	}
+
+	if (m_rampSteps > 0)
+	{
+		pitch = m_curPitch + (m_targetPitch - m_curPitch) / m_rampSteps;
+
+		if (pitch != m_curPitch)
 		{
-			patchRouteInfo.vols.m[0][0] = volumeMatrix[0]; // left to left
-			patchRouteInfo.vols.m[0][1] = 0.0f; // nothing
-			patchRouteInfo.vols.m[1][0] = 0.0f; // nothing
-			patchRouteInfo.vols.m[1][1] = volumeMatrix[1]; // right to right
+			// Retry on the next granule rather than waiting for the API thread to release the params
+			ret = m_voice->tryLockPlayer(&pPcmParams, LockSite_Ramp);
+			if (ret != AL_NO_ERROR)
+			{
+				sceKernelUnlockLwMutex(&m_lock, 1);
+				return;
+			}
+
+			pPcmParams->fPlaybackScalar = pitch;
+
+			m_voice->unlockPlayer();
+
+			m_curPitch = pitch;
 		}
 
-		sceNgsVoicePatchSetVolumesMatrix(m_patch, &patchRouteInfo.vols);
+		m_curVolume[0] += (m_targetVolume[0] - m_curVolume[0]) / m_rampSteps;
+		m_curVolume[1] += (m_targetVolume[1] - m_curVolume[1]) / m_rampSteps;
 
-	updateEnd:
+		setPatchVolumes(m_curVolume);
 
-		m_paramsDirty = AL_FALSE;
+		m_rampSteps--;
 	}
 
 	sceKernelUnlockLwMutex(&m_lock, 1);
@@ -607,10 +759,9 @@ ALint Source::queuedBufferCount()
 
 ALint Source::bqPush(ALint frequency, ALint channels, Buffer *buf)
 {
-	SceInt32 ret = SCE_NGS_OK;
+	ALint ret = AL_NO_ERROR;
 	SceInt32 nextPushIdx = 0;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	PlayerParams *pPcmParams;
 
 	nextPushIdx = m_lastPushedIdx + 1;
 	if (nextPushIdx == 4)
@@ -618,22 +769,20 @@ ALint Source::bqPush(ALint frequency, ALint channels, Buffer *buf)
 		nextPushIdx = 0;
 	}
 
-	ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 	if (pPcmParams->fPlaybackFrequency != 0)
 	{
 		if (pPcmParams->fPlaybackFrequency != (SceFloat32)frequency || pPcmParams->nChannels != (SceInt8)channels)
 		{
-			ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-			if (ret != SCE_NGS_OK)
+			ret = m_voice->unlockPlayer();
+			if (ret != AL_NO_ERROR)
 			{
-				return _alErrorNgs2Al(ret);
+				return ret;
 			}
 
 			return AL_INVALID_VALUE;
@@ -642,16 +791,10 @@ ALint Source::bqPush(ALint frequency, ALint channels, Buffer *buf)
 	else {
 		pPcmParams->fPlaybackFrequency = (SceFloat32)frequency;
 		pPcmParams->nChannels = (SceInt8)channels;
-		if (channels == 1)
-		{
-			pPcmParams->nChannelMap[0] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-			pPcmParams->nChannelMap[1] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-		}
-		else
-		{
-			pPcmParams->nChannelMap[0] = SCE_NGS_PLAYER_LEFT_CHANNEL;
-			pPcmParams->nChannelMap[1] = SCE_NGS_PLAYER_RIGHT_CHANNEL;
-		}
+
+		m_frequency = frequency;
+		m_channels = channels;
+		invalidateSnapshot();
 	}
 
 	pPcmParams->buffs[m_lastPushedIdx].nNextBuff = nextPushIdx;
@@ -659,15 +802,15 @@ ALint Source::bqPush(ALint frequency, ALint channels, Buffer *buf)
 	pPcmParams->buffs[nextPushIdx].pBuffer = buf->m_storage;
 	pPcmParams->buffs[nextPushIdx].nNumBytes = buf->m_size;
 	pPcmParams->buffs[nextPushIdx].nLoopCount = 0;
-	pPcmParams->buffs[nextPushIdx].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+	pPcmParams->buffs[nextPushIdx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 
 	m_queueBuffers |= (1 << nextPushIdx);
 	m_lastPushedIdx = nextPushIdx;
 
-	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
 	return AL_NO_ERROR;
@@ -675,22 +818,19 @@ ALint Source::bqPush(ALint frequency, ALint channels, Buffer *buf)
 
 ALint Source::seek(ALfloat value, ALint type)
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
 
 	ALint seekBytes = 0;
 	ALint bufIdx = m_curIdx;
 	ALint flags = sceAtomicLoad32AcqRel(&m_queueBuffers);
 
-	ret = _alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		return _alErrorNgs2Al(ret);
+		return ret;
 	}
 
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 	switch (type)
 	{
 	case AL_BYTE_OFFSET:
@@ -704,33 +844,333 @@ ALint Source::seek(ALfloat value, ALint type)
 		break;
 	}
 
-	do
+	do
+	{
+		if (pPcmParams->buffs[bufIdx].nNumBytes < seekBytes)
+		{
+			seekBytes -= pPcmParams->buffs[bufIdx].nNumBytes;
+			bufIdx++;
+			if (bufIdx > 3)
+			{
+				bufIdx = 0;
+			}
+		}
+		else
+		{
+			break;
+		}
+	} while ((flags & (1 << bufIdx)) && (bufIdx != m_curIdx));
+
+	pPcmParams->nStartBuffer = bufIdx;
+	pPcmParams->nStartByte = seekBytes;
+
+	ret = m_voice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
+	{
+		return ret;
+	}
+
+	invalidateSnapshot();
+
+	return AL_NO_ERROR;
+}
+
+ALint Source::pushCaptureSlices()
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+	const ALvoid *slice = NULL;
+	SceInt32 nextPushIdx = 0;
+	ALint sliceFrames = m_capture->getSliceFrames();
+
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
+	{
+		return queuedBufferCount();
+	}
+
+	while (true)
+	{
+		nextPushIdx = m_lastPushedIdx + 1;
+		if (nextPushIdx == 4)
+		{
+			nextPushIdx = 0;
+		}
+
+		if (m_queueBuffers & (1 << nextPushIdx))
+		{
+			break;
+		}
+
+		slice = m_capture->peekSlice(m_captureNext);
+		if (slice == NULL)
+		{
+			break;
+		}
+
+		// Slots point straight into the capture ring, nothing is copied
+		if (m_queueBuffers == 0)
+		{
+			m_curIdx = nextPushIdx;
+		}
+		else
+		{
+			pPcmParams->buffs[m_lastPushedIdx].nNextBuff = nextPushIdx;
+		}
+
+		pPcmParams->buffs[nextPushIdx].pBuffer = slice;
+		pPcmParams->buffs[nextPushIdx].nNumBytes = sliceFrames * 2 * pPcmParams->nChannels;
+		pPcmParams->buffs[nextPushIdx].nLoopCount = 0;
+		pPcmParams->buffs[nextPushIdx].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+
+		m_lastPushedIdx = nextPushIdx;
+		m_queueBuffers |= (1 << nextPushIdx);
+		m_captureNext += sliceFrames;
+	}
+
+	m_voice->unlockPlayer();
+
+	return queuedBufferCount();
+}
+
+ALvoid Source::restartCapture()
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+
+	// Wait for a little lead so the player does not run dry again straight away
+	if (pushCaptureSlices() < NGS_CAPTURE_PREBUFFER_SLICES)
+	{
+		return;
+	}
+
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
+	{
+		return;
+	}
+
+	pPcmParams->nStartBuffer = m_curIdx;
+	pPcmParams->nStartByte = 0;
+
+	m_voice->unlockPlayer();
+
+	m_captureStalled = AL_FALSE;
+
+	m_voice->setCallback(Source::captureCallback, this);
+	m_voice->play();
+
+	invalidateSnapshot();
+}
+
+ALint Source::bindCapture(DeviceAudioIn *dev)
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+
+	if (m_capture != NULL)
+	{
+		stopCapture();
+	}
+
+	ret = dropAllBuffers();
+	if (ret != AL_NO_ERROR)
+	{
+		return ret;
+	}
+
+	if (m_capture != NULL)
+	{
+		m_capture->endMonitor();
+
+		beginParamUpdate();
+		m_capture = NULL;
+		endParamUpdate();
+	}
+
+	if (dev == NULL)
+	{
+		return AL_NO_ERROR;
+	}
+
+	if (dev->beginMonitor() != ALC_TRUE)
+	{
+		return AL_INVALID_OPERATION;
+	}
+
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
+	{
+		dev->endMonitor();
+		return ret;
+	}
+
+	pPcmParams->fPlaybackFrequency = (SceFloat32)dev->getFrequency();
+	pPcmParams->nChannels = (SceInt8)dev->getChannels();
+
+	m_voice->unlockPlayer();
+
+	beginParamUpdate();
+	m_capture = dev;
+	m_altype = AL_STREAMING;
+	m_frequency = dev->getFrequency();
+	m_channels = dev->getChannels();
+	endParamUpdate();
+
+	invalidateSnapshot();
+
+	return AL_NO_ERROR;
+}
+
+ALint Source::startCapture()
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
+
+	m_voice->setCallback(NULL, NULL);
+	m_voice->kill();
+
+	ret = m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
+	{
+		return ret;
+	}
+
+	for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
+	{
+		pPcmParams->buffs[i].pBuffer = NULL;
+		pPcmParams->buffs[i].nNumBytes = 0;
+		pPcmParams->buffs[i].nLoopCount = 0;
+		pPcmParams->buffs[i].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+	}
+
+	m_voice->unlockPlayer();
+
+	// Whatever was captured while stopped is stale, playback starts from the newest slice
+	beginParamUpdate();
+	m_lastPushedIdx = 3;
+	m_curIdx = 0;
+	sceAtomicStore32AcqRel(&m_queueBuffers, 0);
+	m_captureNext = m_capture->syncMonitor();
+	m_captureRunning = AL_TRUE;
+	m_captureStalled = AL_TRUE;
+	m_rampSnap = AL_TRUE;
+	endParamUpdate();
+
+	update();
+
+	invalidateSnapshot();
+
+	return AL_NO_ERROR;
+}
+
+ALvoid Source::stopCapture()
+{
+	// Keeps the update thread from restarting the voice underneath the caller
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+	m_captureRunning = AL_FALSE;
+	m_captureStalled = AL_FALSE;
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALint Source::querySnapshot(SourceSnapshot *pSnap)
+{
+	ALint ret = AL_NO_ERROR;
+	PlayerState playerState;
+
+	// Taken first, a change made while the voice is being queried leaves the result stale rather than mixed
+	pSnap->generation = sceAtomicLoad32AcqRel(&m_snapshotGeneration);
+
+	ret = m_voice->getPlayerState(&playerState);
+	if (ret != AL_NO_ERROR)
+	{
+		return ret;
+	}
+
+	pSnap->state = m_voice->getState();
+	pSnap->samplesGenerated = playerState.nSamplesGeneratedSinceKeyOn;
+	pSnap->bytesConsumed = playerState.nBytesConsumedSinceKeyOn;
+	pSnap->curIdx = m_curIdx;
+	pSnap->frequency = m_frequency;
+	pSnap->channels = m_channels;
+
+	return AL_NO_ERROR;
+}
+
+ALvoid Source::publishSnapshot()
+{
+	SourceSnapshot snap;
+
+	// A stopped or paused voice only moves on an API call, and those retire the snapshot themselves
+	if (m_snapshot.generation == sceAtomicLoad32AcqRel(&m_snapshotGeneration) &&
+		(m_snapshot.state == AL_STOPPED || m_snapshot.state == AL_PAUSED || m_snapshot.state == AL_INITIAL))
+	{
+		return;
+	}
+
+	if (querySnapshot(&snap) != AL_NO_ERROR)
+	{
+		return;
+	}
+
+	sceAtomicIncrement32AcqRel(&m_snapshotSeq);
+	m_snapshot = snap;
+	sceAtomicIncrement32AcqRel(&m_snapshotSeq);
+}
+
+ALint Source::readSnapshot(SourceSnapshot *pSnap)
+{
+	int32_t seq = 0;
+
+	for (ALint i = 0; i < NGS_SNAPSHOT_READ_RETRIES; i++)
 	{
-		if (pPcmParams->buffs[bufIdx].nNumBytes < seekBytes)
+		seq = sceAtomicLoad32AcqRel(&m_snapshotSeq);
+		if (seq & 1)
 		{
-			seekBytes -= pPcmParams->buffs[bufIdx].nNumBytes;
-			bufIdx++;
-			if (bufIdx > 3)
-			{
-				bufIdx = 0;
-			}
+			continue;
 		}
-		else
+
+		*pSnap = m_snapshot;
+
+		// Compare and swap with itself as a fenced reload, the copy is whole only if no write began in between
+		if (sceAtomicCompareAndSwap32AcqRel(&m_snapshotSeq, seq, seq) != seq)
 		{
-			break;
+			continue;
 		}
-	} while ((flags & (1 << bufIdx)) && (bufIdx != m_curIdx));
 
-	pPcmParams->nStartBuffer = bufIdx;
-	pPcmParams->nStartByte = seekBytes;
+		if (pSnap->generation == sceAtomicLoad32AcqRel(&m_snapshotGeneration))
+		{
+			return AL_NO_ERROR;
+		}
+
+		break;
+	}
+
+	// Nothing rendered since the last change or the writer kept getting in the way, ask the voice directly
+	return querySnapshot(pSnap);
+}
+
+ALvoid Source::invalidateSnapshot()
+{
+	sceAtomicIncrement32AcqRel(&m_snapshotGeneration);
+}
+
+ALint Source::getPlaybackState()
+{
+	SourceSnapshot snap;
 
-	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+	// A monitoring source waiting for capture to catch up is still playing as far as the app is concerned
+	if (m_captureStalled == AL_TRUE)
 	{
-		return _alErrorNgs2Al(ret);
+		return AL_PLAYING;
 	}
 
-	return AL_NO_ERROR;
+	if (readSnapshot(&snap) != AL_NO_ERROR)
+	{
+		return m_voice->getState();
+	}
+
+	return snap.state;
 }
 
 AL_API void AL_APIENTRY alGenSources(ALsizei n, ALuint* sources)
@@ -764,10 +1204,14 @@ AL_API void AL_APIENTRY alGenSources(ALsizei n, ALuint* sources)
 			return;
 		}
 
+		sceKernelLockLwMutex(&ctx->m_lock, 1, NULL);
 		ctx->m_sourceStack.push_back(pSrc);
+		sceKernelUnlockLwMutex(&ctx->m_lock, 1);
 
-		sources[i] = _alNamedObjectAdd((ALint)pSrc);
+		sources[i] = _alNamedObjectAdd((intptr_t)pSrc);
 	}
+
+	AL_RECORD_OBJECTS(RecordOp_GenSources, 0, n, sources)
 }
 
 AL_API void AL_APIENTRY alDeleteSources(ALsizei n, const ALuint* sources)
@@ -775,9 +1219,12 @@ AL_API void AL_APIENTRY alDeleteSources(ALsizei n, const ALuint* sources)
 	Source *pSrc = NULL;
 	ALint ret = AL_NO_ERROR;
 	Context *ctx = (Context *)alcGetCurrentContext();
+	Context *owner = NULL;
 
 	AL_TRACE_CALL
 
+	AL_RECORD_OBJECTS(RecordOp_DeleteSources, 0, n, sources)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -800,18 +1247,24 @@ AL_API void AL_APIENTRY alDeleteSources(ALsizei n, const ALuint* sources)
 			return;
 		}
 
+		// The source may belong to another context on the device, its own list is the one the threads walk
+		owner = pSrc->getContext();
+
+		// The render and update threads walk the list under the context lock, once off it the source is ours alone
+		sceKernelLockLwMutex(&owner->m_lock, 1, NULL);
+		owner->m_sourceStack.erase(std::remove(owner->m_sourceStack.begin(), owner->m_sourceStack.end(), pSrc), owner->m_sourceStack.end());
+		sceKernelUnlockLwMutex(&owner->m_lock, 1);
+
+		_alNamedObjectRemove(sources[i]);
+
 		ret = pSrc->release();
+		delete pSrc;
+
 		if (ret != AL_NO_ERROR)
 		{
 			AL_SET_ERROR(ret);
 			return;
 		}
-
-		_alNamedObjectRemove(sources[i]);
-
-		ctx->m_sourceStack.erase(std::remove(ctx->m_sourceStack.begin(), ctx->m_sourceStack.end(), pSrc), ctx->m_sourceStack.end());
-
-		delete pSrc;
 	}
 }
 
@@ -819,7 +1272,7 @@ AL_API ALboolean AL_APIENTRY alIsSource(ALuint sid)
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, 0)
 
 	if (ctx == NULL)
 	{
@@ -841,7 +1294,9 @@ AL_API void AL_APIENTRY alSourcef(ALuint sid, ALenum param, ALfloat value)
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
+
+	AL_RECORD_VALUES(RecordOp_Sourcef, sid, param, 1, &value)
 
 	if (ctx == NULL)
 	{
@@ -983,7 +1438,9 @@ AL_API void AL_APIENTRY alSource3f(ALuint sid, ALenum param, ALfloat value1, ALf
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
+
+	AL_RECORD_VALUES3F(RecordOp_Source3f, sid, param, value1, value2, value3)
 
 	if (ctx == NULL)
 	{
@@ -1009,6 +1466,11 @@ AL_API void AL_APIENTRY alSource3f(ALuint sid, ALenum param, ALfloat value1, ALf
 	{
 	case AL_POSITION:
 		src->m_params.vPosition = value;
+		src->m_positionTime = sceKernelGetProcessTimeWide();
+		if (src->m_motion.m_enabled == AL_TRUE)
+		{
+			src->m_motion.track(value, src->m_positionTime, ctx->m_panner.m_speedOfSound * 0.5f, &src->m_params.vVelocity);
+		}
 		break;
 	case AL_VELOCITY:
 		src->m_params.vVelocity = value;
@@ -1026,7 +1488,7 @@ AL_API void AL_APIENTRY alSource3f(ALuint sid, ALenum param, ALfloat value1, ALf
 
 AL_API void AL_APIENTRY alSourcefv(ALuint sid, ALenum param, const ALfloat* values)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (values == NULL)
 	{
@@ -1069,7 +1531,7 @@ AL_API void AL_APIENTRY alSourcei(ALuint sid, ALenum param, ALint value)
 	Buffer *buf = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	switch (param)
 	{
@@ -1087,6 +1549,8 @@ AL_API void AL_APIENTRY alSourcei(ALuint sid, ALenum param, ALint value)
 		break;
 	}
 
+	AL_RECORD_VALUES(RecordOp_Sourcei, sid, param, 1, &value)
+
 	if (ctx == NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
@@ -1113,7 +1577,24 @@ AL_API void AL_APIENTRY alSourcei(ALuint sid, ALenum param, ALint value)
 		src->m_looping = value;
 		src->endParamUpdate();
 		break;
+	case AL_POSITION_EXTRAPOLATION_NGS:
+		src->beginParamUpdate();
+		src->m_extrapolate = (value != AL_FALSE);
+		src->m_positionTime = sceKernelGetProcessTimeWide();
+		src->endParamUpdate();
+		break;
+	case AL_VELOCITY_FROM_POSITION_NGS:
+		src->beginParamUpdate();
+		src->m_motion.m_enabled = (value != AL_FALSE);
+		src->m_motion.reset();
+		src->endParamUpdate();
+		break;
 	case AL_BUFFER:
+		if (src->m_capture != NULL)
+		{
+			AL_SET_ERROR(AL_INVALID_OPERATION);
+			return;
+		}
 		src->beginParamUpdate();
 		if (value == 0)
 		{
@@ -1151,7 +1632,7 @@ AL_API void AL_APIENTRY alSourcei(ALuint sid, ALenum param, ALint value)
 
 AL_API void AL_APIENTRY alSource3i(ALuint sid, ALenum param, ALint value1, ALint value2, ALint value3)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	switch (param)
 	{
@@ -1166,7 +1647,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint sid, ALenum param, ALint value1, ALint
 
 AL_API void AL_APIENTRY alSourceiv(ALuint sid, ALenum param, const ALint* values)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (values == NULL)
 	{
@@ -1183,6 +1664,8 @@ AL_API void AL_APIENTRY alSourceiv(ALuint sid, ALenum param, const ALint* values
 	case AL_CONE_OUTER_ANGLE:
 	case AL_SOURCE_RELATIVE:
 	case AL_LOOPING:
+	case AL_POSITION_EXTRAPOLATION_NGS:
+	case AL_VELOCITY_FROM_POSITION_NGS:
 	case AL_BUFFER:
 	case AL_SEC_OFFSET:
 	case AL_SAMPLE_OFFSET:
@@ -1203,11 +1686,9 @@ AL_API void AL_APIENTRY alGetSourcef(ALuint sid, ALenum param, ALfloat* value)
 	ALint ret = AL_NO_ERROR;
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
-	SceNgsPlayerStates state;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	SourceSnapshot snap;
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (ctx == NULL)
 	{
@@ -1262,60 +1743,38 @@ AL_API void AL_APIENTRY alGetSourcef(ALuint sid, ALenum param, ALfloat* value)
 		*value = src->m_params.fOutsideAngle;
 		break;
 	case AL_SEC_OFFSET:
-
-		ALint freq = 0;
-		ALint ch = 0;
-
-		ret = _alLockNgsResource(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-		if (ret != SCE_NGS_OK)
-		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
-			return;
-		}
-
-		pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-		freq = (ALint)pPcmParams->fPlaybackFrequency;
-		ch = pPcmParams->nChannels;
-
-		ret = sceNgsVoiceUnlockParams(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-		if (ret != SCE_NGS_OK)
+		ret = src->readSnapshot(&snap);
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
 
-		if (freq == 0)
+		if (snap.frequency == 0)
 		{
 			AL_SET_ERROR(AL_INVALID_OPERATION);
 			return;
 		}
 
-		ret = sceNgsVoiceGetStateData(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, &state, sizeof(SceNgsPlayerStates));
-		if (ret != SCE_NGS_OK)
-		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
-			return;
-		}
-
-		*value = state.nBytesConsumedSinceKeyOn / 2 * ch * freq;
+		*value = (ALfloat)snap.bytesConsumed / (2 * snap.channels * snap.frequency);
 		break;
 	case AL_SAMPLE_OFFSET:
-		ret = sceNgsVoiceGetStateData(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, &state, sizeof(SceNgsPlayerStates));
-		if (ret != SCE_NGS_OK)
+		ret = src->readSnapshot(&snap);
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
-		*value = state.nSamplesGeneratedSinceKeyOn;
+		*value = snap.samplesGenerated;
 		break;
 	case AL_BYTE_OFFSET:
-		ret = sceNgsVoiceGetStateData(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, &state, sizeof(SceNgsPlayerStates));
-		if (ret != SCE_NGS_OK)
+		ret = src->readSnapshot(&snap);
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
-		*value = state.nBytesConsumedSinceKeyOn;
+		*value = snap.bytesConsumed;
 		break;
 	default:
 		AL_SET_ERROR(AL_INVALID_ENUM);
@@ -1328,7 +1787,7 @@ AL_API void AL_APIENTRY alGetSource3f(ALuint sid, ALenum param, ALfloat* value1,
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (ctx == NULL)
 	{
@@ -1375,7 +1834,7 @@ AL_API void AL_APIENTRY alGetSource3f(ALuint sid, ALenum param, ALfloat* value1,
 
 AL_API void AL_APIENTRY alGetSourcefv(ALuint sid, ALenum param, ALfloat* values)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (values == NULL)
 	{
@@ -1413,13 +1872,12 @@ AL_API void AL_APIENTRY alGetSourcefv(ALuint sid, ALenum param, ALfloat* values)
 
 AL_API void AL_APIENTRY alGetSourcei(ALuint sid, ALenum param, ALint* value)
 {
-	SceInt32 ret = SCE_NGS_OK;
+	ALint ret = AL_NO_ERROR;
 	ALfloat fret = 0.0f;
 	Source *src = NULL;
-	SceNgsVoiceInfo info;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	switch (param)
 	{
@@ -1469,35 +1927,28 @@ AL_API void AL_APIENTRY alGetSourcei(ALuint sid, ALenum param, ALint* value)
 	case AL_LOOPING:
 		*value = (ALint)src->m_looping;
 		break;
+	case AL_POSITION_EXTRAPOLATION_NGS:
+		*value = (ALint)src->m_extrapolate;
+		break;
+	case AL_VELOCITY_FROM_POSITION_NGS:
+		*value = (ALint)src->m_motion.m_enabled;
+		break;
 	case AL_BUFFER:
 		if (src->m_altype == AL_STATIC)
 		{
-			SceNgsBufferInfo   bufferInfo;
-			SceNgsPlayerParams *pPcmParams;
+			PlayerParams player;
 
-			ret = _alLockNgsResource(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-			if (ret != SCE_NGS_OK)
+			ret = src->m_voice->readPlayer(&player);
+			if (ret != AL_NO_ERROR)
 			{
-				AL_SET_ERROR(_alErrorNgs2Al(ret));
+				AL_SET_ERROR(ret);
 				return;
 			}
 
-			pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
-			for (Buffer *buf : ctx->m_bufferStack)
-			{
-				if (pPcmParams->buffs[0].pBuffer == buf->m_storage)
-				{
-					*value = _alNamedObjectGetName((ALint)buf);
-					break;
-				}
-			}
-
-			ret = sceNgsVoiceUnlockParams(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-			if (ret != SCE_NGS_OK)
+			Buffer *buf = ((DeviceNGS *)ctx->getDevice())->findBuffer(player.buffs[0].pBuffer);
+			if (buf != NULL)
 			{
-				AL_SET_ERROR(_alErrorNgs2Al(ret));
-				return;
+				*value = _alNamedObjectGetName((intptr_t)buf);
 			}
 		}
 		else
@@ -1507,13 +1958,7 @@ AL_API void AL_APIENTRY alGetSourcei(ALuint sid, ALenum param, ALint* value)
 		}
 		break;
 	case AL_SOURCE_STATE:
-		ret = sceNgsVoiceGetInfo(src->m_voice, &info);
-		if (ret != SCE_NGS_OK)
-		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
-			return;
-		}
-		*value = _alSourceStateNgs2Al(info.uVoiceState);
+		*value = src->getPlaybackState();
 		break;
 	case AL_BUFFERS_QUEUED:
 		*value = src->queuedBufferCount();
@@ -1531,7 +1976,7 @@ AL_API void AL_APIENTRY alGetSource3i(ALuint sid, ALenum param, ALint* value1, A
 {
 	ALfloat ret[3];
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (value1 == NULL || value2 == NULL || value3 == NULL)
 	{
@@ -1555,7 +2000,7 @@ AL_API void AL_APIENTRY alGetSource3i(ALuint sid, ALenum param, ALint* value1, A
 
 AL_API void AL_APIENTRY alGetSourceiv(ALuint sid, ALenum param, ALint* values)
 {
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, param)
 
 	if (values == NULL)
 	{
@@ -1573,6 +2018,8 @@ AL_API void AL_APIENTRY alGetSourceiv(ALuint sid, ALenum param, ALint* values)
 	case AL_SOURCE_RELATIVE:
 	case AL_SOURCE_TYPE:
 	case AL_LOOPING:
+	case AL_POSITION_EXTRAPOLATION_NGS:
+	case AL_VELOCITY_FROM_POSITION_NGS:
 	case AL_BUFFER:
 	case AL_SOURCE_STATE:
 	case AL_BUFFERS_QUEUED:
@@ -1591,6 +2038,96 @@ AL_API void AL_APIENTRY alGetSourceiv(ALuint sid, ALenum param, ALint* values)
 	}
 }
 
+AL_API void AL_APIENTRY alGetSourcesivNGS(ALsizei ns, const ALuint *sids, ALenum param, ALint *values)
+{
+	ALint ret = AL_NO_ERROR;
+	Source *src = NULL;
+	Context *ctx = (Context *)alcGetCurrentContext();
+	SourceSnapshot snap;
+
+	AL_TRACE_CALL_ARGS(ns, param)
+
+	if (ctx == NULL)
+	{
+		AL_SET_ERROR(AL_INVALID_OPERATION);
+		return;
+	}
+
+	if (ns < 0 || (ns > 0 && (sids == NULL || values == NULL)))
+	{
+		AL_SET_ERROR(AL_INVALID_VALUE);
+		return;
+	}
+
+	switch (param)
+	{
+	case AL_LOOPING:
+	case AL_SOURCE_STATE:
+	case AL_BUFFERS_QUEUED:
+	case AL_BUFFERS_PROCESSED:
+	case AL_SEC_OFFSET:
+	case AL_SAMPLE_OFFSET:
+	case AL_BYTE_OFFSET:
+		break;
+	default:
+		AL_SET_ERROR(AL_INVALID_ENUM);
+		return;
+	}
+
+	// All names are checked before anything is written, one bad name fails the whole call
+	for (int i = 0; i < ns; i++)
+	{
+		if (!Source::validate((Source *)_alNamedObjectGet(sids[i])))
+		{
+			AL_SET_ERROR(AL_INVALID_NAME);
+			return;
+		}
+	}
+
+	for (int i = 0; i < ns; i++)
+	{
+		src = (Source *)_alNamedObjectGet(sids[i]);
+
+		switch (param)
+		{
+		case AL_LOOPING:
+			values[i] = (ALint)src->m_looping;
+			break;
+		case AL_SOURCE_STATE:
+			values[i] = src->getPlaybackState();
+			break;
+		case AL_BUFFERS_QUEUED:
+			values[i] = src->queuedBufferCount();
+			break;
+		case AL_BUFFERS_PROCESSED:
+			values[i] = src->processedBufferCount();
+			break;
+		default:
+			ret = src->readSnapshot(&snap);
+			if (ret != AL_NO_ERROR)
+			{
+				AL_SET_ERROR(ret);
+				return;
+			}
+
+			if (param == AL_SAMPLE_OFFSET)
+			{
+				values[i] = snap.samplesGenerated;
+			}
+			else if (param == AL_BYTE_OFFSET)
+			{
+				values[i] = snap.bytesConsumed;
+			}
+			else
+			{
+				// Unlike alGetSourcei a source without buffers is not an error here, it reads as 0
+				values[i] = (snap.frequency == 0) ? 0 : snap.bytesConsumed / (2 * snap.channels * snap.frequency);
+			}
+			break;
+		}
+	}
+}
+
 AL_API void AL_APIENTRY alSourcePlayv(ALsizei ns, const ALuint *sids)
 {
 	Context *ctx = (Context *)alcGetCurrentContext();
@@ -1609,12 +2146,12 @@ AL_API void AL_APIENTRY alSourcePlayv(ALsizei ns, const ALuint *sids)
 		return;
 	}
 
-	sceNgsSystemLock(ctx->m_system);
+	ctx->suspend();
 	for (int i = 0; i < ns; i++)
 	{
 		alSourcePlay(sids[i]);
 	}
-	sceNgsSystemUnlock(ctx->m_system);
+	ctx->resume();
 }
 
 AL_API void AL_APIENTRY alSourceStopv(ALsizei ns, const ALuint *sids)
@@ -1635,12 +2172,12 @@ AL_API void AL_APIENTRY alSourceStopv(ALsizei ns, const ALuint *sids)
 		return;
 	}
 
-	sceNgsSystemLock(ctx->m_system);
+	ctx->suspend();
 	for (int i = 0; i < ns; i++)
 	{
 		alSourceStop(sids[i]);
 	}
-	sceNgsSystemUnlock(ctx->m_system);
+	ctx->resume();
 }
 
 AL_API void AL_APIENTRY alSourceRewindv(ALsizei ns, const ALuint *sids)
@@ -1661,12 +2198,12 @@ AL_API void AL_APIENTRY alSourceRewindv(ALsizei ns, const ALuint *sids)
 		return;
 	}
 
-	sceNgsSystemLock(ctx->m_system);
+	ctx->suspend();
 	for (int i = 0; i < ns; i++)
 	{
 		alSourceRewind(sids[i]);
 	}
-	sceNgsSystemUnlock(ctx->m_system);
+	ctx->resume();
 }
 
 AL_API void AL_APIENTRY alSourcePausev(ALsizei ns, const ALuint *sids)
@@ -1687,24 +2224,24 @@ AL_API void AL_APIENTRY alSourcePausev(ALsizei ns, const ALuint *sids)
 		return;
 	}
 
-	sceNgsSystemLock(ctx->m_system);
+	ctx->suspend();
 	for (int i = 0; i < ns; i++)
 	{
 		alSourcePause(sids[i]);
 	}
-	sceNgsSystemUnlock(ctx->m_system);
+	ctx->resume();
 }
 
 AL_API void AL_APIENTRY alSourcePlay(ALuint sid)
 {
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsVoiceInfo info;
+	ALint ret = AL_NO_ERROR;
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	PlayerParams *pPcmParams;
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, 0)
+
+	AL_RECORD_OBJECTS(RecordOp_SourcePlay, sid, 0, NULL)
 
 	if (ctx == NULL)
 	{
@@ -1720,28 +2257,35 @@ AL_API void AL_APIENTRY alSourcePlay(ALuint sid)
 		return;
 	}
 
-	ret = sceNgsVoiceGetInfo(src->m_voice, &info);
-	if (ret != SCE_NGS_OK)
+	if (src->m_capture != NULL)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
+		ret = src->startCapture();
+		if (ret != AL_NO_ERROR)
+		{
+			AL_SET_ERROR(ret);
+			return;
+		}
+
+		src->invalidateSnapshot();
+		src->getContext()->wake();
 		return;
 	}
 
-	if (_alSourceStateNgs2Al(info.uVoiceState) == AL_PAUSED)
+	if (src->m_voice->getState() == AL_PAUSED)
 	{
-		sceNgsVoiceResume(src->m_voice);
+		src->m_voice->resume();
+		src->invalidateSnapshot();
+		src->getContext()->wake();
 	}
 	else
 	{
-		ret = _alLockNgsResource(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-		if (ret != SCE_NGS_OK)
+		ret = src->m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
 
-		pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
 		if (src->m_afterSeek == AL_TRUE)
 		{
 			src->m_afterSeek = AL_FALSE;
@@ -1752,24 +2296,29 @@ AL_API void AL_APIENTRY alSourcePlay(ALuint sid)
 			pPcmParams->nStartByte = 0;
 		}
 
-		ret = sceNgsVoiceUnlockParams(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-		if (ret != SCE_NGS_OK)
+		ret = src->m_voice->unlockPlayer();
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
 
 		/* TODO: find a better way to do this */
+		src->beginParamUpdate();
+		src->m_rampSnap = AL_TRUE;
+		src->endParamUpdate();
 		src->update();
 
-		ret = sceNgsVoiceSetModuleCallback(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, Source::streamCallback, src);
-		if (ret != SCE_NGS_OK)
+		ret = src->m_voice->setCallback(Source::streamCallback, src);
+		if (ret != AL_NO_ERROR)
 		{
-			AL_SET_ERROR(_alErrorNgs2Al(ret));
+			AL_SET_ERROR(ret);
 			return;
 		}
 
-		sceNgsVoicePlay(src->m_voice);
+		src->m_voice->play();
+		src->invalidateSnapshot();
+		src->getContext()->wake();
 	}
 }
 
@@ -1778,7 +2327,9 @@ AL_API void AL_APIENTRY alSourceStop(ALuint sid)
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, 0)
+
+	AL_RECORD_OBJECTS(RecordOp_SourceStop, sid, 0, NULL)
 
 	if (ctx == NULL)
 	{
@@ -1794,9 +2345,16 @@ AL_API void AL_APIENTRY alSourceStop(ALuint sid)
 		return;
 	}
 
-	sceNgsVoiceSetModuleCallback(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL);
+	if (src->m_capture != NULL)
+	{
+		src->stopCapture();
+	}
+
+	src->m_voice->setCallback(NULL, NULL);
 
-	sceNgsVoiceKill(src->m_voice);
+	src->m_voice->kill();
+
+	src->invalidateSnapshot();
 }
 
 AL_API void AL_APIENTRY alSourceRewind(ALuint sid)
@@ -1804,7 +2362,9 @@ AL_API void AL_APIENTRY alSourceRewind(ALuint sid)
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, 0)
+
+	AL_RECORD_OBJECTS(RecordOp_SourceRewind, sid, 0, NULL)
 
 	if (ctx == NULL)
 	{
@@ -1820,9 +2380,16 @@ AL_API void AL_APIENTRY alSourceRewind(ALuint sid)
 		return;
 	}
 
-	sceNgsVoiceSetModuleCallback(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL);
+	if (src->m_capture != NULL)
+	{
+		src->stopCapture();
+	}
+
+	src->m_voice->setCallback(NULL, NULL);
 
-	sceNgsVoiceKill(src->m_voice);
+	src->m_voice->kill();
+
+	src->invalidateSnapshot();
 }
 
 AL_API void AL_APIENTRY alSourcePause(ALuint sid)
@@ -1830,7 +2397,9 @@ AL_API void AL_APIENTRY alSourcePause(ALuint sid)
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, 0)
+
+	AL_RECORD_OBJECTS(RecordOp_SourcePause, sid, 0, NULL)
 
 	if (ctx == NULL)
 	{
@@ -1846,7 +2415,15 @@ AL_API void AL_APIENTRY alSourcePause(ALuint sid)
 		return;
 	}
 
-	sceNgsVoicePause(src->m_voice);
+	// Playing again resyncs to the newest captured audio rather than resuming a stale backlog
+	if (src->m_capture != NULL)
+	{
+		src->stopCapture();
+	}
+
+	src->m_voice->pause();
+
+	src->invalidateSnapshot();
 }
 
 AL_API void AL_APIENTRY alSourceQueueBuffers(ALuint sid, ALsizei numEntries, const ALuint *bids)
@@ -1860,7 +2437,9 @@ AL_API void AL_APIENTRY alSourceQueueBuffers(ALuint sid, ALsizei numEntries, con
 	ALint bits = 0;
 	ALint channels = 0;
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, numEntries)
+
+	AL_RECORD_OBJECTS(RecordOp_SourceQueueBuffers, sid, numEntries, bids)
 
 	if (ctx == NULL)
 	{
@@ -1882,7 +2461,7 @@ AL_API void AL_APIENTRY alSourceQueueBuffers(ALuint sid, ALsizei numEntries, con
 		return;
 	}
 
-	if (src->m_altype == AL_STATIC)
+	if (src->m_altype == AL_STATIC || src->m_capture != NULL)
 	{
 		AL_SET_ERROR(AL_INVALID_OPERATION);
 		return;
@@ -1890,9 +2469,9 @@ AL_API void AL_APIENTRY alSourceQueueBuffers(ALuint sid, ALsizei numEntries, con
 
 	buffersInQueue = src->queuedBufferCount();
 
-	if (numEntries > SCE_NGS_PLAYER_MAX_BUFFERS - buffersInQueue)
+	if (numEntries > AL_PLAYER_MAX_BUFFERS - buffersInQueue)
 	{
-		AL_WARNING("Attempt to enqueue more than (SCE_NGS_PLAYER_MAX_BUFFERS(%d) - src->queuedBufferCount()(%d)) buffers\n", SCE_NGS_PLAYER_MAX_BUFFERS, buffersInQueue);
+		AL_WARNING("Attempt to enqueue more than (AL_PLAYER_MAX_BUFFERS(%d) - src->queuedBufferCount()(%d)) buffers\n", AL_PLAYER_MAX_BUFFERS, buffersInQueue);
 		AL_SET_ERROR(AL_INVALID_VALUE);
 		return;
 	}
@@ -1957,11 +2536,12 @@ AL_API void AL_APIENTRY alSourceUnqueueBuffers(ALuint sid, ALsizei numEntries, A
 {
 	Source *src = NULL;
 	Context *ctx = (Context *)alcGetCurrentContext();
-	SceInt32 ret = SCE_NGS_OK;
-	SceNgsBufferInfo   bufferInfo;
-	SceNgsPlayerParams *pPcmParams;
+	ALint ret = AL_NO_ERROR;
+	PlayerParams *pPcmParams;
 
-	AL_TRACE_CALL
+	AL_TRACE_CALL_ARGS(sid, numEntries)
+
+	AL_RECORD_OBJECTS(RecordOp_SourceUnqueueBuffers, sid, numEntries, NULL)
 
 	if (ctx == NULL)
 	{
@@ -1999,48 +2579,78 @@ AL_API void AL_APIENTRY alSourceUnqueueBuffers(ALuint sid, ALsizei numEntries, A
 	ALint flagToCheck = -1;
 	ALint outCount = 0;
 
-	ret = _alLockNgsResource(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
-	if (ret != SCE_NGS_OK)
+	ret = src->m_voice->lockPlayer(&pPcmParams, LockSite_Api);
+	if (ret != AL_NO_ERROR)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
+		AL_SET_ERROR(ret);
 		return;
 	}
 
-	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
-
-	for (int i = 0; i < SCE_NGS_PLAYER_MAX_BUFFERS; i++)
+	for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
 	{
 		flagToCheck = 1 << i;
 
 		if (flags & flagToCheck)
 		{
-			for (Buffer *buf : ctx->m_bufferStack)
+			Buffer *buf = ((DeviceNGS *)ctx->getDevice())->findBuffer(pPcmParams->buffs[i].pBuffer);
+			if (buf != NULL)
 			{
-				if (pPcmParams->buffs[i].pBuffer == buf->m_storage)
+				buf->deref();
+				if (buf->m_refCounter == 0)
 				{
-					buf->deref();
-					if (buf->m_refCounter == 0)
-					{
-						buf->m_state = AL_UNUSED;
-					}
-
-					bids[outCount] = _alNamedObjectGetName((ALint)buf);
-					outCount++;
-					break;
+					buf->m_state = AL_UNUSED;
 				}
+
+				bids[outCount] = _alNamedObjectGetName((intptr_t)buf);
+				outCount++;
 			}
 			pPcmParams->buffs[i].pBuffer = NULL;
 			pPcmParams->buffs[i].nNumBytes = 0;
 			pPcmParams->buffs[i].nLoopCount = 0;
-			pPcmParams->buffs[i].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+			pPcmParams->buffs[i].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
 			src->m_processedBuffers &= ~flagToCheck;
 		}
 	}
 
-	ret = sceNgsVoiceUnlockParams(src->m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
-	if (ret != SCE_NGS_OK)
+	ret = src->m_voice->unlockPlayer();
+	if (ret != AL_NO_ERROR)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
+		AL_SET_ERROR(ret);
 		return;
 	}
+}
+AL_API void AL_APIENTRY alSourceCaptureNGS(ALuint sid, ALCdevice *device)
+{
+	ALint ret = AL_NO_ERROR;
+	Source *src = NULL;
+	Context *ctx = (Context *)alcGetCurrentContext();
+
+	AL_TRACE_CALL_ARGS(sid, 0)
+
+	if (ctx == NULL)
+	{
+		AL_SET_ERROR(AL_INVALID_OPERATION);
+		return;
+	}
+
+	src = (Source *)_alNamedObjectGet(sid);
+
+	if (!Source::validate(src))
+	{
+		AL_SET_ERROR(AL_INVALID_NAME);
+		return;
+	}
+
+	if (device != NULL && !DeviceAudioIn::validate(device))
+	{
+		AL_SET_ERROR(AL_INVALID_VALUE);
+		return;
+	}
+
+	ret = src->bindCapture((DeviceAudioIn *)device);
+	if (ret != AL_NO_ERROR)
+	{
+		AL_SET_ERROR(ret);
+		return;
+	}
 }
\ No newline at end of file
@@ -19,17 +19,34 @@ static ALCchar s_alcNoDeviceExtList[] =
 	"AL_EXT_LINEAR_DISTANCE "
 	"AL_SOFT_deferred_updates "
 	"ALC_EXT_CAPTURE "
+	"ALC_SOFT_loopback "
 	"ALC_NGS_MEMORY_FUNCTIONS";
 
 //Each device name will be separated by a single NULL character and the list will be terminated with two NULL characters
 static ALCchar s_alcAllDevicesList[] =
 	AL_DEVICE_NAME
+	"\0"
+	AL_NULL_DEVICE_NAME
 	"\0";
 
 static ALCchar s_alcAllCaptureDevicesList[] =
 	AL_CAPTURE_DEVICE_NAME
 	"\0";
 
+// ALC_ALL_ATTRIBUTES order, a device reports the first getAttributeCount() of these
+static const ALCenum s_alcAllAttributes[] =
+{
+	ALC_FREQUENCY,
+	ALC_MONO_SOURCES,
+	ALC_STEREO_SOURCES,
+	ALC_REFRESH,
+	ALC_SYNC,
+	ALC_GRANULARITY_NGS,
+	ALC_OUTPUT_BUFFERS_NGS,
+	ALC_SOFTWARE_MIXER_NGS,
+	ALC_RENDER_SYSTEMS_NGS
+};
+
 ALC_API ALCdevice* ALC_APIENTRY alcCaptureOpenDevice(const ALCchar *devicename, ALCuint frequency, ALCenum format, ALCsizei buffersize)
 {
 	DeviceAudioIn *dev = NULL;
@@ -90,6 +107,13 @@ ALC_API ALCboolean ALC_APIENTRY alcCaptureCloseDevice(ALCdevice *device)
 
 	dev = (DeviceAudioIn *)device;
 
+	// A source still plays straight out of the ring, it has to be detached first
+	if (dev->isMonitored())
+	{
+		AL_SET_ERROR(ALC_INVALID_VALUE);
+		return ALC_FALSE;
+	}
+
 	delete dev;
 
 	s_deviceCaptureExists = ALC_FALSE;
@@ -109,6 +133,8 @@ ALC_API void ALC_APIENTRY alcCaptureStart(ALCdevice *device)
 		return;
 	}
 
+	dev = (DeviceAudioIn *)device;
+
 	if (!dev->start())
 	{
 		AL_SET_ERROR(ALC_INVALID_VALUE);
@@ -128,6 +154,8 @@ ALC_API void ALC_APIENTRY alcCaptureStop(ALCdevice *device)
 		return;
 	}
 
+	dev = (DeviceAudioIn *)device;
+
 	if (!dev->stop())
 	{
 		AL_SET_ERROR(ALC_INVALID_VALUE);
@@ -147,6 +175,14 @@ ALC_API void ALC_APIENTRY alcCaptureSamples(ALCdevice *device, ALCvoid *buffer,
 		return;
 	}
 
+	dev = (DeviceAudioIn *)device;
+
+	if (samples > 0 && buffer == NULL)
+	{
+		AL_SET_ERROR(ALC_INVALID_VALUE);
+		return;
+	}
+
 	if (!dev->captureSamples(buffer, samples))
 	{
 		AL_SET_ERROR(ALC_INVALID_VALUE);
@@ -157,12 +193,17 @@ ALC_API void ALC_APIENTRY alcCaptureSamples(ALCdevice *device, ALCvoid *buffer,
 ALC_API ALCdevice *ALC_APIENTRY alcOpenDevice(const ALCchar *devicename)
 {
 	DeviceNGS *dev = NULL;
+	DeviceOutput output = DeviceOutput_Port;
 
 	AL_TRACE_CALL
 
 	if (devicename)
 	{
-		if (strncmp(AL_DEVICE_NAME, devicename, sizeof(AL_DEVICE_NAME) - 1))
+		if (!strcmp(AL_NULL_DEVICE_NAME, devicename))
+		{
+			output = DeviceOutput_Null;
+		}
+		else if (strncmp(AL_DEVICE_NAME, devicename, sizeof(AL_DEVICE_NAME) - 1))
 		{
 			AL_SET_ERROR(ALC_INVALID_VALUE);
 			return NULL;
@@ -175,7 +216,7 @@ ALC_API ALCdevice *ALC_APIENTRY alcOpenDevice(const ALCchar *devicename)
 		return NULL;
 	}
 
-	dev = new DeviceNGS();
+	dev = new DeviceNGS(output);
 
 	s_deviceExists = ALC_TRUE;
 
@@ -206,6 +247,7 @@ ALC_API ALCboolean ALC_APIENTRY alcCloseDevice(ALCdevice *device)
 ALC_API ALCcontext *ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCint* attrlist)
 {
 	DeviceNGS *dev = NULL;
+	Context *ctx = NULL;
 	ALCint ret = ALC_NO_ERROR;
 
 	AL_TRACE_CALL
@@ -218,7 +260,8 @@ ALC_API ALCcontext *ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
 
 	dev = (DeviceNGS *)device;
 
-	if (dev->getContext() != NULL)
+	// alcRenderSamplesSOFT hands out a single context's mix, so loopback devices stay at one
+	if (dev->getOutputMode() == DeviceOutput_Loopback && dev->getContext() != NULL)
 	{
 		AL_SET_ERROR(ALC_INVALID_VALUE);
 		return NULL;
@@ -235,14 +278,14 @@ ALC_API ALCcontext *ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
 		dev->setAttributes(attrlist);
 	}
 
-	ret = dev->createContext();
+	ret = dev->createContext(attrlist, &ctx);
 	if (ret != ALC_NO_ERROR)
 	{
 		AL_SET_ERROR(ret);
 		return NULL;
 	}
 
-	return (ALCcontext *)dev->getContext();
+	return (ALCcontext *)ctx;
 }
 
 ALC_API ALCboolean ALC_APIENTRY alcMakeContextCurrent(ALCcontext *context)
@@ -320,9 +363,12 @@ ALC_API void ALC_APIENTRY alcDestroyContext(ALCcontext *context)
 
 	ctx = (Context *)context;
 
-	ctx->getDevice()->destroyContext();
+	((DeviceNGS *)ctx->getDevice())->destroyContext(ctx);
 
-	s_currentContext = NULL;
+	if (s_currentContext == context)
+	{
+		s_currentContext = NULL;
+	}
 }
 
 ALC_API ALCcontext *ALC_APIENTRY alcGetCurrentContext(void)
@@ -501,6 +547,8 @@ ALC_API ALCenum ALC_APIENTRY alcGetEnumValue(ALCdevice *device, const ALCchar *e
 ALC_API void ALC_APIENTRY alcGetIntegerv(ALCdevice *device, ALCenum param, ALCsizei size, ALCint *data)
 {
 	Device *dev = NULL;
+	Context *ctx = NULL;
+	ALCint count = 0;
 
 	AL_TRACE_CALL
 
@@ -538,23 +586,74 @@ ALC_API void ALC_APIENTRY alcGetIntegerv(ALCdevice *device, ALCenum param, ALCsi
 		{
 			dev = (Device *)device;
 
-			if (size < dev->getAttributeCount() * 2 + 1)
+			count = dev->getAttributeCount();
+
+			// Checked against what is actually written, a capture device only writes the terminator
+			if (size < count * 2 + 1)
 			{
 				AL_SET_ERROR(ALC_INVALID_VALUE);
 				return;
 			}
 
-			data[0] = ALC_FREQUENCY;
-			data[1] = dev->getAttribute(ALC_FREQUENCY);
-			data[2] = ALC_MONO_SOURCES;
-			data[3] = dev->getAttribute(ALC_MONO_SOURCES);
-			data[4] = ALC_STEREO_SOURCES;
-			data[5] = dev->getAttribute(ALC_STEREO_SOURCES);
-			data[6] = ALC_REFRESH;
-			data[7] = dev->getAttribute(ALC_REFRESH);
-			data[8] = ALC_SYNC;
-			data[9] = dev->getAttribute(ALC_SYNC);
-			data[10] = 0;
+			for (ALCint i = 0; i < count; i++)
+			{
+				data[i * 2] = s_alcAllAttributes[i];
+				data[i * 2 + 1] = dev->getAttribute(s_alcAllAttributes[i]);
+			}
+
+			data[count * 2] = 0;
+		}
+		break;
+	case ALC_CAPTURE_SAMPLES:
+		if (!DeviceAudioIn::validate(device))
+		{
+			AL_SET_ERROR(ALC_INVALID_DEVICE);
+		}
+		else
+		{
+			data[0] = ((DeviceAudioIn *)device)->getAvailableSamples();
+		}
+		break;
+	case ALC_CAPTURE_CONVERSION_COST_NGS:
+		if (!DeviceAudioIn::validate(device))
+		{
+			AL_SET_ERROR(ALC_INVALID_DEVICE);
+		}
+		else
+		{
+			data[0] = ((DeviceAudioIn *)device)->getConversionCost();
+		}
+		break;
+	case ALC_OUTPUT_LATENCY_NGS:
+	case ALC_UNDERRUN_COUNT_NGS:
+	case ALC_MAX_RENDER_TIME_NGS:
+	case ALC_MAX_OUTPUT_BLOCK_TIME_NGS:
+	case ALC_IDLE_TIME_NGS:
+	case ALC_GRANULES_PER_SECOND_NGS:
+	case ALC_RACK_COUNT_NGS:
+	case ALC_VOICE_CAPACITY_NGS:
+	case ALC_FIRST_SAMPLE_LATENCY_NGS:
+		if (!DeviceNGS::validate(device))
+		{
+			AL_SET_ERROR(ALC_INVALID_DEVICE);
+		}
+		else
+		{
+			// Statistics are per context, prefer the current one when it lives on this device
+			ctx = (Context *)s_currentContext;
+			if (ctx == NULL || ((DeviceNGS *)device)->ownsContext(ctx) == ALC_FALSE)
+			{
+				ctx = ((DeviceNGS *)device)->getContext();
+			}
+
+			if (ctx == NULL)
+			{
+				AL_SET_ERROR(ALC_INVALID_CONTEXT);
+			}
+			else
+			{
+				ctx->getIntegerv(param, data);
+			}
 		}
 		break;
 	default:
@@ -563,6 +662,152 @@ ALC_API void ALC_APIENTRY alcGetIntegerv(ALCdevice *device, ALCenum param, ALCsi
 	}
 }
 
+/*
+*
+* OpenAL-Soft
+*
+*/
+
+ALC_API ALCdevice *ALC_APIENTRY alcLoopbackOpenDeviceSOFT(const ALCchar *deviceName)
+{
+	DeviceNGS *dev = NULL;
+
+	AL_TRACE_CALL
+
+	if (deviceName)
+	{
+		if (strncmp(AL_DEVICE_NAME, deviceName, sizeof(AL_DEVICE_NAME) - 1))
+		{
+			AL_SET_ERROR(ALC_INVALID_VALUE);
+			return NULL;
+		}
+	}
+
+	if (s_deviceExists == ALC_TRUE)
+	{
+		AL_SET_ERROR(ALC_INVALID_VALUE);
+		return NULL;
+	}
+
+	dev = new DeviceNGS(DeviceOutput_Loopback);
+
+	s_deviceExists = ALC_TRUE;
+
+	return (ALCdevice *)dev;
+}
+
+ALC_API ALCboolean ALC_APIENTRY alcIsRenderFormatSupportedSOFT(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type)
+{
+	DeviceNGS *dev = NULL;
+
+	AL_TRACE_CALL
+
+	if (!DeviceNGS::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return ALC_FALSE;
+	}
+
+	dev = (DeviceNGS *)device;
+
+	if (dev->getOutputMode() != DeviceOutput_Loopback)
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return ALC_FALSE;
+	}
+
+	if (freq <= 0)
+	{
+		AL_SET_ERROR(ALC_INVALID_VALUE);
+		return ALC_FALSE;
+	}
+
+	return dev->isRenderFormatSupported(freq, channels, type);
+}
+
+ALC_API void ALC_APIENTRY alcRenderSamplesSOFT(ALCdevice *device, ALCvoid *buffer, ALCsizei samples)
+{
+	DeviceNGS *dev = NULL;
+
+	AL_TRACE_CALL
+
+	if (!DeviceNGS::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return;
+	}
+
+	dev = (DeviceNGS *)device;
+
+	if (dev->getOutputMode() != DeviceOutput_Loopback)
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return;
+	}
+
+	if (samples < 0 || (samples > 0 && buffer == NULL))
+	{
+		AL_SET_ERROR(ALC_INVALID_VALUE);
+		return;
+	}
+
+	if (dev->getContext() == NULL)
+	{
+		memset(buffer, 0, samples * 2 * sizeof(int16_t));
+		return;
+	}
+
+	dev->getContext()->renderSamples((int16_t *)buffer, samples);
+}
+
+ALC_API ALCboolean ALC_APIENTRY alcResetDeviceSOFT(ALCdevice *device, const ALCint *attribs)
+{
+	ALCint ret = ALC_NO_ERROR;
+
+	AL_TRACE_CALL
+
+	if (!DeviceNGS::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return ALC_FALSE;
+	}
+
+	ret = ((DeviceNGS *)device)->reset(attribs);
+	if (ret != ALC_NO_ERROR)
+	{
+		AL_SET_ERROR(ret);
+		return ALC_FALSE;
+	}
+
+	return ALC_TRUE;
+}
+
+ALC_API void ALC_APIENTRY alcDevicePauseSOFT(ALCdevice *device)
+{
+	AL_TRACE_CALL
+
+	if (!DeviceNGS::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return;
+	}
+
+	((DeviceNGS *)device)->pause();
+}
+
+ALC_API void ALC_APIENTRY alcDeviceResumeSOFT(ALCdevice *device)
+{
+	AL_TRACE_CALL
+
+	if (!DeviceNGS::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return;
+	}
+
+	((DeviceNGS *)device)->resume();
+}
+
 /*
 *
 * NGS
@@ -605,4 +850,34 @@ AL_API void AL_APIENTRY alcSetMemoryFunctionsNGS(AlMemoryAllocNGS alloc, AlMemor
 	g_alloc = alloc;
 	g_memalign = allocAlign;
 	g_free = free;
+}
+AL_API void AL_APIENTRY alcCaptureResamplerNGS(ALCdevice *device, ALCenum resampler)
+{
+	DeviceAudioIn *dev = NULL;
+
+	AL_TRACE_CALL
+
+	if (!DeviceAudioIn::validate(device))
+	{
+		AL_SET_ERROR(ALC_INVALID_DEVICE);
+		return;
+	}
+
+	dev = (DeviceAudioIn *)device;
+
+	switch (resampler)
+	{
+	case ALC_RESAMPLER_POINT_NGS:
+		dev->setResamplerQuality(ResamplerQuality_Point);
+		break;
+	case ALC_RESAMPLER_LINEAR_NGS:
+		dev->setResamplerQuality(ResamplerQuality_Linear);
+		break;
+	case ALC_RESAMPLER_CUBIC_NGS:
+		dev->setResamplerQuality(ResamplerQuality_Cubic);
+		break;
+	default:
+		AL_SET_ERROR(ALC_INVALID_ENUM);
+		break;
+	}
 }
\ No newline at end of file
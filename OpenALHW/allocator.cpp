@@ -0,0 +1,10 @@
+#include <stdlib.h>
+#ifndef __psp2__
+#include <malloc.h>
+#endif
+
+#include "allocator.h"
+
+AlMemoryAllocNGS g_alloc = malloc;
+AlMemoryAllocAlignNGS g_memalign = memalign;
+AlMemoryFreeNGS g_free = free;
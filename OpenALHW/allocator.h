@@ -0,0 +1,16 @@
+#ifndef AL_ALLOCATOR_H
+#define AL_ALLOCATOR_H
+
+#include "AL/al.h"
+#include "AL/alext.h"
+
+// Located in allocator.cpp, replaced through alcSetMemoryFunctionsNGS
+extern AlMemoryAllocNGS g_alloc;
+extern AlMemoryAllocAlignNGS g_memalign;
+extern AlMemoryFreeNGS g_free;
+
+#define AL_MALLOC(x)		g_alloc(x)
+#define AL_MEMALIGN(x, y)	g_memalign(x, y)
+#define AL_FREE(x)			g_free(x)
+
+#endif
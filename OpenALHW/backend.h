@@ -0,0 +1,231 @@
+#ifndef AL_BACKEND_H
+#define AL_BACKEND_H
+
+#include <stdint.h>
+
+#include "AL/al.h"
+#include "platform.h"
+#include "counters.h"
+
+namespace al {
+
+	#define AL_PLAYER_MAX_BUFFERS		(4)
+	#define AL_PLAYER_NO_NEXT_BUFFER	(-1)
+	#define AL_PLAYER_LOOP_CONTINUOUS	(-1)
+
+	// Source racks are added to a system in blocks of this many voices
+	#define NGS_RACK_VOICES				(32)
+
+	enum VoiceEvent
+	{
+		VoiceEvent_SwappedBuffer,
+		VoiceEvent_EndOfData
+	};
+
+	class Voice;
+
+	// Invoked from the render thread, bufferIdx is the slot that just finished playing
+	typedef ALvoid(*VoiceCallback)(Voice *pVoice, VoiceEvent event, ALint bufferIdx, ALvoid *pUserData);
+
+	struct PlayerBuffer
+	{
+		const ALvoid *pBuffer;
+		ALint nNumBytes;
+		ALint nLoopCount;
+		ALint nNextBuff;
+	};
+
+	// 16-bit PCM player, mono sources are played on both output channels
+	struct PlayerParams
+	{
+		PlayerBuffer buffs[AL_PLAYER_MAX_BUFFERS];
+		float32_t fPlaybackFrequency;
+		float32_t fPlaybackScalar;
+		ALint nChannels;
+		ALint nStartBuffer;
+		ALint nStartByte;
+	};
+
+	struct PlayerState
+	{
+		ALint nBytesConsumedSinceKeyOn;
+		ALint nSamplesGeneratedSinceKeyOn;
+	};
+
+	class Voice
+	{
+	public:
+
+		virtual ~Voice() {}
+
+		virtual ALint play() =0;
+		virtual ALint kill() =0;
+		virtual ALint pause() =0;
+		virtual ALint resume() =0;
+		virtual ALint getState() =0;
+		virtual ALint getPlayerState(PlayerState *pState) =0;
+		// site tells the lock statistics who waited, tryLockPlayer fails instead of waiting so the caller can defer
+		virtual ALint lockPlayer(PlayerParams **ppParams, LockSite site) =0;
+		virtual ALint tryLockPlayer(PlayerParams **ppParams, LockSite site) =0;
+		virtual ALint unlockPlayer() =0;
+		// Copy of the params for getters, waits on the voice lock but never on an NGS param lock
+		virtual ALint readPlayer(PlayerParams *pParams) =0;
+		virtual ALint setFilter(float32_t fFrequency) =0;
+		virtual ALint setPatchVolumes(const float32_t volumeMatrix[2][2]) =0;
+		virtual ALint getOutputChannels() =0;
+		virtual ALint setCallback(VoiceCallback callback, ALvoid *pUserData) =0;
+	};
+
+	class Backend
+	{
+	public:
+
+		virtual ~Backend() {}
+
+		virtual ALint init(ALint granularity, ALint frequency, ALint maxVoices) =0;
+		virtual Voice *acquireVoice() =0;
+		virtual ALvoid releaseVoice(Voice *pVoice) =0;
+		virtual ALvoid render(int16_t *pOut) =0;
+		virtual ALint lock() =0;
+		virtual ALint unlock() =0;
+		virtual ALboolean ownsVoice(Voice *pVoice) =0;
+		virtual ALint getRackCount() =0;
+		virtual ALint getVoiceCapacity() =0;
+	};
+
+	class VoiceSoft : public Voice
+	{
+	public:
+
+		VoiceSoft();
+		~VoiceSoft();
+
+		ALint play();
+		ALint kill();
+		ALint pause();
+		ALint resume();
+		ALint getState();
+		ALint getPlayerState(PlayerState *pState);
+		ALint lockPlayer(PlayerParams **ppParams, LockSite site);
+		ALint tryLockPlayer(PlayerParams **ppParams, LockSite site);
+		ALint unlockPlayer();
+		ALint readPlayer(PlayerParams *pParams);
+		ALint setFilter(float32_t fFrequency);
+		ALint setPatchVolumes(const float32_t volumeMatrix[2][2]);
+		ALint getOutputChannels();
+		ALint setCallback(VoiceCallback callback, ALvoid *pUserData);
+
+		ALint init(ALint frequency);
+		ALvoid release();
+		ALvoid attach();
+		ALvoid mix(float32_t *pMix, float32_t *pScratch, ALint frames);
+		ALvoid dispatchEvents();
+
+		ALboolean m_used;
+
+	private:
+
+		#define AL_SOFT_MAX_EVENTS		(AL_PLAYER_MAX_BUFFERS + 1)
+
+		ALvoid reset();
+		ALint generate(float32_t *pOut, ALint frames);
+		ALvoid pushEvent(VoiceEvent event, ALint bufferIdx);
+
+		AlMutex m_lock;
+		PlayerParams m_player;
+		volatile ALint m_state;
+		ALint m_frequency;
+
+		ALint m_bufIdx;
+		ALint m_framePos;
+		float32_t m_frac;
+		ALint m_loopsLeft;
+		ALint m_bytesConsumed;
+		ALint m_samplesGenerated;
+
+		float32_t m_filterCoef;
+		float32_t m_filterState[2];
+		float32_t m_volumes[2][2];
+
+		VoiceCallback m_callback;
+		ALvoid *m_userData;
+		VoiceEvent m_events[AL_SOFT_MAX_EVENTS];
+		ALint m_eventBuffers[AL_SOFT_MAX_EVENTS];
+		ALint m_eventCount;
+	};
+
+	class BackendSoft : public Backend
+	{
+	public:
+
+		BackendSoft();
+		~BackendSoft();
+
+		ALint init(ALint granularity, ALint frequency, ALint maxVoices);
+		Voice *acquireVoice();
+		ALvoid releaseVoice(Voice *pVoice);
+		ALvoid render(int16_t *pOut);
+		ALint lock();
+		ALint unlock();
+		ALboolean ownsVoice(Voice *pVoice);
+		ALint getRackCount();
+		ALint getVoiceCapacity();
+
+	private:
+
+		ALint m_granularity;
+		ALint m_voiceCount;
+		VoiceSoft *m_voices;
+		float32_t *m_mix;
+		float32_t *m_scratch;
+		AlMutex m_lock;
+		ALboolean m_lockCreated;
+	};
+
+	// Partitions voices across several child backends, each rendered by its own thread
+	class BackendSplit : public Backend
+	{
+	public:
+
+		BackendSplit(ALint systemCount, ALuint affinity, ALboolean software);
+		~BackendSplit();
+
+		ALint init(ALint granularity, ALint frequency, ALint maxVoices);
+		Voice *acquireVoice();
+		ALvoid releaseVoice(Voice *pVoice);
+		ALvoid render(int16_t *pOut);
+		ALint lock();
+		ALint unlock();
+		ALboolean ownsVoice(Voice *pVoice);
+		ALint getRackCount();
+		ALint getVoiceCapacity();
+
+	private:
+
+		struct Worker
+		{
+			BackendSplit *pOwner;
+			Backend *pBackend;
+			int16_t *pBuffer;
+			AlSema startSema;
+			AlThread thread;
+			volatile int32_t activeVoices;
+		};
+
+		static ALvoid workerThread(ALvoid *pArg);
+
+		ALvoid startWorkers();
+
+		ALint m_granularity;
+		ALint m_systemCount;
+		ALuint m_affinity;
+		ALboolean m_software;
+		Worker *m_workers;
+		AlSema m_doneSema;
+		ALint m_runningWorkers;
+		ALboolean m_started;
+		volatile ALboolean m_active;
+	};
+}
+
+#endif
@@ -0,0 +1,976 @@
+#include <kernel.h>
+#include <ngs.h>
+#include <string.h>
+#include <algorithm>
+#include <sce_atomic.h>
+
+#include "common.h"
+#include "backend_ngs.h"
+
+using namespace al;
+
+// Voice mutex waits go into the same per-site statistics as the NGS param locks, one retry stands for a contended lock
+static ALvoid _alLockVoiceMutex(SceKernelLwMutexWork *pLock, LockSite site)
+{
+	SceUInt64 start = 0;
+
+	if (sceKernelTryLockLwMutex(pLock, 1) == SCE_OK)
+	{
+		_alCounterLock(site, 0, 0);
+		return;
+	}
+
+	start = sceKernelGetProcessTimeWide();
+	sceKernelLockLwMutex(pLock, 1, NULL);
+	_alCounterLock(site, 1, (ALuint)(sceKernelGetProcessTimeWide() - start));
+}
+
+VoiceNGS::VoiceNGS()
+	: m_used(AL_FALSE),
+	m_queued(AL_FALSE),
+	m_backend(NULL),
+	m_voice(AL_INVALID_NGS_HANDLE),
+	m_patch(AL_INVALID_NGS_HANDLE),
+	m_outputChannels(2),
+	m_filterFrequency(-1.0f),
+	m_pending(0),
+	m_callback(NULL),
+	m_userData(NULL)
+{
+	resetShadow();
+}
+
+VoiceNGS::~VoiceNGS()
+{
+
+}
+
+ALint VoiceNGS::init(BackendNGS *pBackend)
+{
+	m_backend = pBackend;
+
+	if (sceKernelCreateLwMutex(&m_lock, "OpenALHW::VoiceMtx", 0, 0, NULL) != SCE_OK)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	return AL_NO_ERROR;
+}
+
+ALvoid VoiceNGS::release()
+{
+	sceKernelDeleteLwMutex(&m_lock);
+}
+
+ALvoid VoiceNGS::moduleCallback(const SceNgsCallbackInfo *pCallbackInfo)
+{
+	VoiceNGS *voice = (VoiceNGS *)pCallbackInfo->pUserData;
+	VoiceCallback callback = voice->m_callback;
+
+	if (callback == NULL)
+	{
+		return;
+	}
+
+	if (pCallbackInfo->nCallbackData == SCE_NGS_PLAYER_SWAPPED_BUFFER)
+	{
+		callback(voice, VoiceEvent_SwappedBuffer, pCallbackInfo->nCallbackData2, voice->m_userData);
+	}
+	else if (pCallbackInfo->nCallbackData == SCE_NGS_PLAYER_END_OF_DATA)
+	{
+		callback(voice, VoiceEvent_EndOfData, pCallbackInfo->nCallbackData2, voice->m_userData);
+	}
+}
+
+ALvoid VoiceNGS::resetShadow()
+{
+	// Matches what attach writes into the NGS player
+	memset(&m_player, 0, sizeof(PlayerParams));
+	m_player.fPlaybackScalar = 1.0f;
+	m_player.nChannels = 1;
+
+	for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
+	{
+		m_player.buffs[i].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+	}
+
+	memset(&m_volumes, 0, sizeof(SceNgsVolumeMatrix));
+}
+
+ALint VoiceNGS::attach(SceNgsHVoice hVoice, SceNgsHVoice hMaster)
+{
+	SceInt32 ret = SCE_NGS_OK;
+	SceNgsBufferInfo   bufferInfo;
+	SceNgsPlayerParams *pPcmParams;
+	SceNgsPatchSetupInfo patchInfo;
+	SceNgsPatchRouteInfo patchRouteInfo;
+
+	m_voice = hVoice;
+
+	// The NGS filter starts out unset, so the first setFilter always has to go through
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+	resetShadow();
+	m_filterFrequency = -1.0f;
+	m_pending = 0;
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	sceNgsVoiceBypassModule(m_voice, SCE_NGS_SIMPLE_VOICE_EQ, SCE_NGS_MODULE_FLAG_BYPASSED);
+
+	ret = sceNgsVoiceLockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	memset(bufferInfo.data, 0, bufferInfo.size);
+	pPcmParams = (SceNgsPlayerParams *)bufferInfo.data;
+	pPcmParams->desc.id = SCE_NGS_PLAYER_PARAMS_STRUCT_ID;
+	pPcmParams->desc.size = sizeof(SceNgsPlayerParams);
+
+	pPcmParams->fPlaybackScalar = 1.0f;
+	pPcmParams->nLeadInSamples = 0;
+	pPcmParams->nLimitNumberOfSamplesPlayed = 0;
+	pPcmParams->nChannels = 1;
+
+	pPcmParams->nType = SCE_NGS_PLAYER_TYPE_PCM;
+	pPcmParams->nStartBuffer = 0;
+	pPcmParams->nStartByte = 0;
+
+	for (int i = 0; i < SCE_NGS_PLAYER_MAX_BUFFERS; i++)
+	{
+		pPcmParams->buffs[i].nNextBuff = SCE_NGS_PLAYER_NO_NEXT_BUFFER;
+	}
+
+	ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	patchInfo.hVoiceSource = m_voice;
+	patchInfo.nSourceOutputIndex = 0;
+	patchInfo.nSourceOutputSubIndex = SCE_NGS_VOICE_PATCH_AUTO_SUBINDEX;
+	patchInfo.hVoiceDestination = hMaster;
+	patchInfo.nTargetInputIndex = 0;
+
+	ret = sceNgsPatchCreateRouting(&patchInfo, &m_patch);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	ret = sceNgsPatchGetInfo(m_patch, &patchRouteInfo, NULL);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	m_outputChannels = patchRouteInfo.nOutputChannels;
+
+	return AL_NO_ERROR;
+}
+
+ALvoid VoiceNGS::detach()
+{
+	// Writes still queued for this voice would otherwise land on whoever gets the handle next
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+	m_pending = 0;
+	m_backend->dequeueVoice(this);
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	sceNgsVoiceKill(m_voice);
+	sceNgsVoiceSetModuleCallback(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL);
+	sceNgsPatchRemoveRouting(m_patch);
+
+	m_callback = NULL;
+	m_userData = NULL;
+	m_patch = AL_INVALID_NGS_HANDLE;
+	m_voice = AL_INVALID_NGS_HANDLE;
+}
+
+ALvoid VoiceNGS::markPending(ALint flags)
+{
+	m_pending |= flags;
+	m_backend->queueVoice(this);
+}
+
+ALint VoiceNGS::flush(LockSite site)
+{
+	SceInt32 ret = SCE_NGS_OK;
+	SceNgsBufferInfo bufferInfo;
+	SceNgsPlayerParams *pNgsPlayer;
+	SceNgsFilterParams *pFilterParams;
+
+	// Called with m_lock held. The render thread uses a try lock and requeues, API threads wait
+	if (m_pending & NGS_PENDING_PLAYER)
+	{
+		ret = (site == LockSite_Drain) ?
+			_alTryLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo, site) :
+			_alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_PLAYER_PARAMS_STRUCT_ID, &bufferInfo, site);
+		if (ret != SCE_NGS_OK)
+		{
+			return _alErrorNgs2Al(ret);
+		}
+
+		pNgsPlayer = (SceNgsPlayerParams *)bufferInfo.data;
+
+		for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
+		{
+			pNgsPlayer->buffs[i].pBuffer = m_player.buffs[i].pBuffer;
+			pNgsPlayer->buffs[i].nNumBytes = m_player.buffs[i].nNumBytes;
+			pNgsPlayer->buffs[i].nLoopCount = (m_player.buffs[i].nLoopCount == AL_PLAYER_LOOP_CONTINUOUS) ? SCE_NGS_PLAYER_LOOP_CONTINUOUS : m_player.buffs[i].nLoopCount;
+			pNgsPlayer->buffs[i].nNextBuff = (m_player.buffs[i].nNextBuff == AL_PLAYER_NO_NEXT_BUFFER) ? SCE_NGS_PLAYER_NO_NEXT_BUFFER : m_player.buffs[i].nNextBuff;
+		}
+
+		pNgsPlayer->fPlaybackFrequency = m_player.fPlaybackFrequency;
+		pNgsPlayer->fPlaybackScalar = m_player.fPlaybackScalar;
+		pNgsPlayer->nChannels = (SceInt8)m_player.nChannels;
+		pNgsPlayer->nStartBuffer = m_player.nStartBuffer;
+		pNgsPlayer->nStartByte = m_player.nStartByte;
+
+		pNgsPlayer->nChannelMap[0] = SCE_NGS_PLAYER_LEFT_CHANNEL;
+		if (m_player.nChannels == 1)
+		{
+			pNgsPlayer->nChannelMap[1] = SCE_NGS_PLAYER_LEFT_CHANNEL;
+		}
+		else
+		{
+			pNgsPlayer->nChannelMap[1] = SCE_NGS_PLAYER_RIGHT_CHANNEL;
+		}
+
+		ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER);
+		if (ret != SCE_NGS_OK)
+		{
+			return _alErrorNgs2Al(ret);
+		}
+
+		m_pending &= ~NGS_PENDING_PLAYER;
+	}
+
+	if (m_pending & NGS_PENDING_FILTER)
+	{
+		ret = (site == LockSite_Drain) ?
+			_alTryLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER, SCE_NGS_FILTER_PARAMS_STRUCT_ID, &bufferInfo, site) :
+			_alLockNgsResource(m_voice, SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER, SCE_NGS_FILTER_PARAMS_STRUCT_ID, &bufferInfo, site);
+		if (ret != SCE_NGS_OK)
+		{
+			return _alErrorNgs2Al(ret);
+		}
+
+		pFilterParams = (SceNgsFilterParams *)bufferInfo.data;
+
+		for (uint32_t chan = 0; chan < bufferInfo.size / sizeof(SceNgsFilterParams); chan++)
+		{
+			pFilterParams->eFilterMode = SCE_NGS_FILTER_LOWPASS_ONEPOLE;
+			pFilterParams->fResonance = 1.0f;
+			pFilterParams->fFrequency = m_filterFrequency;
+
+			pFilterParams++;
+		}
+
+		ret = sceNgsVoiceUnlockParams(m_voice, SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER);
+		if (ret != SCE_NGS_OK)
+		{
+			return _alErrorNgs2Al(ret);
+		}
+
+		m_pending &= ~NGS_PENDING_FILTER;
+	}
+
+	if (m_pending & NGS_PENDING_VOLUMES)
+	{
+		ret = sceNgsVoicePatchSetVolumesMatrix(m_patch, &m_volumes);
+		if (ret != SCE_NGS_OK)
+		{
+			return _alErrorNgs2Al(ret);
+		}
+
+		m_pending &= ~NGS_PENDING_VOLUMES;
+	}
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::tryFlush()
+{
+	ALint ret = AL_NO_ERROR;
+
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		_alCounterLockDeferred(LockSite_Drain);
+		return AL_INVALID_OPERATION;
+	}
+
+	ret = flush(LockSite_Drain);
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	return ret;
+}
+
+ALint VoiceNGS::play()
+{
+	ALint ret = AL_NO_ERROR;
+
+	// Key-on reads the player params, so they cannot wait for the next granule
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+	ret = flush(LockSite_Api);
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	if (ret != AL_NO_ERROR)
+	{
+		return ret;
+	}
+
+	return _alErrorNgs2Al(sceNgsVoicePlay(m_voice));
+}
+
+ALint VoiceNGS::kill()
+{
+	return _alErrorNgs2Al(sceNgsVoiceKill(m_voice));
+}
+
+ALint VoiceNGS::pause()
+{
+	return _alErrorNgs2Al(sceNgsVoicePause(m_voice));
+}
+
+ALint VoiceNGS::resume()
+{
+	return _alErrorNgs2Al(sceNgsVoiceResume(m_voice));
+}
+
+ALint VoiceNGS::getState()
+{
+	SceNgsVoiceInfo info;
+
+	if (sceNgsVoiceGetInfo(m_voice, &info) != SCE_NGS_OK)
+	{
+		return AL_STOPPED;
+	}
+
+	return _alSourceStateNgs2Al(info.uVoiceState);
+}
+
+ALint VoiceNGS::getPlayerState(PlayerState *pState)
+{
+	SceInt32 ret = SCE_NGS_OK;
+	SceNgsPlayerStates state;
+
+	ret = sceNgsVoiceGetStateData(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, &state, sizeof(SceNgsPlayerStates));
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	pState->nBytesConsumedSinceKeyOn = state.nBytesConsumedSinceKeyOn;
+	pState->nSamplesGeneratedSinceKeyOn = state.nSamplesGeneratedSinceKeyOn;
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::lockPlayer(PlayerParams **ppParams, LockSite site)
+{
+	_alLockVoiceMutex(&m_lock, site);
+
+	*ppParams = &m_player;
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::tryLockPlayer(PlayerParams **ppParams, LockSite site)
+{
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		_alCounterLockDeferred(site);
+		return AL_INVALID_OPERATION;
+	}
+
+	_alCounterLock(site, 0, 0);
+
+	*ppParams = &m_player;
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::unlockPlayer()
+{
+	markPending(NGS_PENDING_PLAYER);
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::readPlayer(PlayerParams *pParams)
+{
+	_alLockVoiceMutex(&m_lock, LockSite_Getter);
+	*pParams = m_player;
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::setFilter(float32_t fFrequency)
+{
+	_alLockVoiceMutex(&m_lock, LockSite_Filter);
+
+	if (m_filterFrequency != fFrequency)
+	{
+		m_filterFrequency = fFrequency;
+		markPending(NGS_PENDING_FILTER);
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::setPatchVolumes(const float32_t volumeMatrix[2][2])
+{
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	m_volumes.m[0][0] = volumeMatrix[0][0];
+	m_volumes.m[0][1] = volumeMatrix[0][1];
+	m_volumes.m[1][0] = volumeMatrix[1][0];
+	m_volumes.m[1][1] = volumeMatrix[1][1];
+
+	markPending(NGS_PENDING_VOLUMES);
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceNGS::getOutputChannels()
+{
+	return m_outputChannels;
+}
+
+ALint VoiceNGS::setCallback(VoiceCallback callback, ALvoid *pUserData)
+{
+	m_callback = callback;
+	m_userData = pUserData;
+
+	if (callback == NULL)
+	{
+		return _alErrorNgs2Al(sceNgsVoiceSetModuleCallback(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, SCE_NGS_NO_CALLBACK, NULL));
+	}
+
+	return _alErrorNgs2Al(sceNgsVoiceSetModuleCallback(m_voice, SCE_NGS_SIMPLE_VOICE_PCM_PLAYER, moduleCallback, this));
+}
+
+BackendNGS::BackendNGS()
+	: m_granularity(0),
+	m_frequency(0),
+	m_voiceCount(0),
+	m_rackCount(0),
+	m_maxRacks(0),
+	m_rackVoices(NULL),
+	m_pendingVoices(NULL),
+	m_drainVoices(NULL),
+	m_pendingCount(0),
+	m_pendingLockCreated(AL_FALSE),
+	m_startLockCreated(AL_FALSE),
+	m_systemReady(0),
+	m_systemLocked(AL_FALSE),
+	m_system(AL_INVALID_NGS_HANDLE),
+	m_masterVoice(AL_INVALID_NGS_HANDLE),
+	m_sourceRacks(NULL),
+	m_masterRack(AL_INVALID_NGS_HANDLE),
+	m_sysMem(NULL),
+	m_sourceRackMem(NULL)
+{
+	m_masterRackMem.data = NULL;
+	m_masterRackMem.size = 0;
+}
+
+BackendNGS::~BackendNGS()
+{
+	stopSystem();
+
+	if (m_sourceRackMem)
+	{
+		for (int i = 0; i < m_rackCount; i++)
+		{
+			AL_FREE(m_sourceRackMem[i].data);
+		}
+		AL_FREE(m_sourceRackMem);
+	}
+	if (m_sourceRacks)
+		AL_FREE(m_sourceRacks);
+	if (m_rackVoices)
+	{
+		for (int i = 0; i < m_rackCount; i++)
+		{
+			for (int j = 0; j < std::min(NGS_RACK_VOICES, m_voiceCount - i * NGS_RACK_VOICES); j++)
+			{
+				m_rackVoices[i][j].release();
+			}
+
+			delete[] m_rackVoices[i];
+		}
+
+		AL_FREE(m_rackVoices);
+	}
+	if (m_pendingVoices)
+		AL_FREE(m_pendingVoices);
+	if (m_drainVoices)
+		AL_FREE(m_drainVoices);
+	if (m_pendingLockCreated)
+		sceKernelDeleteLwMutex(&m_pendingLock);
+	if (m_startLockCreated)
+		sceKernelDeleteLwMutex(&m_startLock);
+}
+
+ALint BackendNGS::init(ALint granularity, ALint frequency, ALint maxVoices)
+{
+	m_granularity = granularity;
+	m_frequency = frequency;
+	m_voiceCount = maxVoices;
+	m_maxRacks = (maxVoices + NGS_RACK_VOICES - 1) / NGS_RACK_VOICES;
+
+	m_pendingVoices = (VoiceNGS **)AL_MALLOC(sizeof(VoiceNGS *) * m_voiceCount);
+	m_drainVoices = (VoiceNGS **)AL_MALLOC(sizeof(VoiceNGS *) * m_voiceCount);
+	if (m_pendingVoices == NULL || m_drainVoices == NULL)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	if (sceKernelCreateLwMutex(&m_pendingLock, "OpenALHW::QueueMtx", 0, 0, NULL) != SCE_OK)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	m_pendingLockCreated = AL_TRUE;
+
+	if (sceKernelCreateLwMutex(&m_startLock, "OpenALHW::StartMtx", 0, 0, NULL) != SCE_OK)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	m_startLockCreated = AL_TRUE;
+
+	m_sourceRacks = (SceNgsHRack *)AL_MALLOC(sizeof(SceNgsHRack) * m_maxRacks);
+	m_sourceRackMem = (SceNgsBufferInfo *)AL_MALLOC(sizeof(SceNgsBufferInfo) * m_maxRacks);
+	m_rackVoices = (VoiceNGS **)AL_MALLOC(sizeof(VoiceNGS *) * m_maxRacks);
+	if (m_sourceRacks == NULL || m_sourceRackMem == NULL || m_rackVoices == NULL)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	// The NGS system itself is left to the first acquireVoice(), so creating a context stays cheap
+	return AL_NO_ERROR;
+}
+
+ALint BackendNGS::startSystem()
+{
+	SceInt32 ret = SCE_OK;
+	SceSize reqSize = 0;
+	SceNgsRackDescription masterRackDesc;
+	SceNgsSystemInitParams initParams;
+
+	sceKernelLockLwMutex(&m_startLock, 1, NULL);
+
+	if (sceAtomicLoad32AcqRel(&m_systemReady) != 0)
+	{
+		sceKernelUnlockLwMutex(&m_startLock, 1);
+		return AL_NO_ERROR;
+	}
+
+	// The system only reserves bookkeeping for the configured voice count, rack memory is paid as racks are added
+	initParams.nMaxRacks = m_maxRacks + 1;
+	initParams.nMaxVoices = m_voiceCount + 1;
+	initParams.nGranularity = m_granularity;
+	initParams.nSampleRate = m_frequency;
+	initParams.nMaxModules = 14;
+
+	masterRackDesc.nChannelsPerVoice = 2;
+	masterRackDesc.nVoices = 1;
+	masterRackDesc.pVoiceDefn = sceNgsVoiceDefGetMasterBuss();
+	masterRackDesc.nMaxPatchesPerInput = m_voiceCount;
+	masterRackDesc.nPatchesPerOutput = 0;
+
+	ret = sceNgsSystemGetRequiredMemorySize(&initParams, &reqSize);
+	if (ret == SCE_NGS_OK)
+	{
+		m_sysMem = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, reqSize);
+		ret = (m_sysMem == NULL) ? SCE_NGS_ERROR_INTERNAL_ALLOC : sceNgsSystemInit(m_sysMem, reqSize, &initParams, &m_system);
+	}
+
+	if (ret == SCE_NGS_OK)
+	{
+		ret = sceNgsRackGetRequiredMemorySize(m_system, &masterRackDesc, &m_masterRackMem.size);
+	}
+
+	if (ret == SCE_NGS_OK)
+	{
+		m_masterRackMem.data = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, m_masterRackMem.size);
+		if (m_masterRackMem.data == NULL)
+		{
+			ret = SCE_NGS_ERROR_INTERNAL_ALLOC;
+		}
+		else
+		{
+			memset(m_masterRackMem.data, 0, m_masterRackMem.size);
+			ret = sceNgsRackInit(m_system, &m_masterRackMem, &masterRackDesc, &m_masterRack);
+		}
+	}
+
+	if (ret == SCE_NGS_OK)
+	{
+		ret = sceNgsRackGetVoiceHandle(m_masterRack, 0, &m_masterVoice);
+	}
+
+	if (ret == SCE_NGS_OK)
+	{
+		ret = sceNgsVoicePlay(m_masterVoice);
+	}
+
+	if (ret != SCE_NGS_OK)
+	{
+		// Leave nothing half built behind, the next voice request starts over
+		stopSystem();
+		sceKernelUnlockLwMutex(&m_startLock, 1);
+		return _alErrorNgs2Al(ret);
+	}
+
+	sceAtomicStore32AcqRel(&m_systemReady, 1);
+
+	sceKernelUnlockLwMutex(&m_startLock, 1);
+
+	return AL_NO_ERROR;
+}
+
+ALvoid BackendNGS::stopSystem()
+{
+	if (m_system != AL_INVALID_NGS_HANDLE)
+	{
+		if (m_masterVoice != AL_INVALID_NGS_HANDLE)
+		{
+			sceNgsVoiceKeyOff(m_masterVoice);
+		}
+
+		sceNgsSystemRelease(m_system);
+	}
+
+	if (m_sysMem)
+		AL_FREE(m_sysMem);
+	if (m_masterRackMem.data)
+		AL_FREE(m_masterRackMem.data);
+
+	m_system = AL_INVALID_NGS_HANDLE;
+	m_masterRack = AL_INVALID_NGS_HANDLE;
+	m_masterVoice = AL_INVALID_NGS_HANDLE;
+	m_sysMem = NULL;
+	m_masterRackMem.data = NULL;
+	m_masterRackMem.size = 0;
+}
+
+ALint BackendNGS::prepareRack(ALint rack, SceNgsRackDescription *pDesc, SceNgsBufferInfo *pMem, VoiceNGS **ppVoices)
+{
+	SceInt32 ret = SCE_OK;
+	VoiceNGS *voices = NULL;
+
+	pDesc->nChannelsPerVoice = 2;
+	pDesc->nVoices = std::min(NGS_RACK_VOICES, m_voiceCount - rack * NGS_RACK_VOICES);
+	pDesc->pVoiceDefn = sceNgsVoiceDefGetSimpleVoice();
+	pDesc->nMaxPatchesPerInput = 0;
+	pDesc->nPatchesPerOutput = 1;
+
+	ret = sceNgsRackGetRequiredMemorySize(m_system, pDesc, &pMem->size);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	pMem->data = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, pMem->size);
+	if (pMem->data == NULL)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	memset(pMem->data, 0, pMem->size);
+
+	voices = new VoiceNGS[pDesc->nVoices];
+
+	for (int i = 0; i < pDesc->nVoices; i++)
+	{
+		ret = voices[i].init(this);
+		if (ret != AL_NO_ERROR)
+		{
+			discardRack(pMem, voices, i);
+			return ret;
+		}
+	}
+
+	*ppVoices = voices;
+
+	return AL_NO_ERROR;
+}
+
+ALvoid BackendNGS::discardRack(SceNgsBufferInfo *pMem, VoiceNGS *pVoices, ALint voices)
+{
+	for (int i = 0; i < voices; i++)
+	{
+		pVoices[i].release();
+	}
+
+	delete[] pVoices;
+
+	AL_FREE(pMem->data);
+	pMem->data = NULL;
+}
+
+ALint BackendNGS::addRack(const SceNgsRackDescription *pDesc, SceNgsBufferInfo *pMem, VoiceNGS *pVoices)
+{
+	SceInt32 ret = SCE_OK;
+
+	// Called with the system lock held, only the rack itself is set up here
+	ret = sceNgsRackInit(m_system, pMem, pDesc, &m_sourceRacks[m_rackCount]);
+	if (ret != SCE_NGS_OK)
+	{
+		return _alErrorNgs2Al(ret);
+	}
+
+	m_sourceRackMem[m_rackCount] = *pMem;
+	m_rackVoices[m_rackCount] = pVoices;
+	m_rackCount++;
+
+	return AL_NO_ERROR;
+}
+
+VoiceNGS *BackendNGS::getVoice(ALint idx)
+{
+	return &m_rackVoices[idx / NGS_RACK_VOICES][idx % NGS_RACK_VOICES];
+}
+
+ALint BackendNGS::findFreeVoice()
+{
+	for (int i = 0; i < std::min(m_rackCount * NGS_RACK_VOICES, m_voiceCount); i++)
+	{
+		if (getVoice(i)->m_used == AL_FALSE)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+Voice *BackendNGS::acquireVoice()
+{
+	SceNgsHVoice hVoice = AL_INVALID_NGS_HANDLE;
+	SceNgsRackDescription rackDesc;
+	SceNgsBufferInfo rackMem;
+	VoiceNGS *rackVoices = NULL;
+	Voice *voice = NULL;
+	ALint rack = -1;
+	ALint idx = -1;
+
+	if (startSystem() != AL_NO_ERROR)
+	{
+		return NULL;
+	}
+
+	sceNgsSystemLock(m_system);
+
+	idx = findFreeVoice();
+
+	// Every allocated voice is taken, grow the pool by one rack if the ceiling allows
+	while (idx == -1 && rackVoices == NULL && m_rackCount < m_maxRacks)
+	{
+		// Memory and voice slots are set up unlocked so the render thread is not held up behind them
+		rack = m_rackCount;
+		sceNgsSystemUnlock(m_system);
+
+		if (prepareRack(rack, &rackDesc, &rackMem, &rackVoices) != AL_NO_ERROR)
+		{
+			return NULL;
+		}
+
+		sceNgsSystemLock(m_system);
+
+		// Another thread may have grown the pool meanwhile, then its rack is searched instead
+		if (rack == m_rackCount && addRack(&rackDesc, &rackMem, rackVoices) == AL_NO_ERROR)
+		{
+			rackVoices = NULL;
+		}
+
+		idx = findFreeVoice();
+	}
+
+	if (idx != -1 &&
+		sceNgsRackGetVoiceHandle(m_sourceRacks[idx / NGS_RACK_VOICES], idx % NGS_RACK_VOICES, &hVoice) == SCE_NGS_OK &&
+		getVoice(idx)->attach(hVoice, m_masterVoice) == AL_NO_ERROR)
+	{
+		getVoice(idx)->m_used = AL_TRUE;
+		voice = getVoice(idx);
+	}
+
+	sceNgsSystemUnlock(m_system);
+
+	// A rack that lost the race or failed to init is not needed
+	if (rackVoices != NULL)
+	{
+		discardRack(&rackMem, rackVoices, rackDesc.nVoices);
+	}
+
+	return voice;
+}
+
+ALvoid BackendNGS::releaseVoice(Voice *pVoice)
+{
+	VoiceNGS *voice = (VoiceNGS *)pVoice;
+
+	sceNgsSystemLock(m_system);
+	voice->detach();
+	voice->m_used = AL_FALSE;
+	sceNgsSystemUnlock(m_system);
+}
+
+ALvoid BackendNGS::queueVoice(VoiceNGS *pVoice)
+{
+	sceKernelLockLwMutex(&m_pendingLock, 1, NULL);
+
+	if (pVoice->m_queued == AL_FALSE)
+	{
+		pVoice->m_queued = AL_TRUE;
+		m_pendingVoices[m_pendingCount++] = pVoice;
+	}
+
+	sceKernelUnlockLwMutex(&m_pendingLock, 1);
+}
+
+ALvoid BackendNGS::dequeueVoice(VoiceNGS *pVoice)
+{
+	sceKernelLockLwMutex(&m_pendingLock, 1, NULL);
+
+	if (pVoice->m_queued == AL_TRUE)
+	{
+		for (int i = 0; i < m_pendingCount; i++)
+		{
+			if (m_pendingVoices[i] == pVoice)
+			{
+				m_pendingVoices[i] = m_pendingVoices[--m_pendingCount];
+				break;
+			}
+		}
+
+		pVoice->m_queued = AL_FALSE;
+	}
+
+	sceKernelUnlockLwMutex(&m_pendingLock, 1);
+}
+
+ALvoid BackendNGS::drainVoices()
+{
+	ALint count = 0;
+
+	// Take the whole list at once so API threads can keep queueing while it is written out
+	sceKernelLockLwMutex(&m_pendingLock, 1, NULL);
+
+	count = m_pendingCount;
+	for (int i = 0; i < count; i++)
+	{
+		m_drainVoices[i] = m_pendingVoices[i];
+		m_drainVoices[i]->m_queued = AL_FALSE;
+	}
+	m_pendingCount = 0;
+
+	sceKernelUnlockLwMutex(&m_pendingLock, 1);
+
+	for (int i = 0; i < count; i++)
+	{
+		VoiceNGS *voice = m_drainVoices[i];
+
+		// A voice still being written goes back on the list, it is picked up next granule
+		if (voice->tryFlush() != AL_NO_ERROR)
+		{
+			queueVoice(voice);
+		}
+	}
+}
+
+ALvoid BackendNGS::render(int16_t *pOut)
+{
+	SceUInt64 startTime = 0;
+	SceUInt32 elapsed = 0;
+
+	if (sceAtomicLoad32AcqRel(&m_systemReady) == 0)
+	{
+		memset(pOut, 0, sizeof(int16_t) * m_granularity * 2);
+		return;
+	}
+
+	// Params are only touched here, between two updates, so the writes never contend with the mixer
+	drainVoices();
+
+	startTime = sceKernelGetProcessTimeWide();
+
+	sceNgsSystemUpdate(m_system);
+
+	elapsed = (SceUInt32)(sceKernelGetProcessTimeWide() - startTime);
+
+	_alCounterAdd(Counter_SystemUpdateCount, 1);
+	_alCounterAdd(Counter_SystemUpdateTime, elapsed);
+	_alCounterMax(Counter_SystemUpdateTimeMax, elapsed);
+
+	sceNgsVoiceGetStateData(m_masterVoice, SCE_NGS_MASTER_BUSS_OUTPUT_MODULE,
+		pOut, sizeof(int16_t) * m_granularity * 2);
+}
+
+ALint BackendNGS::lock()
+{
+	SceInt32 ret = SCE_NGS_OK;
+
+	// No voice exists before the system is up, so there is nothing to hold still
+	if (sceAtomicLoad32AcqRel(&m_systemReady) == 0)
+	{
+		return AL_NO_ERROR;
+	}
+
+	ret = sceNgsSystemLock(m_system);
+	if (ret == SCE_NGS_OK)
+	{
+		m_systemLocked = AL_TRUE;
+	}
+
+	return _alErrorNgs2Al(ret);
+}
+
+ALint BackendNGS::unlock()
+{
+	// The system may have come up in between, only undo a lock that was actually taken
+	if (m_systemLocked == AL_FALSE)
+	{
+		return AL_NO_ERROR;
+	}
+
+	m_systemLocked = AL_FALSE;
+
+	return _alErrorNgs2Al(sceNgsSystemUnlock(m_system));
+}
+
+ALint BackendNGS::getRackCount()
+{
+	return m_rackCount;
+}
+
+ALint BackendNGS::getVoiceCapacity()
+{
+	return std::min(m_rackCount * NGS_RACK_VOICES, m_voiceCount);
+}
+
+ALboolean BackendNGS::ownsVoice(Voice *pVoice)
+{
+	for (int i = 0; i < m_rackCount; i++)
+	{
+		if (pVoice >= m_rackVoices[i] && pVoice < m_rackVoices[i] + NGS_RACK_VOICES)
+		{
+			return AL_TRUE;
+		}
+	}
+
+	return AL_FALSE;
+}
@@ -0,0 +1,132 @@
+#ifndef AL_BACKEND_NGS_H
+#define AL_BACKEND_NGS_H
+
+#include <kernel.h>
+#include <ngs.h>
+
+#include "common.h"
+#include "backend.h"
+
+namespace al {
+
+	class BackendNGS;
+
+	class VoiceNGS : public Voice
+	{
+	public:
+
+		VoiceNGS();
+		~VoiceNGS();
+
+		ALint play();
+		ALint kill();
+		ALint pause();
+		ALint resume();
+		ALint getState();
+		ALint getPlayerState(PlayerState *pState);
+		ALint lockPlayer(PlayerParams **ppParams, LockSite site);
+		ALint tryLockPlayer(PlayerParams **ppParams, LockSite site);
+		ALint unlockPlayer();
+		ALint readPlayer(PlayerParams *pParams);
+		ALint setFilter(float32_t fFrequency);
+		ALint setPatchVolumes(const float32_t volumeMatrix[2][2]);
+		ALint getOutputChannels();
+		ALint setCallback(VoiceCallback callback, ALvoid *pUserData);
+
+		ALint init(BackendNGS *pBackend);
+		ALvoid release();
+		ALint attach(SceNgsHVoice hVoice, SceNgsHVoice hMaster);
+		ALvoid detach();
+		ALint tryFlush();
+
+		ALboolean m_used;
+
+		// Guarded by the backend's queue lock, set while the voice sits in its pending list
+		ALboolean m_queued;
+
+	private:
+
+		#define NGS_PENDING_PLAYER		(0x1)
+		#define NGS_PENDING_FILTER		(0x2)
+		#define NGS_PENDING_VOLUMES		(0x4)
+
+		static ALvoid moduleCallback(const SceNgsCallbackInfo *pCallbackInfo);
+
+		ALvoid markPending(ALint flags);
+		ALvoid resetShadow();
+		ALint flush(LockSite site);
+
+		// Shadow params are the authority, NGS only sees them when the render thread drains the queue
+		SceKernelLwMutexWork m_lock;
+		BackendNGS *m_backend;
+		SceNgsHVoice m_voice;
+		SceNgsHPatch m_patch;
+		ALint m_outputChannels;
+		PlayerParams m_player;
+		float32_t m_filterFrequency;
+		SceNgsVolumeMatrix m_volumes;
+		ALint m_pending;
+		VoiceCallback m_callback;
+		ALvoid *m_userData;
+	};
+
+	class BackendNGS : public Backend
+	{
+	public:
+
+		BackendNGS();
+		~BackendNGS();
+
+		ALint init(ALint granularity, ALint frequency, ALint maxVoices);
+		Voice *acquireVoice();
+		ALvoid releaseVoice(Voice *pVoice);
+		ALvoid render(int16_t *pOut);
+		ALint lock();
+		ALint unlock();
+		ALboolean ownsVoice(Voice *pVoice);
+		ALint getRackCount();
+		ALint getVoiceCapacity();
+
+		// Voices with param writes waiting for the next granule, each listed at most once
+		ALvoid queueVoice(VoiceNGS *pVoice);
+		ALvoid dequeueVoice(VoiceNGS *pVoice);
+
+	private:
+
+		ALint startSystem();
+		ALvoid stopSystem();
+		ALint prepareRack(ALint rack, SceNgsRackDescription *pDesc, SceNgsBufferInfo *pMem, VoiceNGS **ppVoices);
+		ALvoid discardRack(SceNgsBufferInfo *pMem, VoiceNGS *pVoices, ALint voices);
+		ALint addRack(const SceNgsRackDescription *pDesc, SceNgsBufferInfo *pMem, VoiceNGS *pVoices);
+		ALint findFreeVoice();
+		VoiceNGS *getVoice(ALint idx);
+		ALvoid drainVoices();
+
+		ALint m_granularity;
+		ALint m_frequency;
+		ALint m_voiceCount;
+		ALint m_rackCount;
+		ALint m_maxRacks;
+		// Slots come with their rack, so an unused rack costs no voice locks either
+		VoiceNGS **m_rackVoices;
+		VoiceNGS **m_pendingVoices;
+		VoiceNGS **m_drainVoices;
+		ALint m_pendingCount;
+		SceKernelLwMutexWork m_pendingLock;
+		ALboolean m_pendingLockCreated;
+		// The system and master rack come up with the first voice, until then there is nothing to mix
+		SceKernelLwMutexWork m_startLock;
+		ALboolean m_startLockCreated;
+		volatile int32_t m_systemReady;
+		ALboolean m_systemLocked;
+		SceNgsHSynSystem m_system;
+		SceNgsHVoice m_masterVoice;
+		SceNgsHRack *m_sourceRacks;
+		SceNgsHRack m_masterRack;
+		ALvoid *m_sysMem;
+		SceNgsBufferInfo m_masterRackMem;
+		SceNgsBufferInfo *m_sourceRackMem;
+	};
+}
+
+#endif
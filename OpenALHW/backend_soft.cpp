@@ -0,0 +1,618 @@
+#include <string.h>
+#include <math.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AL_SOFT_NEON
+#endif
+
+#include "allocator.h"
+#include "backend.h"
+
+#define AL_SOFT_TWO_PI (6.28318530718f)
+
+using namespace al;
+
+// Same per-site statistics as the NGS voice, a contended lock counts as one retry
+static ALvoid _alSoftLockVoice(AlMutex *pMutex, LockSite site)
+{
+	uint64_t start = 0;
+
+	if (_alMutexTryLock(pMutex) == AL_TRUE)
+	{
+		_alCounterLock(site, 0, 0);
+		return;
+	}
+
+	start = _alTimeGet();
+	_alMutexLock(pMutex);
+	_alCounterLock(site, 1, (ALuint)(_alTimeGet() - start));
+}
+
+static ALvoid _alSoftMixMatrix(float32_t *pMix, const float32_t *pIn, const float32_t volumes[2][2], ALint frames)
+{
+	ALint i = 0;
+
+#ifdef AL_SOFT_NEON
+	for (; i + 4 <= frames; i += 4)
+	{
+		float32x4x2_t in = vld2q_f32(pIn + i * 2);
+		float32x4x2_t out = vld2q_f32(pMix + i * 2);
+
+		out.val[0] = vmlaq_n_f32(out.val[0], in.val[0], volumes[0][0]);
+		out.val[0] = vmlaq_n_f32(out.val[0], in.val[1], volumes[1][0]);
+		out.val[1] = vmlaq_n_f32(out.val[1], in.val[0], volumes[0][1]);
+		out.val[1] = vmlaq_n_f32(out.val[1], in.val[1], volumes[1][1]);
+
+		vst2q_f32(pMix + i * 2, out);
+	}
+#endif
+
+	for (; i < frames; i++)
+	{
+		float32_t l = pIn[i * 2];
+		float32_t r = pIn[i * 2 + 1];
+
+		pMix[i * 2] += volumes[0][0] * l + volumes[1][0] * r;
+		pMix[i * 2 + 1] += volumes[0][1] * l + volumes[1][1] * r;
+	}
+}
+
+static ALvoid _alSoftConvertS16(int16_t *pOut, const float32_t *pIn, ALint samples)
+{
+	ALint i = 0;
+
+#ifdef AL_SOFT_NEON
+	for (; i + 8 <= samples; i += 8)
+	{
+		int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pIn + i), 32767.0f));
+		int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pIn + i + 4), 32767.0f));
+
+		vst1q_s16(pOut + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+	}
+#endif
+
+	for (; i < samples; i++)
+	{
+		float32_t s = pIn[i] * 32767.0f;
+
+		if (s > 32767.0f)
+			s = 32767.0f;
+		else if (s < -32768.0f)
+			s = -32768.0f;
+
+		pOut[i] = (int16_t)s;
+	}
+}
+
+VoiceSoft::VoiceSoft()
+	: m_used(AL_FALSE),
+	m_state(AL_STOPPED),
+	m_frequency(0),
+	m_filterCoef(1.0f),
+	m_callback(NULL),
+	m_userData(NULL),
+	m_eventCount(0)
+{
+	memset(&m_player, 0, sizeof(PlayerParams));
+	memset(m_volumes, 0, sizeof(m_volumes));
+	reset();
+}
+
+VoiceSoft::~VoiceSoft()
+{
+
+}
+
+ALint VoiceSoft::init(ALint frequency)
+{
+	m_frequency = frequency;
+
+	if (_alMutexCreate(&m_lock, "OpenALHW::VoiceMtx") == AL_FALSE)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	return AL_NO_ERROR;
+}
+
+ALvoid VoiceSoft::release()
+{
+	_alMutexDelete(&m_lock);
+}
+
+ALvoid VoiceSoft::attach()
+{
+	_alMutexLock(&m_lock);
+
+	memset(&m_player, 0, sizeof(PlayerParams));
+	m_player.fPlaybackScalar = 1.0f;
+	m_player.nChannels = 1;
+
+	for (int i = 0; i < AL_PLAYER_MAX_BUFFERS; i++)
+	{
+		m_player.buffs[i].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+	}
+
+	memset(m_volumes, 0, sizeof(m_volumes));
+	m_filterCoef = 1.0f;
+	m_state = AL_STOPPED;
+	m_callback = NULL;
+	m_userData = NULL;
+	m_eventCount = 0;
+
+	reset();
+
+	_alMutexUnlock(&m_lock);
+}
+
+ALvoid VoiceSoft::reset()
+{
+	m_bufIdx = 0;
+	m_framePos = 0;
+	m_frac = 0.0f;
+	m_loopsLeft = 0;
+	m_bytesConsumed = 0;
+	m_samplesGenerated = 0;
+	m_filterState[0] = 0.0f;
+	m_filterState[1] = 0.0f;
+}
+
+ALvoid VoiceSoft::pushEvent(VoiceEvent event, ALint bufferIdx)
+{
+	// More buffers than the player holds cannot finish within one granule unless they are tiny, drop the excess
+	if (m_eventCount == AL_SOFT_MAX_EVENTS)
+	{
+		return;
+	}
+
+	m_events[m_eventCount] = event;
+	m_eventBuffers[m_eventCount] = bufferIdx;
+	m_eventCount++;
+}
+
+ALint VoiceSoft::generate(float32_t *pOut, ALint frames)
+{
+	float32_t step = m_player.fPlaybackFrequency * m_player.fPlaybackScalar / (float32_t)m_frequency;
+	ALint channels = (m_player.nChannels == 2) ? 2 : 1;
+	ALint i = 0;
+
+	for (; i < frames && m_state == AL_PLAYING; i++)
+	{
+		const PlayerBuffer *buf = &m_player.buffs[m_bufIdx];
+		ALint bufFrames = buf->nNumBytes / (ALint)(sizeof(int16_t) * channels);
+		const int16_t *pcm = (const int16_t *)buf->pBuffer;
+
+		if (pcm != NULL && bufFrames > 0)
+		{
+			ALint next = (m_framePos + 1 < bufFrames) ? m_framePos + 1 : m_framePos;
+			const int16_t *cur = pcm + m_framePos * channels;
+			const int16_t *nxt = pcm + next * channels;
+			float32_t l = ((float32_t)cur[0] + ((float32_t)nxt[0] - (float32_t)cur[0]) * m_frac) * (1.0f / 32768.0f);
+			float32_t r = l;
+
+			if (channels == 2)
+			{
+				r = ((float32_t)cur[1] + ((float32_t)nxt[1] - (float32_t)cur[1]) * m_frac) * (1.0f / 32768.0f);
+			}
+
+			pOut[i * 2] = l;
+			pOut[i * 2 + 1] = r;
+
+			m_frac += step;
+			ALint advance = (ALint)m_frac;
+			m_frac -= (float32_t)advance;
+			m_framePos += advance;
+			m_bytesConsumed += advance * (ALint)sizeof(int16_t) * channels;
+			m_samplesGenerated++;
+		}
+		else
+		{
+			pOut[i * 2] = 0.0f;
+			pOut[i * 2 + 1] = 0.0f;
+			bufFrames = 1;
+			m_framePos = 1;
+		}
+
+		while (m_framePos >= bufFrames && m_state == AL_PLAYING)
+		{
+			m_framePos -= bufFrames;
+
+			if (m_loopsLeft == AL_PLAYER_LOOP_CONTINUOUS)
+			{
+				continue;
+			}
+
+			if (m_loopsLeft > 0)
+			{
+				m_loopsLeft--;
+				continue;
+			}
+
+			ALint nextBuff = m_player.buffs[m_bufIdx].nNextBuff;
+			if (nextBuff == AL_PLAYER_NO_NEXT_BUFFER || nextBuff < 0 || nextBuff >= AL_PLAYER_MAX_BUFFERS)
+			{
+				pushEvent(VoiceEvent_EndOfData, m_bufIdx);
+				m_state = AL_STOPPED;
+				break;
+			}
+
+			pushEvent(VoiceEvent_SwappedBuffer, m_bufIdx);
+
+			m_bufIdx = nextBuff;
+			m_loopsLeft = m_player.buffs[m_bufIdx].nLoopCount;
+
+			bufFrames = m_player.buffs[m_bufIdx].nNumBytes / (ALint)(sizeof(int16_t) * channels);
+			if (bufFrames <= 0)
+			{
+				bufFrames = 1;
+			}
+		}
+	}
+
+	return i;
+}
+
+ALvoid VoiceSoft::mix(float32_t *pMix, float32_t *pScratch, ALint frames)
+{
+	_alMutexLock(&m_lock);
+
+	if (m_state != AL_PLAYING)
+	{
+		_alMutexUnlock(&m_lock);
+		return;
+	}
+
+	ALint generated = generate(pScratch, frames);
+
+	if (m_filterCoef < 1.0f)
+	{
+		float32_t l = m_filterState[0];
+		float32_t r = m_filterState[1];
+
+		for (ALint i = 0; i < generated; i++)
+		{
+			l += m_filterCoef * (pScratch[i * 2] - l);
+			r += m_filterCoef * (pScratch[i * 2 + 1] - r);
+			pScratch[i * 2] = l;
+			pScratch[i * 2 + 1] = r;
+		}
+
+		m_filterState[0] = l;
+		m_filterState[1] = r;
+	}
+
+	_alSoftMixMatrix(pMix, pScratch, m_volumes, generated);
+
+	_alMutexUnlock(&m_lock);
+}
+
+ALvoid VoiceSoft::dispatchEvents()
+{
+	// Called without the voice lock held so callbacks can relock the player
+	ALint count = m_eventCount;
+	VoiceCallback callback = m_callback;
+
+	m_eventCount = 0;
+
+	if (callback == NULL)
+	{
+		return;
+	}
+
+	for (ALint i = 0; i < count; i++)
+	{
+		callback(this, m_events[i], m_eventBuffers[i], m_userData);
+	}
+}
+
+ALint VoiceSoft::play()
+{
+	_alMutexLock(&m_lock);
+
+	reset();
+
+	m_bufIdx = m_player.nStartBuffer;
+	if (m_bufIdx < 0 || m_bufIdx >= AL_PLAYER_MAX_BUFFERS)
+	{
+		m_bufIdx = 0;
+	}
+
+	m_framePos = m_player.nStartByte / (ALint)(sizeof(int16_t) * ((m_player.nChannels == 2) ? 2 : 1));
+	m_loopsLeft = m_player.buffs[m_bufIdx].nLoopCount;
+	m_eventCount = 0;
+	m_state = AL_PLAYING;
+
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::kill()
+{
+	_alMutexLock(&m_lock);
+	m_state = AL_STOPPED;
+	m_eventCount = 0;
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::pause()
+{
+	_alMutexLock(&m_lock);
+	if (m_state == AL_PLAYING)
+	{
+		m_state = AL_PAUSED;
+	}
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::resume()
+{
+	_alMutexLock(&m_lock);
+	if (m_state == AL_PAUSED)
+	{
+		m_state = AL_PLAYING;
+	}
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::getState()
+{
+	return m_state;
+}
+
+ALint VoiceSoft::getPlayerState(PlayerState *pState)
+{
+	_alMutexLock(&m_lock);
+	pState->nBytesConsumedSinceKeyOn = m_bytesConsumed;
+	pState->nSamplesGeneratedSinceKeyOn = m_samplesGenerated;
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::lockPlayer(PlayerParams **ppParams, LockSite site)
+{
+	_alSoftLockVoice(&m_lock, site);
+
+	*ppParams = &m_player;
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::tryLockPlayer(PlayerParams **ppParams, LockSite site)
+{
+	if (_alMutexTryLock(&m_lock) == AL_FALSE)
+	{
+		_alCounterLockDeferred(site);
+		return AL_INVALID_OPERATION;
+	}
+
+	_alCounterLock(site, 0, 0);
+
+	*ppParams = &m_player;
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::unlockPlayer()
+{
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::readPlayer(PlayerParams *pParams)
+{
+	// The mixer only holds the lock for a granule, there is no NGS param lock to defer on
+	_alSoftLockVoice(&m_lock, LockSite_Getter);
+	*pParams = m_player;
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::setFilter(float32_t fFrequency)
+{
+	float32_t coef = 1.0f;
+
+	if (fFrequency < (float32_t)m_frequency * 0.5f)
+	{
+		coef = 1.0f - expf(-AL_SOFT_TWO_PI * fFrequency / (float32_t)m_frequency);
+	}
+
+	_alSoftLockVoice(&m_lock, LockSite_Filter);
+	m_filterCoef = coef;
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::setPatchVolumes(const float32_t volumeMatrix[2][2])
+{
+	_alMutexLock(&m_lock);
+	m_volumes[0][0] = volumeMatrix[0][0];
+	m_volumes[0][1] = volumeMatrix[0][1];
+	m_volumes[1][0] = volumeMatrix[1][0];
+	m_volumes[1][1] = volumeMatrix[1][1];
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint VoiceSoft::getOutputChannels()
+{
+	return 2;
+}
+
+ALint VoiceSoft::setCallback(VoiceCallback callback, ALvoid *pUserData)
+{
+	_alMutexLock(&m_lock);
+	m_callback = callback;
+	m_userData = pUserData;
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+BackendSoft::BackendSoft()
+	: m_granularity(0),
+	m_voiceCount(0),
+	m_voices(NULL),
+	m_mix(NULL),
+	m_scratch(NULL),
+	m_lockCreated(AL_FALSE)
+{
+
+}
+
+BackendSoft::~BackendSoft()
+{
+	if (m_voices)
+	{
+		for (int i = 0; i < m_voiceCount; i++)
+		{
+			m_voices[i].release();
+		}
+
+		delete[] m_voices;
+	}
+
+	if (m_mix)
+		AL_FREE(m_mix);
+	if (m_scratch)
+		AL_FREE(m_scratch);
+	if (m_lockCreated)
+		_alMutexDelete(&m_lock);
+}
+
+ALint BackendSoft::init(ALint granularity, ALint frequency, ALint maxVoices)
+{
+	ALint ret = AL_NO_ERROR;
+
+	m_granularity = granularity;
+
+	m_mix = (float32_t *)AL_MALLOC(sizeof(float32_t) * granularity * 2);
+	m_scratch = (float32_t *)AL_MALLOC(sizeof(float32_t) * granularity * 2);
+	if (m_mix == NULL || m_scratch == NULL)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	if (_alMutexCreate(&m_lock, "OpenALHW::MixMtx") == AL_FALSE)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	m_lockCreated = AL_TRUE;
+
+	m_voices = new VoiceSoft[maxVoices];
+
+	for (int i = 0; i < maxVoices; i++)
+	{
+		ret = m_voices[i].init(frequency);
+		if (ret != AL_NO_ERROR)
+		{
+			return ret;
+		}
+
+		m_voiceCount++;
+	}
+
+	return AL_NO_ERROR;
+}
+
+Voice *BackendSoft::acquireVoice()
+{
+	Voice *voice = NULL;
+
+	_alMutexLock(&m_lock);
+
+	for (int i = 0; i < m_voiceCount; i++)
+	{
+		if (m_voices[i].m_used == AL_FALSE)
+		{
+			m_voices[i].attach();
+			m_voices[i].m_used = AL_TRUE;
+			voice = &m_voices[i];
+			break;
+		}
+	}
+
+	_alMutexUnlock(&m_lock);
+
+	return voice;
+}
+
+ALvoid BackendSoft::releaseVoice(Voice *pVoice)
+{
+	VoiceSoft *voice = (VoiceSoft *)pVoice;
+
+	_alMutexLock(&m_lock);
+	voice->kill();
+	voice->setCallback(NULL, NULL);
+	voice->m_used = AL_FALSE;
+	_alMutexUnlock(&m_lock);
+}
+
+ALvoid BackendSoft::render(int16_t *pOut)
+{
+	_alMutexLock(&m_lock);
+
+	memset(m_mix, 0, sizeof(float32_t) * m_granularity * 2);
+
+	for (int i = 0; i < m_voiceCount; i++)
+	{
+		if (m_voices[i].m_used == AL_TRUE)
+		{
+			m_voices[i].mix(m_mix, m_scratch, m_granularity);
+		}
+	}
+
+	for (int i = 0; i < m_voiceCount; i++)
+	{
+		if (m_voices[i].m_used == AL_TRUE)
+		{
+			m_voices[i].dispatchEvents();
+		}
+	}
+
+	_alSoftConvertS16(pOut, m_mix, m_granularity * 2);
+
+	_alMutexUnlock(&m_lock);
+}
+
+ALint BackendSoft::lock()
+{
+	_alMutexLock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint BackendSoft::unlock()
+{
+	_alMutexUnlock(&m_lock);
+
+	return AL_NO_ERROR;
+}
+
+ALint BackendSoft::getRackCount()
+{
+	return 0;
+}
+
+ALint BackendSoft::getVoiceCapacity()
+{
+	return m_voiceCount;
+}
+
+ALboolean BackendSoft::ownsVoice(Voice *pVoice)
+{
+	return (pVoice >= m_voices && pVoice < m_voices + m_voiceCount) ? AL_TRUE : AL_FALSE;
+}
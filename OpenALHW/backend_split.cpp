@@ -0,0 +1,350 @@
+#include <string.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AL_SPLIT_NEON
+#endif
+
+#include "common.h"
+#include "backend.h"
+#include "backend_ngs.h"
+
+using namespace al;
+
+static ALvoid _alSplitAccumulate(int16_t *pOut, const int16_t *pIn, ALint samples)
+{
+	ALint i = 0;
+
+#ifdef AL_SPLIT_NEON
+	for (; i + 8 <= samples; i += 8)
+	{
+		vst1q_s16(pOut + i, vqaddq_s16(vld1q_s16(pOut + i), vld1q_s16(pIn + i)));
+	}
+#endif
+
+	for (; i < samples; i++)
+	{
+		int32_t s = (int32_t)pOut[i] + (int32_t)pIn[i];
+
+		if (s > 32767)
+			s = 32767;
+		else if (s < -32768)
+			s = -32768;
+
+		pOut[i] = (int16_t)s;
+	}
+}
+
+BackendSplit::BackendSplit(ALint systemCount, ALuint affinity, ALboolean software)
+	: m_granularity(0),
+	m_systemCount(systemCount),
+	m_affinity(affinity),
+	m_software(software),
+	m_workers(NULL),
+	m_doneSema(AL_INVALID_SEMA),
+	m_runningWorkers(0),
+	m_started(AL_FALSE),
+	m_active(AL_FALSE)
+{
+
+}
+
+BackendSplit::~BackendSplit()
+{
+	m_active = AL_FALSE;
+
+	if (m_workers == NULL)
+	{
+		return;
+	}
+
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		if (m_workers[i].thread != AL_INVALID_THREAD)
+		{
+			_alSemaSignal(m_workers[i].startSema, 1);
+			_alThreadJoin(m_workers[i].thread);
+		}
+	}
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		if (m_workers[i].startSema != AL_INVALID_SEMA)
+			_alSemaDelete(m_workers[i].startSema);
+		if (m_workers[i].pBuffer)
+			AL_FREE(m_workers[i].pBuffer);
+		if (m_workers[i].pBackend)
+			delete m_workers[i].pBackend;
+	}
+
+	if (m_doneSema != AL_INVALID_SEMA)
+		_alSemaDelete(m_doneSema);
+
+	delete[] m_workers;
+}
+
+ALvoid BackendSplit::workerThread(ALvoid *pArg)
+{
+	Worker *worker = (Worker *)pArg;
+	BackendSplit *owner = worker->pOwner;
+
+	while (true)
+	{
+		_alSemaWait(worker->startSema, 1);
+
+		if ((volatile ALboolean)owner->m_active == AL_FALSE)
+		{
+			break;
+		}
+
+		worker->pBackend->render(worker->pBuffer);
+
+		_alSemaSignal(owner->m_doneSema, 1);
+	}
+
+	_alTraceThreadExit();
+}
+
+ALint BackendSplit::init(ALint granularity, ALint frequency, ALint maxVoices)
+{
+	ALint ret = AL_NO_ERROR;
+	ALint perSystem = (maxVoices + m_systemCount - 1) / m_systemCount;
+
+	m_granularity = granularity;
+
+	m_workers = new Worker[m_systemCount];
+	memset(m_workers, 0, sizeof(Worker) * m_systemCount);
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		m_workers[i].pOwner = this;
+		m_workers[i].startSema = AL_INVALID_SEMA;
+		m_workers[i].thread = AL_INVALID_THREAD;
+
+		if (m_software == AL_TRUE)
+		{
+			m_workers[i].pBackend = new BackendSoft();
+		}
+		else
+		{
+			m_workers[i].pBackend = new BackendNGS();
+		}
+
+		ret = m_workers[i].pBackend->init(granularity, frequency, perSystem);
+		if (ret != AL_NO_ERROR)
+		{
+			return ret;
+		}
+
+		m_workers[i].pBuffer = (int16_t *)AL_MALLOC(granularity * 2 * sizeof(int16_t));
+		if (m_workers[i].pBuffer == NULL)
+		{
+			return AL_OUT_OF_MEMORY;
+		}
+	}
+
+	m_doneSema = _alSemaCreate("OpenALHW::SplitDone", 0, m_systemCount);
+	if (m_doneSema == AL_INVALID_SEMA)
+	{
+		return AL_INVALID_VALUE;
+	}
+
+	m_active = AL_TRUE;
+
+	return AL_NO_ERROR;
+}
+
+ALvoid BackendSplit::startWorkers()
+{
+	ALuint cores[AL_PLATFORM_USER_CORES];
+	ALint coreCount = 0;
+
+	// Keep the workers off the core the render thread runs on whenever there is one to spare
+	for (int i = 0; i < AL_PLATFORM_USER_CORES; i++)
+	{
+		if ((AL_PLATFORM_CORE_MASK(i) & m_affinity) == 0)
+		{
+			cores[coreCount++] = AL_PLATFORM_CORE_MASK(i);
+		}
+	}
+
+	if (coreCount == 0)
+	{
+		for (int i = 0; i < AL_PLATFORM_USER_CORES; i++)
+		{
+			cores[coreCount++] = AL_PLATFORM_CORE_MASK(i);
+		}
+	}
+
+	// System 0 is rendered by the calling thread, the rest get a worker each
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		m_workers[i].startSema = _alSemaCreate("OpenALHW::SplitStart", 0, 1);
+		if (m_workers[i].startSema == AL_INVALID_SEMA)
+		{
+			continue;
+		}
+
+		m_workers[i].thread = _alThreadStart("OpenALHW::NGSSplit", workerThread, &m_workers[i], cores[(i - 1) % coreCount]);
+		if (m_workers[i].thread == AL_INVALID_THREAD)
+		{
+			continue;
+		}
+
+		m_runningWorkers++;
+	}
+}
+
+Voice *BackendSplit::acquireVoice()
+{
+	Voice *voice = NULL;
+	ALint first = 0;
+
+	// Start with the least loaded system so DSP time stays balanced across cores
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		if (_alAtomicLoad32(&m_workers[i].activeVoices) < _alAtomicLoad32(&m_workers[first].activeVoices))
+		{
+			first = i;
+		}
+	}
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		Worker *worker = &m_workers[(first + i) % m_systemCount];
+
+		voice = worker->pBackend->acquireVoice();
+		if (voice != NULL)
+		{
+			_alAtomicAdd32(&worker->activeVoices, 1);
+			return voice;
+		}
+	}
+
+	return NULL;
+}
+
+ALvoid BackendSplit::releaseVoice(Voice *pVoice)
+{
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		if (m_workers[i].pBackend->ownsVoice(pVoice) == AL_TRUE)
+		{
+			m_workers[i].pBackend->releaseVoice(pVoice);
+			_alAtomicAdd32(&m_workers[i].activeVoices, -1);
+			return;
+		}
+	}
+}
+
+ALvoid BackendSplit::render(int16_t *pOut)
+{
+	// Workers are only spawned once the context actually renders something
+	if (m_started == AL_FALSE)
+	{
+		m_started = AL_TRUE;
+		startWorkers();
+	}
+
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		if (m_workers[i].thread != AL_INVALID_THREAD)
+		{
+			_alSemaSignal(m_workers[i].startSema, 1);
+		}
+	}
+
+	m_workers[0].pBackend->render(pOut);
+
+	// A system whose worker could not be started is rendered here instead
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		if (m_workers[i].thread == AL_INVALID_THREAD)
+		{
+			m_workers[i].pBackend->render(m_workers[i].pBuffer);
+		}
+	}
+
+	if (m_runningWorkers > 0)
+	{
+		_alSemaWait(m_doneSema, m_runningWorkers);
+	}
+
+	for (int i = 1; i < m_systemCount; i++)
+	{
+		_alSplitAccumulate(pOut, m_workers[i].pBuffer, m_granularity * 2);
+	}
+}
+
+ALint BackendSplit::lock()
+{
+	ALint ret = AL_NO_ERROR;
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		ret = m_workers[i].pBackend->lock();
+		if (ret != AL_NO_ERROR)
+		{
+			while (--i >= 0)
+			{
+				m_workers[i].pBackend->unlock();
+			}
+
+			return ret;
+		}
+	}
+
+	return AL_NO_ERROR;
+}
+
+ALint BackendSplit::unlock()
+{
+	ALint ret = AL_NO_ERROR;
+
+	for (int i = m_systemCount - 1; i >= 0; i--)
+	{
+		if (m_workers[i].pBackend->unlock() != AL_NO_ERROR)
+		{
+			ret = AL_INVALID_OPERATION;
+		}
+	}
+
+	return ret;
+}
+
+ALint BackendSplit::getRackCount()
+{
+	ALint count = 0;
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		count += m_workers[i].pBackend->getRackCount();
+	}
+
+	return count;
+}
+
+ALint BackendSplit::getVoiceCapacity()
+{
+	ALint count = 0;
+
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		count += m_workers[i].pBackend->getVoiceCapacity();
+	}
+
+	return count;
+}
+
+ALboolean BackendSplit::ownsVoice(Voice *pVoice)
+{
+	for (int i = 0; i < m_systemCount; i++)
+	{
+		if (m_workers[i].pBackend->ownsVoice(pVoice) == AL_TRUE)
+		{
+			return AL_TRUE;
+		}
+	}
+
+	return AL_FALSE;
+}
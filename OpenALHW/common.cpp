@@ -6,11 +6,8 @@
 #include "common.h"
 
 int32_t g_lastError = AL_NO_ERROR;
-AlMemoryAllocNGS g_alloc = malloc;
-AlMemoryAllocAlignNGS g_memalign = memalign;
-AlMemoryFreeNGS g_free = free;
 
-ALint *s_namedObjects = NULL;
+intptr_t *s_namedObjects = NULL;
 
 #define DECL(x) { #x, reinterpret_cast<void*>(x) }
 const struct {
@@ -114,9 +111,22 @@ const struct {
 
 	DECL(alDeferUpdatesSOFT),
 	DECL(alProcessUpdatesSOFT),
+	DECL(alcLoopbackOpenDeviceSOFT),
+	DECL(alcIsRenderFormatSupportedSOFT),
+	DECL(alcRenderSamplesSOFT),
+	DECL(alcDevicePauseSOFT),
+	DECL(alcDeviceResumeSOFT),
+	DECL(alcResetDeviceSOFT),
 
 	DECL(alcSetThreadAffinityNGS),
 	DECL(alcSetMemoryFunctionsNGS),
+	DECL(alcCaptureResamplerNGS),
+	DECL(alSourceCaptureNGS),
+	DECL(alTraceDumpNGS),
+	DECL(alRecordStartNGS),
+	DECL(alRecordStopNGS),
+	DECL(alGetInteger64vNGS),
+	DECL(alGetSourcesivNGS),
 };
 #undef DECL
 
@@ -198,6 +208,8 @@ constexpr struct {
 	DECL(AL_FORMAT_MONO16),
 	DECL(AL_FORMAT_STEREO8),
 	DECL(AL_FORMAT_STEREO16),
+	DECL(AL_FORMAT_MONO_FLOAT32),
+	DECL(AL_FORMAT_STEREO_FLOAT32),
 
 	DECL(AL_FREQUENCY),
 	DECL(AL_BITS),
@@ -233,6 +245,64 @@ constexpr struct {
 	DECL(AL_EXPONENT_DISTANCE_CLAMPED),
 
 	DECL(AL_DEFERRED_UPDATES_SOFT),
+
+	DECL(ALC_FORMAT_CHANNELS_SOFT),
+	DECL(ALC_FORMAT_TYPE_SOFT),
+	DECL(ALC_BYTE_SOFT),
+	DECL(ALC_UNSIGNED_BYTE_SOFT),
+	DECL(ALC_SHORT_SOFT),
+	DECL(ALC_UNSIGNED_SHORT_SOFT),
+	DECL(ALC_INT_SOFT),
+	DECL(ALC_UNSIGNED_INT_SOFT),
+	DECL(ALC_FLOAT_SOFT),
+	DECL(ALC_MONO_SOFT),
+	DECL(ALC_STEREO_SOFT),
+	DECL(ALC_QUAD_SOFT),
+	DECL(ALC_5POINT1_SOFT),
+	DECL(ALC_6POINT1_SOFT),
+	DECL(ALC_7POINT1_SOFT),
+
+	DECL(AL_POSITION_EXTRAPOLATION_NGS),
+	DECL(AL_VELOCITY_FROM_POSITION_NGS),
+	DECL(AL_TRACE_NGS),
+	DECL(AL_TICK_COUNT_NGS),
+	DECL(AL_TICK_TIME_MIN_NGS),
+	DECL(AL_TICK_TIME_AVG_NGS),
+	DECL(AL_TICK_TIME_MAX_NGS),
+	DECL(AL_TICK_SOURCES_AVG_NGS),
+	DECL(AL_SYSTEM_UPDATE_TIME_AVG_NGS),
+	DECL(AL_SYSTEM_UPDATE_TIME_MAX_NGS),
+	DECL(AL_OUTPUT_BLOCK_TIME_NGS),
+	DECL(AL_UNDERRUN_COUNT_NGS),
+	DECL(AL_LOCK_RETRIES_NGS),
+	DECL(AL_ACTIVE_VOICES_NGS),
+	DECL(AL_VOICE_ALLOC_FAILURES_NGS),
+	DECL(AL_BUFFER_BYTES_NGS),
+	DECL(AL_LOCK_STATS_API_NGS),
+	DECL(AL_LOCK_STATS_CALLBACK_NGS),
+	DECL(AL_LOCK_STATS_UPDATE_NGS),
+	DECL(AL_LOCK_STATS_RAMP_NGS),
+	DECL(AL_LOCK_STATS_FILTER_NGS),
+	DECL(AL_LOCK_STATS_GETTER_NGS),
+	DECL(AL_LOCK_STATS_DRAIN_NGS),
+	DECL(ALC_GRANULARITY_NGS),
+	DECL(ALC_OUTPUT_BUFFERS_NGS),
+	DECL(ALC_OUTPUT_LATENCY_NGS),
+	DECL(ALC_UNDERRUN_COUNT_NGS),
+	DECL(ALC_MAX_RENDER_TIME_NGS),
+	DECL(ALC_MAX_OUTPUT_BLOCK_TIME_NGS),
+	DECL(ALC_IDLE_TIME_NGS),
+	DECL(ALC_NULL_PACED_NGS),
+	DECL(ALC_GRANULES_PER_SECOND_NGS),
+	DECL(ALC_SOFTWARE_MIXER_NGS),
+	DECL(ALC_RENDER_SYSTEMS_NGS),
+	DECL(ALC_RACK_COUNT_NGS),
+	DECL(ALC_VOICE_CAPACITY_NGS),
+	DECL(ALC_FIRST_SAMPLE_LATENCY_NGS),
+	DECL(ALC_RESAMPLER_POINT_NGS),
+	DECL(ALC_RESAMPLER_LINEAR_NGS),
+	DECL(ALC_RESAMPLER_CUBIC_NGS),
+	DECL(ALC_CAPTURE_CONVERSION_COST_NGS),
 };
 #undef DECL
 
@@ -327,21 +397,21 @@ ALint _alSourceStateNgs2Al(SceUInt32 state)
 	return AL_STOPPED;
 }
 
-ALint _alNamedObjectGet(ALint id)
+intptr_t _alNamedObjectGet(ALint id)
 {
 	if (s_namedObjects == NULL) {
-		s_namedObjects = (ALint *)AL_MALLOC(AL_NAMED_OBJECT_MAX * 4);
-		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * 4);
+		s_namedObjects = (intptr_t *)AL_MALLOC(AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
+		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
 	}
 
 	return s_namedObjects[id];
 }
 
-ALint _alNamedObjectGetName(ALint obj)
+ALint _alNamedObjectGetName(intptr_t obj)
 {
 	if (s_namedObjects == NULL) {
-		s_namedObjects = (ALint *)AL_MALLOC(AL_NAMED_OBJECT_MAX * 4);
-		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * 4);
+		s_namedObjects = (intptr_t *)AL_MALLOC(AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
+		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
 	}
 
 	for (int i = 1; i < AL_NAMED_OBJECT_MAX; i++) {
@@ -356,20 +426,20 @@ ALint _alNamedObjectGetName(ALint obj)
 ALvoid _alNamedObjectRemove(ALint id)
 {
 	if (s_namedObjects == NULL) {
-		s_namedObjects = (ALint *)AL_MALLOC(AL_NAMED_OBJECT_MAX * 4);
-		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * 4);
+		s_namedObjects = (intptr_t *)AL_MALLOC(AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
+		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
 	}
 
 	s_namedObjects[id] = 0;
 }
 
-ALint _alNamedObjectAdd(ALint obj)
+ALint _alNamedObjectAdd(intptr_t obj)
 {
 	ALint ret = -1;
 
 	if (s_namedObjects == NULL) {
-		s_namedObjects = (ALint *)AL_MALLOC(AL_NAMED_OBJECT_MAX * 4);
-		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * 4);
+		s_namedObjects = (intptr_t *)AL_MALLOC(AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
+		memset(s_namedObjects, 0, AL_NAMED_OBJECT_MAX * sizeof(intptr_t));
 	}
 
 	for (int i = 1; i < AL_NAMED_OBJECT_MAX; i++) {
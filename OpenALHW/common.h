@@ -6,26 +6,28 @@
 #include "AL/al.h"
 #include "AL/alc.h"
 #include "AL/alext.h"
+#include "trace.h"
+#include "counters.h"
+#include "allocator.h"
 
 #ifndef AL_COMMON_H
 #define AL_COMMON_H
 
 // Located in common.cpp
 extern int32_t g_lastError;
-extern AlMemoryAllocNGS g_alloc;
-extern AlMemoryAllocAlignNGS g_memalign;
-extern AlMemoryFreeNGS g_free;
 
 #define AL_INTERNAL_MAGIC (0xBC24DB7E)
 
 #define AL_NAMED_OBJECT_MAX (65536)
 
-#define AL_MALLOC(x)		g_alloc(x)
-#define AL_MEMALIGN(x, y)	g_memalign(x, y)
-#define AL_FREE(x)			g_free(x)
+#define AL_MAX_CAPTURE_FREQUENCY (192000)
+
+// Ring slices a monitoring source needs, four in its player plus headroom for the capture thread
+#define AL_CAPTURE_MONITOR_SLICES (8)
 
 #define AL_DEVICE_NAME "SceNgs"
 #define AL_CAPTURE_DEVICE_NAME "SceAudioIn"
+#define AL_NULL_DEVICE_NAME "Null"
 
 #define AL_VERSION_STRING "1.1 SCE " AL_DEVICE_NAME "/" AL_CAPTURE_DEVICE_NAME
 #define AL_RENDERER_STRING "SCE " AL_DEVICE_NAME
@@ -35,11 +37,9 @@ extern AlMemoryFreeNGS g_free;
 #define AL_INTERNAL_MINOR_VERSION (1)
 
 #define AL_SET_ERROR(x) { g_lastError = x; SCE_DBG_LOG_ERROR("AL_SET_ERROR: 0x%X\n", g_lastError); }
-#if ((SCE_DBG_MINIMUM_LOG_LEVEL == SCE_DBG_LOG_LEVEL_TRACE) && SCE_DBG_LOGGING_ENABLED)
-#define AL_TRACE_CALL { sceClibPrintf("AL_TRACE_CALL:  %s\n", __FUNCTION__); }
-#else
-#define AL_TRACE_CALL
-#endif
+// Recorded into the calling thread's trace ring while AL_TRACE_NGS is enabled, see trace.h
+#define AL_TRACE_CALL_ARGS(object, arg) al::TraceScope _alTraceScope(__FUNCTION__, (ALuint)(object), (ALint)(arg));
+#define AL_TRACE_CALL AL_TRACE_CALL_ARGS(0, 0)
 #define AL_WARNING SCE_DBG_LOG_WARNING
 
 #define AL_INVALID_NGS_HANDLE (0x0)
@@ -49,23 +49,59 @@ ALvoid *_alGetProcAddress(const ALchar *funcName);
 ALint _alGetError();
 ALCenum _alGetEnumValue(const ALCchar *enumname);
 ALint _alSourceStateNgs2Al(SceUInt32 state);
-ALint _alNamedObjectGet(ALint id);
+intptr_t _alNamedObjectGet(ALint id);
 ALvoid _alNamedObjectRemove(ALint id);
-ALint _alNamedObjectAdd(ALint obj);
-ALint _alNamedObjectGetName(ALint obj);
+ALint _alNamedObjectAdd(intptr_t obj);
+ALint _alNamedObjectGetName(intptr_t obj);
 
-inline SceInt32 _alLockNgsResource(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceNgsParamsID uParamsInterfaceId, SceNgsBufferInfo* pParamsBuffer)
+inline SceInt32 _alLockNgsResource(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceNgsParamsID uParamsInterfaceId, SceNgsBufferInfo* pParamsBuffer, al::LockSite site)
 {
 	SceInt32 ret = sceNgsVoiceLockParams(hVoiceHandle, uModule, uParamsInterfaceId, pParamsBuffer);
-	while (ret == SCE_NGS_ERROR_RESOURCE_LOCKED)
+	SceInt32 retries = 0;
+	SceUInt64 startTime = 0;
+	SceUInt32 waitTime = 0;
+
+	if (ret == SCE_NGS_ERROR_RESOURCE_LOCKED)
 	{
-		ret = sceNgsVoiceLockParams(hVoiceHandle, uModule, uParamsInterfaceId, pParamsBuffer);
-		sceKernelDelayThread(100);
+		startTime = sceKernelGetProcessTimeWide();
+
+		while (ret == SCE_NGS_ERROR_RESOURCE_LOCKED)
+		{
+			sceKernelDelayThread(AL_LOCK_RETRY_DELAY_US);
+			ret = sceNgsVoiceLockParams(hVoiceHandle, uModule, uParamsInterfaceId, pParamsBuffer);
+			retries++;
+
+			waitTime = (SceUInt32)(sceKernelGetProcessTimeWide() - startTime);
+
+			// Key-on and the buffer callback cannot drop their write, only the other writers give up
+			if (ret == SCE_NGS_ERROR_RESOURCE_LOCKED && waitTime >= AL_LOCK_MAX_WAIT_US && !al::_alLockSiteIsCritical(site))
+			{
+				AL_WARNING("Gave up on NGS params after %u us\n", waitTime);
+				al::_alCounterLockTimeout(site);
+				break;
+			}
+		}
 	}
 
+	al::_alCounterLock(site, retries, waitTime);
+
 	return ret;
 }
 
-#define _alTryLockNgsResource sceNgsVoiceLockParams
+inline SceInt32 _alTryLockNgsResource(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceNgsParamsID uParamsInterfaceId, SceNgsBufferInfo* pParamsBuffer, al::LockSite site)
+{
+	SceInt32 ret = sceNgsVoiceLockParams(hVoiceHandle, uModule, uParamsInterfaceId, pParamsBuffer);
+
+	if (ret == SCE_NGS_ERROR_RESOURCE_LOCKED)
+	{
+		al::_alCounterLockDeferred(site);
+	}
+	else
+	{
+		al::_alCounterLock(site, 0, 0);
+	}
+
+	return ret;
+}
 
 #endif
\ No newline at end of file
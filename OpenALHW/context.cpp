@@ -2,23 +2,49 @@
 #include <audioout.h>
 #include <string.h>
 #include <ngs.h>
+#include <algorithm>
 
 #include "common.h"
 #include "device.h"
 #include "panner.h"
 #include "context.h"
+#include "backend_ngs.h"
 
 using namespace al;
 
-Context::Context(Device *device)
+Context::Context(Device *device, SceInt32 portType, const ContextAttributes *pAttrs)
 {
 	m_dev = device;
-	m_voiceDef = sceNgsVoiceDefGetSimpleVoice();
-	m_sysMem = NULL;
-	m_masterRackMem.data = NULL;
-	m_masterRackMem.size = NULL;
+	m_portType = portType;
+	m_attrs = *pAttrs;
+	m_backend = NULL;
+	m_lockCreated = ALC_FALSE;
+	m_resetBackend = NULL;
+	m_resetRing = NULL;
+	m_ngsRenderThread = SCE_UID_INVALID_UID;
 	m_ngsOutThread = SCE_UID_INVALID_UID;
+	m_ngsUpdateThread = SCE_UID_INVALID_UID;
+	m_outputRing = NULL;
+	m_loopbackAvail = 0;
+	m_loopbackGranules = 0;
+	m_freeSema = SCE_UID_INVALID_UID;
+	m_filledSema = SCE_UID_INVALID_UID;
+	m_underrunCount = 0;
+	m_parkCount = 0;
+	m_maxRenderTime = 0;
+	m_maxOutputBlockTime = 0;
+	m_outputStart = 0;
+	m_outputGranules = 0;
+	m_runEvent = SCE_UID_INVALID_UID;
+	m_idle = ALC_FALSE;
+	m_paused = ((DeviceNGS *)device)->isPaused();
+	m_silentGranules = 0;
+	m_idleStart = 0;
+	m_idleTime = 0;
 	m_outActive = ALC_TRUE;
+	m_outputStarted = ALC_FALSE;
+	m_wakeTime = 0;
+	m_firstSampleTime = 0;
 
 	m_listenerPosition.x = 0.0f;
 	m_listenerPosition.y = 0.0f;
@@ -38,176 +64,402 @@ Context::Context(Device *device)
 
 	m_listenerGain = 1.0f;
 
+	configure();
+}
+
+// Everything that can fail, the device only adds the context once this succeeded
+ALCint Context::init()
+{
 	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
 	SceInt32 ret = SCE_OK;
-	SceSize reqSize = 0;
-	SceNgsRackDescription masterRackDesc;
-	SceNgsRackDescription sourceRackDesc;
-	SceNgsSystemInitParams initParams;
-	SceInt32 totalVoiceCount = ngsDev->getMaxMonoVoiceCount() + ngsDev->getMaxStereoVoiceCount();
 
-	m_voiceUsed = (bool *)AL_MALLOC(sizeof(bool) * totalVoiceCount);
+	ret = sceKernelCreateLwMutex(&m_lock, "OpenALHW::SysMtx", 0, 0, NULL);
+	if (ret != SCE_OK)
+	{
+		return ALC_INVALID_VALUE;
+	}
 
-	memset(m_voiceUsed, 0, sizeof(bool) * totalVoiceCount);
+	m_lockCreated = ALC_TRUE;
 
-	initParams.nMaxRacks = 2;
-	initParams.nMaxVoices = totalVoiceCount + 1;
-	initParams.nGranularity = NGS_SYSTEM_GRANULARITY;
-	initParams.nSampleRate = ngsDev->getSamplingFrequency();
-	initParams.nMaxModules = 14;
+	m_backend = createBackend(&m_attrs);
 
-	ret = sceNgsSystemGetRequiredMemorySize(&initParams, &reqSize);
-	if (ret != SCE_NGS_OK)
+	ret = m_backend->init(m_granularity, ngsDev->getSamplingFrequency(), m_attrs.maxMonoVoices + m_attrs.maxStereoVoices);
+	if (ret != AL_NO_ERROR)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		return (ret == AL_OUT_OF_MEMORY) ? ALC_OUT_OF_MEMORY : ALC_INVALID_VALUE;
 	}
 
-	m_sysMem = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, reqSize);
-	if (m_sysMem == NULL)
+	if (ngsDev->getOutputMode() == DeviceOutput_Loopback)
 	{
-		AL_SET_ERROR(ALC_OUT_OF_MEMORY);
-		return;
+		// The caller drives rendering, keep one granule around for reads that end mid-granule
+		m_outputRing = (int16_t *)AL_MALLOC(m_granularity * 2 * sizeof(int16_t));
+		if (m_outputRing == NULL)
+		{
+			return ALC_OUT_OF_MEMORY;
+		}
 	}
 
-	ret = sceNgsSystemInit(m_sysMem, reqSize, &initParams, &m_system);
-	if (ret != SCE_NGS_OK)
+	// Output threads and the ring are brought up by wake() once something is played
+	return ALC_NO_ERROR;
+}
+
+ALvoid Context::configure()
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+
+	m_granularity = m_attrs.granularity;
+	m_updateInterval = 1000000 / m_attrs.refreshRate;
+	m_outputBuffers = m_attrs.outputBuffers;
+
+	// Spread each parameter change over the granules that elapse between two update ticks
+	m_rampGranules = (ALint)(((SceUInt64)m_updateInterval * ngsDev->getSamplingFrequency() + (SceUInt64)m_granularity * 1000000 - 1) / ((SceUInt64)m_granularity * 1000000));
+	if (m_rampGranules < 1)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		m_rampGranules = 1;
 	}
+}
 
-	sourceRackDesc.nChannelsPerVoice = 2;
-	sourceRackDesc.nVoices = totalVoiceCount;
-	sourceRackDesc.pVoiceDefn = sceNgsVoiceDefGetSimpleVoice();
-	sourceRackDesc.nMaxPatchesPerInput = 0;
-	sourceRackDesc.nPatchesPerOutput = 1;
+Backend *Context::createBackend(const ContextAttributes *pAttrs)
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
 
-	ret = sceNgsRackGetRequiredMemorySize(m_system, &sourceRackDesc, &m_sourceRackMem.size);
-	if (ret != SCE_NGS_OK)
+	if (pAttrs->renderSystems > 1)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		return new BackendSplit(pAttrs->renderSystems, ngsDev->getOutputThreadAffinity(), pAttrs->softwareMixer);
 	}
+	else if (pAttrs->softwareMixer == ALC_TRUE)
+	{
+		return new BackendSoft();
+	}
+
+	return new BackendNGS();
+}
 
-	m_sourceRackMem.data = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, m_sourceRackMem.size);
-	if (m_sourceRackMem.data == NULL)
+ALCint Context::startOutput()
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+	SceInt32 ret = SCE_OK;
+	SceUID threads[3];
+	ALint started = 0;
+
+	m_outActive = ALC_TRUE;
+
+	m_outputRing = (int16_t *)AL_MALLOC(m_outputBuffers * m_granularity * 2 * sizeof(int16_t));
+	if (m_outputRing == NULL)
 	{
-		AL_SET_ERROR(ALC_OUT_OF_MEMORY);
-		return;
+		releaseOutput(0);
+		return ALC_OUT_OF_MEMORY;
 	}
 
-	memset(m_sourceRackMem.data, 0, m_sourceRackMem.size);
+	// One extra count on each so the destructor can always wake a blocked thread
+	m_freeSema = sceKernelCreateSema("OpenALHW::OutFree", SCE_KERNEL_SEMA_ATTR_TH_FIFO, m_outputBuffers, m_outputBuffers + 1, NULL);
+	m_filledSema = sceKernelCreateSema("OpenALHW::OutFilled", SCE_KERNEL_SEMA_ATTR_TH_FIFO, 0, m_outputBuffers + 1, NULL);
+	m_runEvent = sceKernelCreateEventFlag("OpenALHW::RunEvent", SCE_KERNEL_EVF_ATTR_MULTI, m_paused ? 0 : NGS_RUN_EVENT, NULL);
+	if (m_freeSema <= 0 || m_filledSema <= 0 || m_runEvent <= 0)
+	{
+		releaseOutput(0);
+		return ALC_INVALID_VALUE;
+	}
 
-	ret = sceNgsRackInit(m_system, &m_sourceRackMem, &sourceRackDesc, &m_sourceRack);
-	if (ret != SCE_NGS_OK)
+	m_ngsRenderThread = sceKernelCreateThread("OpenALHW::NGSRender", renderThread, SCE_KERNEL_HIGHEST_PRIORITY_USER, SCE_KERNEL_4KiB, 0, ngsDev->getOutputThreadAffinity(), NULL);
+	m_ngsOutThread = sceKernelCreateThread("OpenALHW::NGSOut", outputThread, SCE_KERNEL_HIGHEST_PRIORITY_USER, SCE_KERNEL_4KiB, 0, ngsDev->getOutputThreadAffinity(), NULL);
+	m_ngsUpdateThread = sceKernelCreateThread("OpenALHW::NGSUpdate", updateThread, SCE_KERNEL_HIGHEST_PRIORITY_USER + 1, SCE_KERNEL_4KiB, 0, ngsDev->getUpdateThreadAffinity(), NULL);
+	if (m_ngsRenderThread <= 0 || m_ngsOutThread <= 0 || m_ngsUpdateThread <= 0)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		releaseOutput(0);
+		return ALC_INVALID_VALUE;
 	}
 
-	masterRackDesc.nChannelsPerVoice = 2;
-	masterRackDesc.nVoices = 1;
-	masterRackDesc.pVoiceDefn = sceNgsVoiceDefGetMasterBuss();
-	masterRackDesc.nMaxPatchesPerInput = totalVoiceCount;
-	masterRackDesc.nPatchesPerOutput = 0;
+	Context *argptr = this;
+
+	threads[0] = m_ngsRenderThread;
+	threads[1] = m_ngsOutThread;
+	threads[2] = m_ngsUpdateThread;
 
-	ret = sceNgsRackGetRequiredMemorySize(m_system, &masterRackDesc, &m_masterRackMem.size);
-	if (ret != SCE_NGS_OK)
+	for (started = 0; started < 3; started++)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		ret = sceKernelStartThread(threads[started], sizeof(Context **), &argptr);
+		if (ret != SCE_OK)
+		{
+			releaseOutput(started);
+			return ALC_INVALID_VALUE;
+		}
 	}
 
-	m_masterRackMem.data = AL_MEMALIGN(SCE_NGS_MEMORY_ALIGN_SIZE, m_masterRackMem.size);
-	if (m_masterRackMem.data == NULL)
+	return ALC_NO_ERROR;
+}
+
+// Undoes whatever startOutput() got to. The first startedThreads threads are running and get joined, the others are only deleted
+ALvoid Context::releaseOutput(ALint startedThreads)
+{
+	SceUID threads[3] = { m_ngsRenderThread, m_ngsOutThread, m_ngsUpdateThread };
+
+	m_outActive = ALC_FALSE;
+
+	if (startedThreads > 0)
 	{
-		AL_SET_ERROR(ALC_OUT_OF_MEMORY);
-		return;
+		// Parked threads only re-check m_outActive once the event is set
+		sceKernelSetEventFlag(m_runEvent, NGS_RUN_EVENT);
+		sceKernelSignalSema(m_freeSema, 1);
+		sceKernelSignalSema(m_filledSema, 1);
 	}
 
-	memset(m_masterRackMem.data, 0, m_masterRackMem.size);
+	for (int i = 0; i < 3; i++)
+	{
+		if (i < startedThreads)
+		{
+			sceKernelWaitThreadEnd(threads[i], NULL, NULL);
+		}
+		else if (threads[i] > 0)
+		{
+			sceKernelDeleteThread(threads[i]);
+		}
+	}
+
+	if (m_freeSema > 0)
+		sceKernelDeleteSema(m_freeSema);
+	if (m_filledSema > 0)
+		sceKernelDeleteSema(m_filledSema);
+	if (m_runEvent > 0)
+		sceKernelDeleteEventFlag(m_runEvent);
+
+	m_ngsRenderThread = SCE_UID_INVALID_UID;
+	m_ngsOutThread = SCE_UID_INVALID_UID;
+	m_ngsUpdateThread = SCE_UID_INVALID_UID;
+	m_freeSema = SCE_UID_INVALID_UID;
+	m_filledSema = SCE_UID_INVALID_UID;
+	m_runEvent = SCE_UID_INVALID_UID;
 
-	ret = sceNgsRackInit(m_system, &m_masterRackMem, &masterRackDesc, &m_masterRack);
-	if (ret != SCE_NGS_OK)
+	if (m_outputRing)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		AL_FREE(m_outputRing);
+		m_outputRing = NULL;
 	}
+}
+
+ALvoid Context::stopOutput()
+{
+	m_outActive = ALC_FALSE;
 
-	ret = sceNgsRackGetVoiceHandle(m_masterRack, 0, &m_masterVoice);
-	if (ret != SCE_NGS_OK)
+	if (m_outputStarted == ALC_FALSE)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
 		return;
 	}
 
-	ret = sceNgsVoicePlay(m_masterVoice);
-	if (ret != SCE_NGS_OK)
+	releaseOutput(3);
+
+	// Close any idle period so the next start begins from a clean running state
+	if (m_idle == ALC_TRUE)
 	{
-		AL_SET_ERROR(_alErrorNgs2Al(ret));
-		return;
+		m_idleTime += sceKernelGetProcessTimeWide() - m_idleStart;
+		m_idle = ALC_FALSE;
 	}
 
-	m_ngsOutThread = sceKernelCreateThread("OpenALHW::NGSOut", outputThread, SCE_KERNEL_HIGHEST_PRIORITY_USER, SCE_KERNEL_4KiB, 0, ngsDev->getOutputThreadAffinity(), NULL);
-	if (m_ngsOutThread <= 0)
+	m_silentGranules = 0;
+	m_outputStarted = ALC_FALSE;
+}
+
+Context::~Context()
+{
+	// init() failed before the lock existed, nothing else was set up either
+	if (m_lockCreated == ALC_FALSE)
 	{
-		AL_SET_ERROR(ALC_INVALID_VALUE);
 		return;
 	}
 
-	m_ngsUpdateThread = sceKernelCreateThread("OpenALHW::NGSUpdate", updateThread, SCE_KERNEL_HIGHEST_PRIORITY_USER + 1, SCE_KERNEL_4KiB, 0, ngsDev->getUpdateThreadAffinity(), NULL);
-	if (m_ngsOutThread <= 0)
+	stopOutput();
+
+	// Sources die with the context. Buffers are shared by the whole device, so their references must go too
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	for (Source *src : m_sourceStack)
 	{
-		AL_SET_ERROR(ALC_INVALID_VALUE);
-		return;
+		if (src->m_capture == NULL)
+		{
+			src->dropAllBuffers();
+		}
+
+		// Also gives capture devices back, otherwise they could never be closed
+		src->release();
+
+		_alNamedObjectRemove(_alNamedObjectGetName((intptr_t)src));
+
+		delete src;
 	}
 
-	Context *argptr = this;
+	m_sourceStack.clear();
 
-	ret = sceKernelStartThread(m_ngsOutThread, sizeof(Context **), &argptr);
-	if (ret != SCE_OK)
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	delete m_backend;
+
+	sceKernelDeleteLwMutex(&m_lock);
+
+	if (m_outputRing)
+		AL_FREE(m_outputRing);
+}
+
+ALCint Context::prepareReset(const ContextAttributes *pAttrs)
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+	ALint maxVoices = pAttrs->maxMonoVoices + pAttrs->maxStereoVoices;
+	ALint ret = AL_NO_ERROR;
+
+	if ((ALint)m_sourceStack.size() > maxVoices)
 	{
-		AL_SET_ERROR(ALC_INVALID_VALUE);
-		return;
+		return ALC_INVALID_VALUE;
 	}
 
-	ret = sceKernelStartThread(m_ngsUpdateThread, sizeof(Context **), &argptr);
-	if (ret != SCE_OK)
+	// Bring the new system up next to the old one, nothing the running context uses is touched until commitReset()
+	m_resetAttrs = *pAttrs;
+	m_resetBackend = createBackend(pAttrs);
+
+	ret = m_resetBackend->init(pAttrs->granularity, ngsDev->getSamplingFrequency(), maxVoices);
+	if (ret != AL_NO_ERROR)
 	{
-		AL_SET_ERROR(ALC_INVALID_VALUE);
-		return;
+		abortReset();
+		return ret;
 	}
 
-	ret = sceKernelCreateLwMutex(&m_lock, "OpenALHW::SysMtx", 0, 0, NULL);
-	if (ret != SCE_OK)
+	for (size_t i = 0; i < m_sourceStack.size(); i++)
 	{
-		AL_SET_ERROR(ALC_INVALID_VALUE);
-		return;
+		Voice *voice = m_resetBackend->acquireVoice();
+		if (voice == NULL)
+		{
+			abortReset();
+			return ALC_OUT_OF_MEMORY;
+		}
+
+		m_resetVoices.push_back(voice);
 	}
+
+	if (ngsDev->getOutputMode() == DeviceOutput_Loopback)
+	{
+		m_resetRing = (int16_t *)AL_MALLOC(pAttrs->granularity * 2 * sizeof(int16_t));
+		if (m_resetRing == NULL)
+		{
+			abortReset();
+			return ALC_OUT_OF_MEMORY;
+		}
+	}
+
+	return ALC_NO_ERROR;
 }
 
-Context::~Context()
+ALvoid Context::abortReset()
 {
-	sceNgsVoiceKeyOff(m_masterVoice);
+	for (Voice *voice : m_resetVoices)
+	{
+		m_resetBackend->releaseVoice(voice);
+	}
 
-	m_outActive = ALC_FALSE;
+	m_resetVoices.clear();
 
-	sceKernelWaitThreadEnd(m_ngsOutThread, NULL, NULL);
-	sceKernelWaitThreadEnd(m_ngsUpdateThread, NULL, NULL);
+	delete m_resetBackend;
+	m_resetBackend = NULL;
 
-	sceNgsSystemRelease(m_system);
+	if (m_resetRing)
+	{
+		AL_FREE(m_resetRing);
+		m_resetRing = NULL;
+	}
+}
 
-	sceKernelDeleteLwMutex(&m_lock);
+ALvoid Context::commitReset()
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+	Backend *oldBackend = m_backend;
+	ALCboolean restart = m_outputStarted;
+
+	stopOutput();
+
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	// Buffers are owned by the device and stay where they are, only the voices playing them move
+	for (size_t i = 0; i < m_sourceStack.size(); i++)
+	{
+		if (m_sourceStack[i]->rebind(m_resetVoices[i]) == AL_PLAYING)
+		{
+			restart = ALC_TRUE;
+		}
+	}
 
-	if (m_sysMem)
-		AL_FREE(m_sysMem);
-	if (m_masterRackMem.data)
-		AL_FREE(m_masterRackMem.data);
-	if (m_sourceRackMem.data)
-		AL_FREE(m_sourceRackMem.data);
-	if (m_voiceUsed)
-		AL_FREE(m_voiceUsed);
+	m_backend = m_resetBackend;
+	m_attrs = m_resetAttrs;
+
+	configure();
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	m_resetBackend = NULL;
+	m_resetVoices.clear();
+
+	delete oldBackend;
+
+	if (ngsDev->getOutputMode() == DeviceOutput_Loopback)
+	{
+		if (m_outputRing)
+		{
+			AL_FREE(m_outputRing);
+		}
+
+		m_loopbackAvail = 0;
+		m_outputRing = m_resetRing;
+		m_resetRing = NULL;
+	}
+	else if (restart == ALC_TRUE)
+	{
+		wake();
+	}
+}
+
+SceInt32 Context::renderThread(SceSize argSize, void *pArgBlock)
+{
+	Context *ctx = *(Context **)pArgBlock;
+	SceInt32 bufferSize = ctx->m_granularity * 2;
+	SceInt32 writeIdx = 0;
+	SceUInt64 startTime = 0;
+	SceUInt32 elapsed = 0;
+
+	while ((volatile ALCboolean)ctx->m_outActive)
+	{
+		if (ctx->isParked())
+		{
+			sceKernelWaitEventFlag(ctx->m_runEvent, NGS_RUN_EVENT, SCE_KERNEL_EVF_WAITMODE_OR, NULL, NULL);
+			continue;
+		}
+
+		if (sceKernelWaitSema(ctx->m_freeSema, 1, NULL) != SCE_OK)
+		{
+			break;
+		}
+
+		if (!(volatile ALCboolean)ctx->m_outActive)
+		{
+			break;
+		}
+
+		startTime = sceKernelGetProcessTimeWide();
+
+		ctx->renderGranule(ctx->m_outputRing + writeIdx * bufferSize);
+
+		elapsed = (SceUInt32)(sceKernelGetProcessTimeWide() - startTime);
+		if (elapsed > ctx->m_maxRenderTime)
+		{
+			ctx->m_maxRenderTime = elapsed;
+		}
+
+		// Decide before publishing the buffer so the output thread does not count the drain as an underrun
+		ctx->checkIdle(ctx->m_outputRing + writeIdx * bufferSize);
+
+		sceKernelSignalSema(ctx->m_filledSema, 1);
+
+		writeIdx = (writeIdx + 1) % ctx->m_outputBuffers;
+	}
+
+	_alTraceThreadExit();
+
+	return sceKernelExitDeleteThread(0);
 }
 
 SceInt32 Context::outputThread(SceSize argSize, void *pArgBlock)
@@ -215,39 +467,117 @@ SceInt32 Context::outputThread(SceSize argSize, void *pArgBlock)
 	Context *ctx = *(Context **)pArgBlock;
 	DeviceNGS *ngsDev = (DeviceNGS *)ctx->getDevice();
 	SceInt32 portId = -1;
-	ScePVoid outputBuffer[2];
-	SceInt32 bufferIndex = 0;
-
-	portId = sceAudioOutOpenPort(SCE_AUDIO_OUT_PORT_TYPE_MAIN,
-		NGS_SYSTEM_GRANULARITY,
-		ngsDev->getSamplingFrequency(),
-		SCE_AUDIO_OUT_PARAM_FORMAT_S16_STEREO);
-
-	SceInt32 volume[2] = { SCE_AUDIO_VOLUME_0dB, SCE_AUDIO_VOLUME_0dB };
-	sceAudioOutSetVolume(portId, (SCE_AUDIO_VOLUME_FLAG_L_CH | SCE_AUDIO_VOLUME_FLAG_R_CH), volume);
+	SceInt32 bufferSize = ctx->m_granularity * 2;
+	SceInt32 readIdx = 0;
+	SceInt32 playingIdx = -1;
+	SceUInt64 startTime = 0;
+	SceUInt32 elapsed = 0;
+	DeviceOutput output = ngsDev->getOutputMode();
+	ALCboolean paced = (output == DeviceOutput_Port || ngsDev->isPaced() == ALC_TRUE) ? ALC_TRUE : ALC_FALSE;
+	SceUInt64 paceStart = 0;
+	SceUInt64 paceGranules = 0;
+	SceUInt64 deadline = 0;
+	SceUInt32 granuleTime = ctx->m_granularity * 1000000 / ngsDev->getSamplingFrequency();
+	SceUInt64 playEnd = 0;
+	SceUInt32 parkCount = 0;
+	ALCboolean parked = ALC_FALSE;
+
+	if (output == DeviceOutput_Port)
+	{
+		portId = sceAudioOutOpenPort(ctx->m_portType,
+			ctx->m_granularity,
+			ngsDev->getSamplingFrequency(),
+			SCE_AUDIO_OUT_PARAM_FORMAT_S16_STEREO);
 
-	for (int i = 0; i < 2; i++) {
-		outputBuffer[i] = (short *)AL_MALLOC(NGS_SYSTEM_GRANULARITY * 2 * sizeof(short));
+		SceInt32 volume[2] = { SCE_AUDIO_VOLUME_0dB, SCE_AUDIO_VOLUME_0dB };
+		sceAudioOutSetVolume(portId, (SCE_AUDIO_VOLUME_FLAG_L_CH | SCE_AUDIO_VOLUME_FLAG_R_CH), volume);
 	}
 
+	ctx->m_outputStart = sceKernelGetProcessTimeWide();
+	paceStart = ctx->m_outputStart;
+
 	while ((volatile ALCboolean)ctx->m_outActive)
 	{
-		sceNgsSystemUpdate(ctx->m_system);
+		if (sceKernelPollSema(ctx->m_filledSema, 1) != SCE_OK)
+		{
+			parked = ctx->isParked();
+			parkCount = ctx->m_parkCount;
+
+			if (sceKernelWaitSema(ctx->m_filledSema, 1, NULL) != SCE_OK)
+			{
+				break;
+			}
+
+			// Waiting is normal, the port only runs dry when the wait outlasts the buffer it is still playing
+			if (playingIdx >= 0 && paced == ALC_TRUE && parked == ALC_FALSE && parkCount == ctx->m_parkCount &&
+				sceKernelGetProcessTimeWide() > playEnd)
+			{
+				ctx->m_underrunCount++;
+				_alCounterAdd(Counter_Underruns, 1);
+			}
+		}
 
-		sceNgsVoiceGetStateData(ctx->m_masterVoice, SCE_NGS_MASTER_BUSS_OUTPUT_MODULE,
-			outputBuffer[bufferIndex], sizeof(short) * NGS_SYSTEM_GRANULARITY * 2);
+		if (!(volatile ALCboolean)ctx->m_outActive)
+		{
+			break;
+		}
 
-		sceAudioOutOutput(portId, outputBuffer[bufferIndex]);
+		startTime = sceKernelGetProcessTimeWide();
 
-		bufferIndex ^= 1;
-	}
+		if (output == DeviceOutput_Port)
+		{
+			sceAudioOutOutput(portId, ctx->m_outputRing + readIdx * bufferSize);
+		}
+		else if (paced == ALC_TRUE)
+		{
+			// Stand in for the port clock, restart the timeline after a park instead of bursting to catch up
+			paceGranules++;
+			deadline = paceStart + paceGranules * ctx->m_granularity * 1000000 / ngsDev->getSamplingFrequency();
+			if (startTime > deadline + ctx->m_granularity * 1000000 / ngsDev->getSamplingFrequency())
+			{
+				paceStart = startTime;
+				paceGranules = 0;
+			}
+			else if (startTime < deadline)
+			{
+				sceKernelDelayThread((SceUInt32)(deadline - startTime));
+			}
+		}
 
-	sceAudioOutReleasePort(portId);
+		// The port has just taken this buffer, it lasts one granule from here
+		playEnd = sceKernelGetProcessTimeWide() + granuleTime;
 
-	for (int i = 0; i < 2; i++) {
-		AL_FREE(outputBuffer[i]);
+		if (ctx->m_firstSampleTime == 0)
+		{
+			ctx->m_firstSampleTime = playEnd - granuleTime;
+		}
+
+		ctx->m_outputGranules++;
+
+		elapsed = (SceUInt32)(sceKernelGetProcessTimeWide() - startTime);
+		_alCounterAdd(Counter_OutputBlockTime, elapsed);
+		if (elapsed > ctx->m_maxOutputBlockTime)
+		{
+			ctx->m_maxOutputBlockTime = elapsed;
+		}
+
+		// The port reads a buffer until the next output call returns, only then it can be rendered into again
+		if (playingIdx >= 0)
+		{
+			sceKernelSignalSema(ctx->m_freeSema, 1);
+		}
+
+		playingIdx = readIdx;
+		readIdx = (readIdx + 1) % ctx->m_outputBuffers;
 	}
 
+	if (output == DeviceOutput_Port)
+	{
+		sceAudioOutReleasePort(portId);
+	}
+
+	_alTraceThreadExit();
+
 	return sceKernelExitDeleteThread(0);
 }
 
@@ -258,19 +588,89 @@ SceInt32 Context::updateThread(SceSize argSize, void *pArgBlock)
 
 	while ((volatile ALCboolean)ctx->m_outActive)
 	{
-		sceKernelLockLwMutex(&ctx->m_lock, 1, NULL);
-		for (Source *src : ctx->m_sourceStack)
+		if (ctx->isParked())
 		{
-			src->update();
+			sceKernelWaitEventFlag(ctx->m_runEvent, NGS_RUN_EVENT, SCE_KERNEL_EVF_WAITMODE_OR, NULL, NULL);
+			continue;
 		}
-		sceKernelUnlockLwMutex(&ctx->m_lock, 1);
 
-		sceKernelDelayThread(NGS_UPDATE_INTERVAL_US);
+		ctx->updateSources();
+
+		sceKernelDelayThread(ctx->m_updateInterval);
 	}
 
+	_alTraceThreadExit();
+
 	return sceKernelExitDeleteThread(0);
 }
 
+ALvoid Context::updateSources()
+{
+	SceUInt64 startTime = sceKernelGetProcessTimeWide();
+	SceUInt32 elapsed = 0;
+	ALint count = 0;
+
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+	for (Source *src : m_sourceStack)
+	{
+		src->update();
+	}
+	count = m_sourceStack.size();
+	sceKernelUnlockLwMutex(&m_lock, 1);
+
+	elapsed = (SceUInt32)(sceKernelGetProcessTimeWide() - startTime);
+
+	_alCounterAdd(Counter_TickCount, 1);
+	_alCounterAdd(Counter_TickTime, elapsed);
+	_alCounterAdd(Counter_TickSources, count);
+	_alCounterMin(Counter_TickTimeMin, elapsed);
+	_alCounterMax(Counter_TickTimeMax, elapsed);
+}
+
+ALvoid Context::renderGranule(int16_t *pOut)
+{
+	applyRamps();
+
+	m_backend->render(pOut);
+
+	publishSnapshots();
+}
+
+ALvoid Context::renderSamples(int16_t *pOut, ALCsizei frames)
+{
+	ALCsizei count = 0;
+
+	if (m_firstSampleTime == 0 && m_wakeTime != 0)
+	{
+		m_firstSampleTime = sceKernelGetProcessTimeWide();
+	}
+
+	while (frames > 0)
+	{
+		if (m_loopbackAvail == 0)
+		{
+			// Source updates follow rendered time rather than the wall clock
+			if (m_loopbackGranules % m_rampGranules == 0)
+			{
+				updateSources();
+			}
+
+			renderGranule(m_outputRing);
+
+			m_loopbackGranules++;
+			m_loopbackAvail = m_granularity;
+		}
+
+		count = std::min(frames, (ALCsizei)m_loopbackAvail);
+
+		memcpy(pOut, m_outputRing + (m_granularity - m_loopbackAvail) * 2, count * 2 * sizeof(int16_t));
+
+		pOut += count * 2;
+		frames -= count;
+		m_loopbackAvail -= count;
+	}
+}
+
 ALvoid Context::beginParamUpdate()
 {
 	sceKernelLockLwMutex(&m_lock, 1, NULL);
@@ -290,14 +690,215 @@ ALvoid Context::markAllAsDirty()
 	}
 }
 
+ALvoid Context::applyRamps()
+{
+	// Never stall the output thread on API calls, a busy source list just delays the ramp by one granule
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		return;
+	}
+
+	for (Source *src : m_sourceStack)
+	{
+		src->applyRamp();
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Context::publishSnapshots()
+{
+	// Same as the ramps, a busy source list leaves the snapshots one granule older
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		return;
+	}
+
+	for (Source *src : m_sourceStack)
+	{
+		src->publishSnapshot();
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Context::checkIdle(const int16_t *pBuffer)
+{
+	for (ALint i = 0; i < m_granularity * 2; i++)
+	{
+		if (pBuffer[i] != 0)
+		{
+			m_silentGranules = 0;
+			return;
+		}
+	}
+
+	if (++m_silentGranules < NGS_IDLE_GRANULES)
+	{
+		return;
+	}
+
+	if (sceKernelTryLockLwMutex(&m_lock, 1) != SCE_OK)
+	{
+		return;
+	}
+
+	for (Source *src : m_sourceStack)
+	{
+		if (src->m_voice->getState() == AL_PLAYING || src->m_captureRunning == AL_TRUE)
+		{
+			m_silentGranules = 0;
+			sceKernelUnlockLwMutex(&m_lock, 1);
+			return;
+		}
+	}
+
+	m_idleStart = sceKernelGetProcessTimeWide();
+	m_idle = ALC_TRUE;
+	m_parkCount++;
+	sceKernelClearEventFlag(m_runEvent, ~NGS_RUN_EVENT);
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Context::wake()
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+	ALCint ret = ALC_NO_ERROR;
+
+	// Callers start their voice first, so a concurrent checkIdle either sees it playing or is undone here
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	m_silentGranules = 0;
+
+	// First sample latency counts from here, creating the context is not something the caller hears
+	if (m_wakeTime == 0)
+	{
+		m_wakeTime = sceKernelGetProcessTimeWide();
+	}
+
+	if (m_outputStarted == ALC_FALSE && ngsDev->getOutputMode() != DeviceOutput_Loopback)
+	{
+		// First play on this context, nothing was rendered so there is no idle period to close
+		ret = startOutput();
+		if (ret != ALC_NO_ERROR)
+		{
+			AL_SET_ERROR(ret);
+		}
+		else
+		{
+			m_outputStarted = ALC_TRUE;
+		}
+
+		sceKernelUnlockLwMutex(&m_lock, 1);
+		return;
+	}
+
+	if (m_idle == ALC_TRUE)
+	{
+		m_idleTime += sceKernelGetProcessTimeWide() - m_idleStart;
+		m_idle = ALC_FALSE;
+
+		if (m_paused == ALC_FALSE)
+		{
+			sceKernelSetEventFlag(m_runEvent, NGS_RUN_EVENT);
+		}
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Context::pauseOutput()
+{
+	// Voices, patches and params stay untouched, the render thread just stops rendering granules
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	m_paused = ALC_TRUE;
+	m_parkCount++;
+	if (m_outputStarted == ALC_TRUE)
+	{
+		sceKernelClearEventFlag(m_runEvent, ~NGS_RUN_EVENT);
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALvoid Context::resumeOutput()
+{
+	sceKernelLockLwMutex(&m_lock, 1, NULL);
+
+	m_paused = ALC_FALSE;
+	m_silentGranules = 0;
+
+	if (m_idle == ALC_FALSE && m_outputStarted == ALC_TRUE)
+	{
+		sceKernelSetEventFlag(m_runEvent, NGS_RUN_EVENT);
+	}
+
+	sceKernelUnlockLwMutex(&m_lock, 1);
+}
+
+ALCboolean Context::isParked()
+{
+	return ((volatile ALCboolean)m_idle || (volatile ALCboolean)m_paused) ? ALC_TRUE : ALC_FALSE;
+}
+
 ALint Context::suspend()
 {
-	return _alErrorNgs2Al(sceNgsSystemLock(m_system));
+	return m_backend->lock();
 }
 
 ALint Context::resume()
 {
-	return _alErrorNgs2Al(sceNgsSystemUnlock(m_system));
+	return m_backend->unlock();
+}
+
+ALCboolean Context::getIntegerv(ALCenum param, ALCint *value)
+{
+	DeviceNGS *ngsDev = (DeviceNGS *)m_dev;
+	SceUInt64 idleTime = 0;
+	SceUInt64 runTime = 0;
+
+	switch (param)
+	{
+	case ALC_OUTPUT_LATENCY_NGS:
+		*value = (ALCint)((SceUInt64)m_outputBuffers * m_granularity * 1000000 / ngsDev->getSamplingFrequency());
+		break;
+	case ALC_UNDERRUN_COUNT_NGS:
+		*value = (ALCint)m_underrunCount;
+		break;
+	case ALC_MAX_RENDER_TIME_NGS:
+		*value = (ALCint)m_maxRenderTime;
+		break;
+	case ALC_MAX_OUTPUT_BLOCK_TIME_NGS:
+		*value = (ALCint)m_maxOutputBlockTime;
+		break;
+	case ALC_IDLE_TIME_NGS:
+		idleTime = m_idleTime;
+		if (m_idle == ALC_TRUE)
+		{
+			idleTime += sceKernelGetProcessTimeWide() - m_idleStart;
+		}
+		*value = (ALCint)(idleTime / 1000);
+		break;
+	case ALC_GRANULES_PER_SECOND_NGS:
+		runTime = sceKernelGetProcessTimeWide() - m_outputStart;
+		*value = (m_outputStart != 0 && runTime != 0) ? (ALCint)(m_outputGranules * 1000000 / runTime) : 0;
+		break;
+	case ALC_RACK_COUNT_NGS:
+		*value = m_backend->getRackCount();
+		break;
+	case ALC_VOICE_CAPACITY_NGS:
+		*value = m_backend->getVoiceCapacity();
+		break;
+	case ALC_FIRST_SAMPLE_LATENCY_NGS:
+		*value = (m_firstSampleTime != 0) ? (ALCint)(m_firstSampleTime - m_wakeTime) : 0;
+		break;
+	default:
+		return ALC_FALSE;
+	}
+
+	return ALC_TRUE;
 }
 
 ALCboolean Context::validate(ALCcontext *context)
@@ -322,4 +923,8 @@ ALCboolean Context::validate(ALCcontext *context)
 Device *Context::getDevice()
 {
 	return m_dev;
+}
+const ContextAttributes *Context::getAttributes()
+{
+	return &m_attrs;
 }
\ No newline at end of file
@@ -5,32 +5,66 @@
 #include "AL/alc.h"
 #include "named_object.h"
 #include "panner.h"
+#include "backend.h"
 
 #ifndef AL_CONTEXT_H
 #define AL_CONTEXT_H
 
 #define NGS_SYSTEM_GRANULARITY (512)
-#define NGS_UPDATE_INTERVAL_US (5000)
+#define NGS_MIN_GRANULARITY (64)
+#define NGS_MAX_GRANULARITY (1024)
+#define NGS_UPDATE_INTERVAL_US (33333)
+#define NGS_MAX_REFRESH (1000)
+#define NGS_DEFAULT_OUTPUT_BUFFERS (2)
+#define NGS_MIN_OUTPUT_BUFFERS (2)
+#define NGS_MAX_OUTPUT_BUFFERS (8)
+#define NGS_IDLE_GRANULES (32)
+#define NGS_RUN_EVENT (0x1)
+#define NGS_MAX_EXTRAPOLATION_US (250000)
+#define NGS_MAX_RENDER_SYSTEMS (3)
 
 namespace al {
 
 	class Device;
 
+	// Everything alcCreateContext and alcResetDeviceSOFT can set for a single context
+	struct ContextAttributes
+	{
+		ALCint maxMonoVoices;
+		ALCint maxStereoVoices;
+		ALCint refreshRate;
+		ALCint granularity;
+		ALCint outputBuffers;
+		ALCboolean softwareMixer;
+		ALCint renderSystems;
+	};
+
 	class Context
 	{
 	public:
 
 		static ALCboolean validate(ALCcontext *ctx);
 
-		Context(Device *device);
+		Context(Device *device, SceInt32 portType, const ContextAttributes *pAttrs);
 		~Context();
 
+		ALCint init();
 		Device *getDevice();
+		const ContextAttributes *getAttributes();
 		ALvoid beginParamUpdate();
 		ALvoid endParamUpdate();
 		ALvoid markAllAsDirty();
+		ALvoid applyRamps();
+		ALvoid wake();
+		ALvoid pauseOutput();
+		ALvoid resumeOutput();
 		ALint suspend();
 		ALint resume();
+		ALCboolean getIntegerv(ALCenum param, ALCint *value);
+		ALvoid renderSamples(int16_t *pOut, ALCsizei frames);
+		ALCint prepareReset(const ContextAttributes *pAttrs);
+		ALvoid commitReset();
+		ALvoid abortReset();
 
 		float32_t m_listenerGain;
 		SceFVector4 m_listenerPosition;
@@ -39,28 +73,65 @@ namespace al {
 		SceFVector4 m_listenerUp;
 
 		ALCboolean m_outActive;
-		SceNgsHSynSystem m_system;
-		SceNgsHVoice m_masterVoice;
-		SceNgsHRack m_sourceRack;
+		Backend *m_backend;
 		std::vector<Source *> m_sourceStack;
-		std::vector<Buffer *> m_bufferStack;
-		bool *m_voiceUsed;
 		SceKernelLwMutexWork m_lock;
+		ALCboolean m_lockCreated;
 		Panner m_panner;
+		MotionTracker m_listenerMotion;
+		ALint m_rampGranules;
 
 	private:
 
+		static SceInt32 renderThread(SceSize argSize, void *pArgBlock);
 		static SceInt32 outputThread(SceSize argSize, void *pArgBlock);
 		static SceInt32 updateThread(SceSize argSize, void *pArgBlock);
 
+		ALvoid configure();
+		Backend *createBackend(const ContextAttributes *pAttrs);
+		ALCint startOutput();
+		ALvoid releaseOutput(ALint startedThreads);
+		ALvoid stopOutput();
+		ALvoid updateSources();
+		ALvoid renderGranule(int16_t *pOut);
+		ALvoid publishSnapshots();
+		ALvoid checkIdle(const int16_t *pBuffer);
+		ALCboolean isParked();
+
 		Device *m_dev;
-		ALCvoid *m_sysMem;
-		SceNgsBufferInfo m_masterRackMem;
-		SceNgsBufferInfo m_sourceRackMem;
-		SceNgsHRack m_masterRack;
+		SceInt32 m_portType;
+		ContextAttributes m_attrs;
+		ContextAttributes m_resetAttrs;
+		Backend *m_resetBackend;
+		std::vector<Voice *> m_resetVoices;
+		int16_t *m_resetRing;
+		ALint m_granularity;
+		SceUInt32 m_updateInterval;
+		ALint m_outputBuffers;
+		int16_t *m_outputRing;
+		SceUID m_freeSema;
+		SceUID m_filledSema;
+		SceUInt32 m_underrunCount;
+		// Bumped whenever rendering stops on purpose, so a wait that spans it is not an underrun
+		volatile SceUInt32 m_parkCount;
+		SceUInt32 m_maxRenderTime;
+		SceUInt32 m_maxOutputBlockTime;
+		SceUInt64 m_outputStart;
+		SceUInt64 m_outputGranules;
+		SceUID m_runEvent;
+		ALCboolean m_idle;
+		ALCboolean m_paused;
+		ALint m_silentGranules;
+		SceUInt64 m_idleStart;
+		SceUInt64 m_idleTime;
+		ALint m_loopbackAvail;
+		SceUInt32 m_loopbackGranules;
+		SceUID m_ngsRenderThread;
 		SceUID m_ngsOutThread;
 		SceUID m_ngsUpdateThread;
-		const SceNgsVoiceDefinition *m_voiceDef;
+		ALCboolean m_outputStarted;
+		SceUInt64 m_wakeTime;
+		SceUInt64 m_firstSampleTime;
 	};
 }
 
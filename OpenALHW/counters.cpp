@@ -0,0 +1,146 @@
+#include <stddef.h>
+
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "AL/alext.h"
+#include "counters.h"
+
+using namespace al;
+
+volatile int64_t al::g_counters[Counter_Max];
+LockSiteStats al::g_lockStats[LockSite_Max];
+
+// Zero initialisation is fine for every slot but the minimums
+static struct CounterInit
+{
+	CounterInit()
+	{
+		g_counters[Counter_TickTimeMin] = AL_COUNTER_NO_SAMPLE;
+	}
+} s_counterInit;
+
+static int64_t _alCounterAverage(Counter total, Counter count)
+{
+	int64_t samples = _alAtomicLoad64(&g_counters[count]);
+
+	return (samples != 0) ? _alAtomicLoad64(&g_counters[total]) / samples : 0;
+}
+
+ALvoid al::_alCounterLock(LockSite site, ALint retries, ALuint waitTime)
+{
+	ALint bucket = 0;
+
+	while (bucket < AL_LOCK_HISTOGRAM_BUCKETS - 1 && retries >= (1 << bucket))
+	{
+		bucket++;
+	}
+
+	_alAtomicAdd64(&g_lockStats[site].calls, 1);
+	_alAtomicAdd64(&g_lockStats[site].buckets[bucket], 1);
+
+	if (retries > 0)
+	{
+		_alAtomicAdd64(&g_lockStats[site].waitTime, waitTime);
+		_alCounterAdd(Counter_LockRetries, retries);
+	}
+}
+
+ALint al::_alLockStatsGet(ALenum param, int64_t *values)
+{
+	LockSiteStats *stats = NULL;
+
+	switch (param)
+	{
+	case AL_LOCK_STATS_API_NGS:
+		stats = &g_lockStats[LockSite_Api];
+		break;
+	case AL_LOCK_STATS_CALLBACK_NGS:
+		stats = &g_lockStats[LockSite_Callback];
+		break;
+	case AL_LOCK_STATS_UPDATE_NGS:
+		stats = &g_lockStats[LockSite_Update];
+		break;
+	case AL_LOCK_STATS_RAMP_NGS:
+		stats = &g_lockStats[LockSite_Ramp];
+		break;
+	case AL_LOCK_STATS_FILTER_NGS:
+		stats = &g_lockStats[LockSite_Filter];
+		break;
+	case AL_LOCK_STATS_GETTER_NGS:
+		stats = &g_lockStats[LockSite_Getter];
+		break;
+	case AL_LOCK_STATS_DRAIN_NGS:
+		stats = &g_lockStats[LockSite_Drain];
+		break;
+	default:
+		return 0;
+	}
+
+	// Same order as LockSiteStats: calls, wait time, deferred, timeouts, then the histogram
+	values[0] = _alAtomicLoad64(&stats->calls);
+	values[1] = _alAtomicLoad64(&stats->waitTime);
+	values[2] = _alAtomicLoad64(&stats->deferred);
+	values[3] = _alAtomicLoad64(&stats->timeouts);
+
+	for (ALint i = 0; i < AL_LOCK_HISTOGRAM_BUCKETS; i++)
+	{
+		values[4 + i] = _alAtomicLoad64(&stats->buckets[i]);
+	}
+
+	return 4 + AL_LOCK_HISTOGRAM_BUCKETS;
+}
+
+ALboolean al::_alCounterGet(ALenum param, int64_t *value)
+{
+	// Plain atomic loads only, safe to poll every frame from any thread
+	switch (param)
+	{
+	case AL_TICK_COUNT_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_TickCount]);
+		break;
+	case AL_TICK_TIME_MIN_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_TickTimeMin]);
+		if (*value == AL_COUNTER_NO_SAMPLE)
+		{
+			*value = 0;
+		}
+		break;
+	case AL_TICK_TIME_AVG_NGS:
+		*value = _alCounterAverage(Counter_TickTime, Counter_TickCount);
+		break;
+	case AL_TICK_TIME_MAX_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_TickTimeMax]);
+		break;
+	case AL_TICK_SOURCES_AVG_NGS:
+		*value = _alCounterAverage(Counter_TickSources, Counter_TickCount);
+		break;
+	case AL_SYSTEM_UPDATE_TIME_AVG_NGS:
+		*value = _alCounterAverage(Counter_SystemUpdateTime, Counter_SystemUpdateCount);
+		break;
+	case AL_SYSTEM_UPDATE_TIME_MAX_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_SystemUpdateTimeMax]);
+		break;
+	case AL_OUTPUT_BLOCK_TIME_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_OutputBlockTime]);
+		break;
+	case AL_UNDERRUN_COUNT_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_Underruns]);
+		break;
+	case AL_LOCK_RETRIES_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_LockRetries]);
+		break;
+	case AL_ACTIVE_VOICES_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_ActiveVoices]);
+		break;
+	case AL_VOICE_ALLOC_FAILURES_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_VoiceAllocFailures]);
+		break;
+	case AL_BUFFER_BYTES_NGS:
+		*value = _alAtomicLoad64(&g_counters[Counter_BufferBytes]);
+		break;
+	default:
+		return AL_FALSE;
+	}
+
+	return AL_TRUE;
+}
@@ -0,0 +1,123 @@
+#ifndef AL_COUNTERS_H
+#define AL_COUNTERS_H
+
+#include <stdint.h>
+
+#include "AL/al.h"
+#include "platform.h"
+
+namespace al {
+
+	// Process wide, every context and thread adds into the same slots. Times are microseconds
+	enum Counter
+	{
+		Counter_TickCount,
+		Counter_TickTime,
+		Counter_TickTimeMin,
+		Counter_TickTimeMax,
+		Counter_TickSources,
+		Counter_SystemUpdateCount,
+		Counter_SystemUpdateTime,
+		Counter_SystemUpdateTimeMax,
+		Counter_OutputBlockTime,
+		Counter_Underruns,
+		Counter_LockRetries,
+		Counter_ActiveVoices,
+		Counter_VoiceAllocFailures,
+		Counter_BufferBytes,
+		Counter_Max
+	};
+
+	// Who waited on an NGS param lock, critical sites wait while the rest try once and defer
+	enum LockSite
+	{
+		LockSite_Api,
+		LockSite_Callback,
+		LockSite_Update,
+		LockSite_Ramp,
+		LockSite_Filter,
+		LockSite_Getter,
+		LockSite_Drain,
+		LockSite_Max
+	};
+
+	#define AL_COUNTER_NO_SAMPLE		INT64_MAX
+
+	#define AL_LOCK_RETRY_DELAY_US		(100)
+	#define AL_LOCK_MAX_WAIT_US			(100000)
+
+	// Bucket i counts acquisitions that took fewer than 2^i retries, the last one everything beyond
+	#define AL_LOCK_HISTOGRAM_BUCKETS	(8)
+
+	struct LockSiteStats
+	{
+		volatile int64_t calls;
+		volatile int64_t waitTime;
+		volatile int64_t deferred;
+		volatile int64_t timeouts;
+		volatile int64_t buckets[AL_LOCK_HISTOGRAM_BUCKETS];
+	};
+
+	// Located in counters.cpp
+	extern volatile int64_t g_counters[Counter_Max];
+	extern LockSiteStats g_lockStats[LockSite_Max];
+
+	ALboolean _alCounterGet(ALenum param, int64_t *value);
+	ALint _alLockStatsGet(ALenum param, int64_t *values);
+	ALvoid _alCounterLock(LockSite site, ALint retries, ALuint waitTime);
+
+	inline ALvoid _alCounterAdd(Counter counter, int64_t value)
+	{
+		_alAtomicAdd64(&g_counters[counter], value);
+	}
+
+	inline ALvoid _alCounterMax(Counter counter, int64_t value)
+	{
+		int64_t old = _alAtomicLoad64(&g_counters[counter]);
+
+		while (value > old)
+		{
+			int64_t seen = _alAtomicCompareAndSwap64(&g_counters[counter], old, value);
+			if (seen == old)
+			{
+				break;
+			}
+
+			old = seen;
+		}
+	}
+
+	inline ALvoid _alCounterLockDeferred(LockSite site)
+	{
+		_alAtomicAdd64(&g_lockStats[site].deferred, 1);
+	}
+
+	inline ALvoid _alCounterLockTimeout(LockSite site)
+	{
+		_alAtomicAdd64(&g_lockStats[site].timeouts, 1);
+	}
+
+	inline ALboolean _alLockSiteIsCritical(LockSite site)
+	{
+		return (site == LockSite_Api || site == LockSite_Callback) ? AL_TRUE : AL_FALSE;
+	}
+
+	// Minimum slots start at AL_COUNTER_NO_SAMPLE so a real zero is kept
+	inline ALvoid _alCounterMin(Counter counter, int64_t value)
+	{
+		int64_t old = _alAtomicLoad64(&g_counters[counter]);
+
+		while (value < old)
+		{
+			int64_t seen = _alAtomicCompareAndSwap64(&g_counters[counter], old, value);
+			if (seen == old)
+			{
+				break;
+			}
+
+			old = seen;
+		}
+	}
+}
+
+#endif
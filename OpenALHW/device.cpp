@@ -2,7 +2,10 @@
 #include <libsysmodule.h>
 #include <ngs.h>
 #include <audioin.h>
+#include <audioout.h>
 #include <string.h>
+#include <algorithm>
+#include <sce_atomic.h>
 
 #include "common.h"
 #include "device.h"
@@ -12,8 +15,7 @@ using namespace al;
 Device::Device()
 	: m_magic(AL_INTERNAL_MAGIC),
 	m_isInitialized(AL_FALSE),
-	m_type(DeviceType_None),
-	m_ctx(NULL)
+	m_type(DeviceType_None)
 {
 
 }
@@ -41,11 +43,6 @@ DeviceType Device::getType()
 	return m_type;
 }
 
-Context *Device::getContext()
-{
-	return m_ctx;
-}
-
 ALCboolean DeviceNGS::validate(ALCdevice *device)
 {
 	DeviceNGS *dev = NULL;
@@ -65,23 +62,40 @@ ALCboolean DeviceNGS::validate(ALCdevice *device)
 	return ALC_TRUE;
 }
 
-DeviceNGS::DeviceNGS()
-	: m_maxMonoVoices(k_maxMonoChannels),
-	m_maxStereoVoices(k_maxStereoChannels),
-	m_outputThreadAffinity(SCE_KERNEL_CPU_MASK_USER_2),
-	m_updateThreadAffinity(SCE_KERNEL_CPU_MASK_USER_1)
+DeviceNGS::DeviceNGS(DeviceOutput output)
+	: m_outputThreadAffinity(SCE_KERNEL_CPU_MASK_USER_2),
+	m_updateThreadAffinity(SCE_KERNEL_CPU_MASK_USER_1),
+	m_paused(ALC_FALSE),
+	m_output(output),
+	m_paced(ALC_TRUE)
 {
 	m_type = DeviceType_NGS;
+
+	// Contexts that do not ask for more get the original pool, the ceiling is only paid for on request
+	m_defaults.maxMonoVoices = k_defaultMonoChannels;
+	m_defaults.maxStereoVoices = k_defaultStereoChannels;
+	m_defaults.refreshRate = 1000000 / NGS_UPDATE_INTERVAL_US;
+	m_defaults.granularity = NGS_SYSTEM_GRANULARITY;
+	m_defaults.outputBuffers = NGS_DEFAULT_OUTPUT_BUFFERS;
+	m_defaults.softwareMixer = ALC_FALSE;
+	m_defaults.renderSystems = 1;
+
+	sceKernelCreateLwMutex(&m_bufferLock, "OpenALHW::BufMtx", 0, 0, NULL);
 }
 
 DeviceNGS::~DeviceNGS()
 {
-	destroyContext();
+	destroyAllContexts();
+
+	sceKernelDeleteLwMutex(&m_bufferLock);
 }
 
 ALCboolean DeviceNGS::validateAttributes(const ALCint* attrlist)
 {
 	ALCint currAttr = *attrlist;
+	ALCint frequency = 0;
+	ALCenum channels = 0;
+	ALCenum type = 0;
 
 	while (currAttr != 0)
 	{
@@ -106,29 +120,122 @@ ALCboolean DeviceNGS::validateAttributes(const ALCint* attrlist)
 				return ALC_FALSE;
 			}
 			break;
+		case ALC_REFRESH:
+			if (*attrlist <= 0 || *attrlist > NGS_MAX_REFRESH)
+			{
+				return ALC_FALSE;
+			}
+			break;
+		case ALC_GRANULARITY_NGS:
+			if (*attrlist < NGS_MIN_GRANULARITY || *attrlist > NGS_MAX_GRANULARITY || (*attrlist % NGS_MIN_GRANULARITY) != 0)
+			{
+				return ALC_FALSE;
+			}
+			break;
+		case ALC_OUTPUT_BUFFERS_NGS:
+			if (*attrlist < NGS_MIN_OUTPUT_BUFFERS || *attrlist > NGS_MAX_OUTPUT_BUFFERS)
+			{
+				return ALC_FALSE;
+			}
+			break;
+		case ALC_FREQUENCY:
+			frequency = *attrlist;
+			break;
+		case ALC_FORMAT_CHANNELS_SOFT:
+			channels = *attrlist;
+			break;
+		case ALC_FORMAT_TYPE_SOFT:
+			type = *attrlist;
+			break;
+		case ALC_NULL_PACED_NGS:
+			if (m_output != DeviceOutput_Null || (*attrlist != ALC_FALSE && *attrlist != ALC_TRUE))
+			{
+				return ALC_FALSE;
+			}
+			break;
+		case ALC_SOFTWARE_MIXER_NGS:
+			if (*attrlist != ALC_FALSE && *attrlist != ALC_TRUE)
+			{
+				return ALC_FALSE;
+			}
+			break;
+		case ALC_RENDER_SYSTEMS_NGS:
+			if (*attrlist < 1 || *attrlist > NGS_MAX_RENDER_SYSTEMS)
+			{
+				return ALC_FALSE;
+			}
+			break;
 		}
 
 		attrlist += 1;
 		currAttr = *attrlist;
 	}
 
+	// Loopback contexts must spell out the format they render in
+	if (m_output == DeviceOutput_Loopback && !isRenderFormatSupported(frequency, channels, type))
+	{
+		return ALC_FALSE;
+	}
+
 	return ALC_TRUE;
 }
 
+// Only the attributes that belong to the device itself, the rest go through applyAttributes()
 ALCvoid DeviceNGS::setAttributes(const ALCint* attrlist)
 {
 	ALCint currAttr = *attrlist;
 
+	while (currAttr != 0)
+	{
+		attrlist += 1;
+
+		switch (currAttr) {
+		case ALC_NULL_PACED_NGS:
+			m_paced = *attrlist;
+			break;
+		}
+
+		attrlist += 1;
+		currAttr = *attrlist;
+	}
+}
+
+ALCvoid DeviceNGS::applyAttributes(const ALCint* attrlist, ContextAttributes *pAttrs)
+{
+	ALCint currAttr = 0;
+
+	if (attrlist == NULL)
+	{
+		return;
+	}
+
+	currAttr = *attrlist;
+
 	while (currAttr != 0)
 	{
 		attrlist += 1;
 
 		switch (currAttr) {
 		case ALC_MONO_SOURCES:
-			m_maxMonoVoices = *attrlist;
+			pAttrs->maxMonoVoices = *attrlist;
 			break;
 		case ALC_STEREO_SOURCES:
-			m_maxStereoVoices = *attrlist;
+			pAttrs->maxStereoVoices = *attrlist;
+			break;
+		case ALC_REFRESH:
+			pAttrs->refreshRate = *attrlist;
+			break;
+		case ALC_GRANULARITY_NGS:
+			pAttrs->granularity = *attrlist;
+			break;
+		case ALC_OUTPUT_BUFFERS_NGS:
+			pAttrs->outputBuffers = *attrlist;
+			break;
+		case ALC_SOFTWARE_MIXER_NGS:
+			pAttrs->softwareMixer = *attrlist;
+			break;
+		case ALC_RENDER_SYSTEMS_NGS:
+			pAttrs->renderSystems = *attrlist;
 			break;
 		}
 
@@ -137,11 +244,13 @@ ALCvoid DeviceNGS::setAttributes(const ALCint* attrlist)
 	}
 }
 
-ALCint DeviceNGS::createContext()
+ALCint DeviceNGS::createContext(const ALCint* attrlist, Context **ppContext)
 {
 	SceInt32 ret = SCE_OK;
+	Context *ctx = NULL;
+	ContextAttributes attrs = m_defaults;
 
-	if (sceSysmoduleIsLoaded(SCE_SYSMODULE_NGS))
+	if (m_isInitialized == ALC_FALSE && sceSysmoduleIsLoaded(SCE_SYSMODULE_NGS))
 	{
 		ret = sceSysmoduleLoadModule(SCE_SYSMODULE_NGS);
 		if (ret != SCE_OK)
@@ -150,66 +259,217 @@ ALCint DeviceNGS::createContext()
 		}
 	}
 
-	m_ctx = new Context(this);
+	// The first context gets the main port, later ones mix in through voice ports
+	applyAttributes(attrlist, &attrs);
+
+	ctx = new Context(this, m_contexts.empty() ? SCE_AUDIO_OUT_PORT_TYPE_MAIN : SCE_AUDIO_OUT_PORT_TYPE_VOICE, &attrs);
+
+	ret = ctx->init();
+	if (ret != ALC_NO_ERROR)
+	{
+		delete ctx;
+		return ret;
+	}
+
+	m_contexts.push_back(ctx);
 
 	m_isInitialized = ALC_TRUE;
-	
+
+	*ppContext = ctx;
+
 	return ALC_NO_ERROR;
 }
 
-ALCvoid DeviceNGS::destroyContext()
+ALCint DeviceNGS::reset(const ALCint* attrlist)
 {
-	if (m_ctx != NULL)
+	ContextAttributes attrs;
+	size_t prepared = 0;
+	ALCint ret = ALC_NO_ERROR;
+
+	if (attrlist != NULL && !validateAttributes(attrlist))
+	{
+		return ALC_INVALID_VALUE;
+	}
+
+	// Every context builds its new system first, so one failure leaves the whole device as it was
+	for (prepared = 0; prepared < m_contexts.size(); prepared++)
+	{
+		// Attributes not named in the list keep the value the context was created or last reset with
+		attrs = *m_contexts[prepared]->getAttributes();
+		applyAttributes(attrlist, &attrs);
+
+		ret = m_contexts[prepared]->prepareReset(&attrs);
+		if (ret != ALC_NO_ERROR)
+		{
+			break;
+		}
+	}
+
+	if (ret != ALC_NO_ERROR)
+	{
+		for (size_t i = 0; i < prepared; i++)
+		{
+			m_contexts[i]->abortReset();
+		}
+
+		return ret;
+	}
+
+	if (attrlist != NULL)
+	{
+		setAttributes(attrlist);
+	}
+
+	for (Context *ctx : m_contexts)
 	{
-		delete m_ctx;
+		ctx->commitReset();
 	}
 
-	if (m_isInitialized == AL_TRUE)
+	return ALC_NO_ERROR;
+}
+
+ALCvoid DeviceNGS::destroyContext(Context *ctx)
+{
+	m_contexts.erase(std::remove(m_contexts.begin(), m_contexts.end(), ctx), m_contexts.end());
+
+	delete ctx;
+
+	if (m_contexts.empty() && m_isInitialized == AL_TRUE)
 	{
 		if (!sceSysmoduleIsLoaded(SCE_SYSMODULE_NGS))
 		{
 			sceSysmoduleUnloadModule(SCE_SYSMODULE_NGS);
 		}
+
+		m_isInitialized = ALC_FALSE;
 	}
+}
 
-	m_isInitialized = ALC_FALSE;
+ALCvoid DeviceNGS::destroyAllContexts()
+{
+	while (!m_contexts.empty())
+	{
+		destroyContext(m_contexts.back());
+	}
+}
+
+Context *DeviceNGS::getContext()
+{
+	if (m_contexts.empty())
+	{
+		return NULL;
+	}
+
+	return m_contexts.front();
+}
+
+ALCboolean DeviceNGS::ownsContext(Context *ctx)
+{
+	if (std::find(m_contexts.begin(), m_contexts.end(), ctx) != m_contexts.end())
+	{
+		return ALC_TRUE;
+	}
+
+	return ALC_FALSE;
+}
+
+Buffer *DeviceNGS::findBuffer(const ALvoid *pStorage)
+{
+	Buffer *ret = NULL;
+
+	lockBuffers();
+
+	for (Buffer *buf : m_bufferStack)
+	{
+		if (buf->m_storage == pStorage)
+		{
+			ret = buf;
+			break;
+		}
+	}
+
+	unlockBuffers();
+
+	return ret;
+}
+
+ALCvoid DeviceNGS::lockBuffers()
+{
+	sceKernelLockLwMutex(&m_bufferLock, 1, NULL);
+}
+
+ALCvoid DeviceNGS::unlockBuffers()
+{
+	sceKernelUnlockLwMutex(&m_bufferLock, 1);
 }
 
 const ALCchar *DeviceNGS::getExtensionList()
 {
-	return "ALC_NGS_THREAD_AFFINITY";
+	return "ALC_NGS_THREAD_AFFINITY "
+		"ALC_NGS_OUTPUT_LATENCY "
+		"ALC_SOFT_loopback "
+		"ALC_SOFT_pause_device "
+		"ALC_NGS_NULL_DEVICE "
+		"ALC_NGS_SOFTWARE_MIXER "
+		"ALC_NGS_RENDER_SYSTEMS "
+		"AL_NGS_POSITION_EXTRAPOLATION "
+		"AL_NGS_VELOCITY_FROM_POSITION";
 }
 
 const ALCchar *DeviceNGS::getName()
 {
+	if (m_output == DeviceOutput_Null)
+	{
+		return AL_NULL_DEVICE_NAME;
+	}
+
 	return AL_DEVICE_NAME;
 }
 
 ALCint DeviceNGS::getAttributeCount()
 {
-	return 5;
+	return 9;
 }
 
 ALCint DeviceNGS::getAttribute(ALCenum attr)
 {
+	const ContextAttributes *pAttrs = &m_defaults;
 	ALCint ret = -1000;
 
+	// Context attributes are reported for the first context, or the defaults while there is none
+	if (!m_contexts.empty())
+	{
+		pAttrs = m_contexts.front()->getAttributes();
+	}
+
 	switch (attr) {
 	case ALC_FREQUENCY:
 		ret = m_samplingFrequency;
 		break;
 	case ALC_MONO_SOURCES:
-		ret = m_maxMonoVoices;
+		ret = pAttrs->maxMonoVoices;
 		break;
 	case ALC_REFRESH:
-		ret = m_refreshRate;
+		ret = pAttrs->refreshRate;
 		break;
 	case ALC_STEREO_SOURCES:
-		ret = m_maxStereoVoices;
+		ret = pAttrs->maxStereoVoices;
 		break;
 	case ALC_SYNC:
 		ret = m_sync;
 		break;
+	case ALC_GRANULARITY_NGS:
+		ret = pAttrs->granularity;
+		break;
+	case ALC_OUTPUT_BUFFERS_NGS:
+		ret = pAttrs->outputBuffers;
+		break;
+	case ALC_SOFTWARE_MIXER_NGS:
+		ret = pAttrs->softwareMixer;
+		break;
+	case ALC_RENDER_SYSTEMS_NGS:
+		ret = pAttrs->renderSystems;
+		break;
 	}
 
 	return ret;
@@ -231,19 +491,55 @@ ALCuint DeviceNGS::getUpdateThreadAffinity()
 	return m_updateThreadAffinity;
 }
 
-ALCint DeviceNGS::getMaxMonoVoiceCount()
+ALCint DeviceNGS::getSamplingFrequency()
 {
-	return m_maxMonoVoices;
+	return m_samplingFrequency;
 }
 
-ALCint DeviceNGS::getMaxStereoVoiceCount()
+ALCvoid DeviceNGS::pause()
 {
-	return m_maxStereoVoices;
+	m_paused = ALC_TRUE;
+
+	for (Context *ctx : m_contexts)
+	{
+		ctx->pauseOutput();
+	}
 }
 
-ALCint DeviceNGS::getSamplingFrequency()
+ALCvoid DeviceNGS::resume()
 {
-	return m_samplingFrequency;
+	m_paused = ALC_FALSE;
+
+	for (Context *ctx : m_contexts)
+	{
+		ctx->resumeOutput();
+	}
+}
+
+ALCboolean DeviceNGS::isPaused()
+{
+	return m_paused;
+}
+
+DeviceOutput DeviceNGS::getOutputMode()
+{
+	return m_output;
+}
+
+ALCboolean DeviceNGS::isPaced()
+{
+	return m_paced;
+}
+
+ALCboolean DeviceNGS::isRenderFormatSupported(ALCsizei frequency, ALCenum channels, ALCenum type)
+{
+	// The master buss always mixes to 16-bit stereo at the system rate
+	if (frequency != m_samplingFrequency || channels != ALC_STEREO_SOFT || type != ALC_SHORT_SOFT)
+	{
+		return ALC_FALSE;
+	}
+
+	return ALC_TRUE;
 }
 
 ALCboolean DeviceAudioIn::validate(ALCdevice *device)
@@ -267,8 +563,30 @@ ALCboolean DeviceAudioIn::validate(ALCdevice *device)
 
 DeviceAudioIn::DeviceAudioIn()
 	: m_samplingFrequency(48000),
+	m_format(AL_FORMAT_MONO16),
+	m_channels(1),
+	m_sampleType(SampleType_S16),
+	m_frameBytes(sizeof(int16_t)),
 	m_buffersize(768 * sizeof(int16_t)),
-	m_port(-1)
+	m_portFrequency(48000),
+	m_grain(768),
+	m_port(-1),
+	m_buffer(NULL),
+	m_quality(ResamplerQuality_Linear),
+	m_floatIn(NULL),
+	m_floatOut(NULL),
+	m_convBuffer(NULL),
+	m_convFrames(0),
+	m_convertTime(0),
+	m_convertedFrames(0),
+	m_ring(NULL),
+	m_ringFrames(0),
+	m_writePos(0),
+	m_readPos(0),
+	m_captureThread(SCE_UID_INVALID_UID),
+	m_captureActive(ALC_FALSE),
+	m_sliceFrames(0),
+	m_monitored(ALC_FALSE)
 {
 	m_type = DeviceType_AudioIn;
 }
@@ -280,22 +598,21 @@ DeviceAudioIn::~DeviceAudioIn()
 
 ALCboolean DeviceAudioIn::validateAttributes(ALCuint frequency, ALCenum format, ALCsizei buffersize)
 {
-	if (frequency != 16000 && frequency != 48000)
-	{
-		return ALC_FALSE;
-	}
+	ALint channels = 0;
+	SampleType type = SampleType_S16;
 
-	if (format != AL_FORMAT_MONO16)
+	if (frequency == 0 || frequency > AL_MAX_CAPTURE_FREQUENCY)
 	{
 		return ALC_FALSE;
 	}
 
-	if (frequency == 16000 && buffersize != 256 * sizeof(int16_t))
+	if (!_alFormatInfo(format, &channels, &type))
 	{
 		return ALC_FALSE;
 	}
 
-	if (frequency == 48000 && buffersize != 768 * sizeof(int16_t))
+	// buffersize is the ring capacity in frames of the requested format
+	if (buffersize <= 0)
 	{
 		return ALC_FALSE;
 	}
@@ -306,14 +623,113 @@ ALCboolean DeviceAudioIn::validateAttributes(ALCuint frequency, ALCenum format,
 ALCvoid DeviceAudioIn::setAttributes(ALCuint frequency, ALCenum format, ALCsizei buffersize)
 {
 	m_samplingFrequency = frequency;
+	m_format = format;
 	m_buffersize = buffersize;
+
+	_alFormatInfo(format, &m_channels, &m_sampleType);
+	m_frameBytes = m_channels * _alSampleTypeSize(m_sampleType);
+
+	// The port only runs at these two rates, 16 kHz is used as is and everything else comes from 48 kHz
+	m_portFrequency = (frequency == 16000) ? 16000 : 48000;
+	m_grain = (m_portFrequency == 16000) ? 256 : 768;
+}
+
+ALCvoid DeviceAudioIn::convertGrain()
+{
+	SceUInt64 startTime = sceKernelGetProcessTimeWide();
+	const float32_t *src = m_floatIn;
+
+	_alConvertS16ToFloat(m_floatIn, m_buffer, m_grain);
+
+	m_convFrames = m_grain;
+
+	if (m_samplingFrequency != (ALCuint)m_portFrequency)
+	{
+		m_resampler.setQuality(m_quality);
+		m_convFrames = m_resampler.process(m_floatIn, m_grain, m_floatOut);
+		src = m_floatOut;
+	}
+
+	_alConvertFromFloat(m_convBuffer, src, m_convFrames, m_channels, m_sampleType);
+
+	m_convertTime += sceKernelGetProcessTimeWide() - startTime;
+	m_convertedFrames += m_grain;
+}
+
+SceInt32 DeviceAudioIn::captureThread(SceSize argSize, void *pArgBlock)
+{
+	DeviceAudioIn *dev = *(DeviceAudioIn **)pArgBlock;
+	uint32_t writePos = 0;
+	uint32_t readPos = 0;
+	ALCint offset = 0;
+	ALCint first = 0;
+
+	while ((volatile ALCboolean)dev->m_captureActive)
+	{
+		// Blocks for one grain, only this thread ever waits on the port
+		if (sceAudioInInput(dev->m_port, dev->m_buffer) != SCE_OK)
+		{
+			break;
+		}
+
+		// Convert even when the ring is full so the resampler stays continuous
+		dev->convertGrain();
+
+		writePos = (uint32_t)dev->m_writePos;
+		readPos = (uint32_t)sceAtomicLoad32AcqRel(&dev->m_readPos);
+
+		// The read side belongs to the consumer, so a full ring drops the new grain instead
+		if (writePos - readPos + dev->m_convFrames > (uint32_t)dev->m_ringFrames)
+		{
+			continue;
+		}
+
+		offset = (ALCint)(writePos & (dev->m_ringFrames - 1));
+		first = std::min(dev->m_convFrames, dev->m_ringFrames - offset);
+
+		memcpy(dev->m_ring + offset * dev->m_frameBytes, dev->m_convBuffer, first * dev->m_frameBytes);
+		memcpy(dev->m_ring, dev->m_convBuffer + first * dev->m_frameBytes, (dev->m_convFrames - first) * dev->m_frameBytes);
+
+		sceAtomicStore32AcqRel(&dev->m_writePos, (int32_t)(writePos + dev->m_convFrames));
+	}
+
+	_alTraceThreadExit();
+
+	return sceKernelExitDeleteThread(0);
 }
 
 ALCboolean DeviceAudioIn::start()
 {
-	m_port = sceAudioInOpenPort(SCE_AUDIO_IN_PORT_TYPE_RAW, m_buffersize / sizeof(int16_t), m_samplingFrequency, SCE_AUDIO_IN_PARAM_FORMAT_S16_MONO);
+	SceInt32 ret = SCE_OK;
+	DeviceAudioIn *argptr = this;
+
+	if (m_port >= 0)
+	{
+		return ALC_TRUE;
+	}
+
+	m_port = sceAudioInOpenPort(SCE_AUDIO_IN_PORT_TYPE_RAW, m_grain, m_portFrequency, SCE_AUDIO_IN_PARAM_FORMAT_S16_MONO);
 	if (m_port <= 0)
 	{
+		m_port = -1;
+		return ALC_FALSE;
+	}
+
+	m_captureActive = ALC_TRUE;
+
+	m_captureThread = sceKernelCreateThread("OpenALHW::Capture", captureThread, SCE_KERNEL_HIGHEST_PRIORITY_USER + 1, SCE_KERNEL_4KiB, 0, SCE_KERNEL_THREAD_CPU_AFFINITY_MASK_DEFAULT, NULL);
+	if (m_captureThread <= 0)
+	{
+		stop();
+		return ALC_FALSE;
+	}
+
+	ret = sceKernelStartThread(m_captureThread, sizeof(DeviceAudioIn **), &argptr);
+	if (ret != SCE_OK)
+	{
+		sceKernelDeleteThread(m_captureThread);
+		m_captureThread = SCE_UID_INVALID_UID;
+		stop();
 		return ALC_FALSE;
 	}
 
@@ -324,6 +740,20 @@ ALCboolean DeviceAudioIn::stop()
 {
 	int ret = 0;
 
+	if (m_port < 0)
+	{
+		return ALC_TRUE;
+	}
+
+	m_captureActive = ALC_FALSE;
+
+	// The thread notices within one grain, captured frames stay readable after stopping
+	if (m_captureThread > 0)
+	{
+		sceKernelWaitThreadEnd(m_captureThread, NULL, NULL);
+		m_captureThread = SCE_UID_INVALID_UID;
+	}
+
 	ret = sceAudioInReleasePort(m_port);
 	if (ret != SCE_OK)
 	{
@@ -337,44 +767,210 @@ ALCboolean DeviceAudioIn::stop()
 
 ALCboolean DeviceAudioIn::captureSamples(ALCvoid *buffer, ALCsizei samples)
 {
-	int ret = 0;
-	ALCsizei byteSize = samples * sizeof(int16_t);
+	uint32_t readPos = (uint32_t)m_readPos;
+	uint32_t writePos = (uint32_t)sceAtomicLoad32AcqRel(&m_writePos);
+	ALCint offset = 0;
+	ALCint first = 0;
 
-	if (byteSize > m_buffersize)
+	if (m_monitored == ALC_TRUE)
 	{
 		return ALC_FALSE;
 	}
 
-	ret = sceAudioInInput(m_port, m_buffer);
-	if (ret != SCE_OK)
+	if (samples < 0 || (uint32_t)samples > writePos - readPos)
+	{
+		return ALC_FALSE;
+	}
+
+	offset = (ALCint)(readPos & (m_ringFrames - 1));
+	first = std::min((ALCint)samples, m_ringFrames - offset);
+
+	memcpy(buffer, m_ring + offset * m_frameBytes, first * m_frameBytes);
+	memcpy((uint8_t *)buffer + first * m_frameBytes, m_ring, (samples - first) * m_frameBytes);
+
+	sceAtomicStore32AcqRel(&m_readPos, (int32_t)(readPos + samples));
+
+	return ALC_TRUE;
+}
+
+ALCint DeviceAudioIn::getAvailableSamples()
+{
+	return (ALCint)((uint32_t)sceAtomicLoad32AcqRel(&m_writePos) - (uint32_t)sceAtomicLoad32AcqRel(&m_readPos));
+}
+
+ALCvoid DeviceAudioIn::setResamplerQuality(ResamplerQuality quality)
+{
+	m_quality = quality;
+}
+
+ALCint DeviceAudioIn::getConversionCost()
+{
+	// Microseconds of capture thread time spent converting per second of captured audio
+	if (m_convertedFrames == 0)
+	{
+		return 0;
+	}
+
+	return (ALCint)(m_convertTime * m_portFrequency / m_convertedFrames);
+}
+
+ALCboolean DeviceAudioIn::beginMonitor()
+{
+	// The player only takes 16-bit PCM, other formats still need a copy through alcCaptureSamples
+	if (m_isInitialized != ALC_TRUE || m_sampleType != SampleType_S16 || m_monitored == ALC_TRUE)
 	{
 		return ALC_FALSE;
 	}
 
-	memcpy(buffer, m_buffer, byteSize);
+	m_monitored = ALC_TRUE;
 
 	return ALC_TRUE;
 }
 
+ALCvoid DeviceAudioIn::endMonitor()
+{
+	m_monitored = ALC_FALSE;
+}
+
+ALCboolean DeviceAudioIn::isMonitored()
+{
+	return m_monitored;
+}
+
+uint32_t DeviceAudioIn::syncMonitor()
+{
+	// Drop the backlog down to the newest slice boundary so monitoring starts with the least latency
+	uint32_t pos = (uint32_t)sceAtomicLoad32AcqRel(&m_writePos) & ~(uint32_t)(m_sliceFrames - 1);
+
+	sceAtomicStore32AcqRel(&m_readPos, (int32_t)pos);
+
+	return pos;
+}
+
+const ALCvoid *DeviceAudioIn::peekSlice(uint32_t pos)
+{
+	if ((uint32_t)sceAtomicLoad32AcqRel(&m_writePos) - pos < (uint32_t)m_sliceFrames)
+	{
+		return NULL;
+	}
+
+	return m_ring + (pos & (m_ringFrames - 1)) * m_frameBytes;
+}
+
+ALCvoid DeviceAudioIn::releaseSlice()
+{
+	// Only called once the player is done with the oldest slice, so the capture thread may overwrite it
+	sceAtomicAdd32AcqRel(&m_readPos, m_sliceFrames);
+}
+
+ALCint DeviceAudioIn::getSliceFrames()
+{
+	return m_sliceFrames;
+}
+
+ALCuint DeviceAudioIn::getFrequency()
+{
+	return m_samplingFrequency;
+}
+
+ALCint DeviceAudioIn::getChannels()
+{
+	return m_channels;
+}
+
 ALCint DeviceAudioIn::createContext()
 {
-	m_buffer = AL_MALLOC(m_buffersize);
-	if (!m_buffer)
+	ALCint maxOut = m_grain;
+
+	m_buffer = (int16_t *)AL_MALLOC(m_grain * sizeof(int16_t));
+	m_floatIn = (float32_t *)AL_MALLOC(m_grain * sizeof(float32_t));
+	if (!m_buffer || !m_floatIn)
 	{
+		destroyBuffers();
 		return ALC_OUT_OF_MEMORY;
 	}
 
+	if (m_samplingFrequency != (ALCuint)m_portFrequency)
+	{
+		if (m_resampler.init(m_portFrequency, m_samplingFrequency, m_grain) != AL_NO_ERROR)
+		{
+			destroyBuffers();
+			return ALC_OUT_OF_MEMORY;
+		}
+
+		maxOut = m_resampler.getMaxOutput(m_grain);
+
+		m_floatOut = (float32_t *)AL_MALLOC(maxOut * sizeof(float32_t));
+		if (!m_floatOut)
+		{
+			destroyBuffers();
+			return ALC_OUT_OF_MEMORY;
+		}
+	}
+
+	m_convBuffer = (uint8_t *)AL_MALLOC(maxOut * m_frameBytes);
+	if (!m_convBuffer)
+	{
+		destroyBuffers();
+		return ALC_OUT_OF_MEMORY;
+	}
+
+	m_sliceFrames = 1;
+	while (m_sliceFrames * 2 <= maxOut)
+	{
+		m_sliceFrames <<= 1;
+	}
+
+	// Power of two so positions can wrap freely, with room for a grain beyond what was asked for
+	m_ringFrames = 1;
+	while (m_ringFrames < m_buffersize + maxOut || m_ringFrames < m_sliceFrames * AL_CAPTURE_MONITOR_SLICES)
+	{
+		m_ringFrames <<= 1;
+	}
+
+	m_ring = (uint8_t *)AL_MALLOC(m_ringFrames * m_frameBytes);
+	if (!m_ring)
+	{
+		destroyBuffers();
+		return ALC_OUT_OF_MEMORY;
+	}
+
+	m_writePos = 0;
+	m_readPos = 0;
+	m_convertTime = 0;
+	m_convertedFrames = 0;
+
 	m_isInitialized = ALC_TRUE;
 
 	return ALC_NO_ERROR;
 }
 
+ALCvoid DeviceAudioIn::destroyBuffers()
+{
+	if (m_buffer)
+		AL_FREE(m_buffer);
+	if (m_floatIn)
+		AL_FREE(m_floatIn);
+	if (m_floatOut)
+		AL_FREE(m_floatOut);
+	if (m_convBuffer)
+		AL_FREE(m_convBuffer);
+	if (m_ring)
+		AL_FREE(m_ring);
+
+	m_buffer = NULL;
+	m_floatIn = NULL;
+	m_floatOut = NULL;
+	m_convBuffer = NULL;
+	m_ring = NULL;
+}
+
 ALCvoid DeviceAudioIn::destroyContext()
 {
 	if (m_isInitialized == ALC_TRUE)
 	{
 		stop();
-		AL_FREE(m_buffer);
+		destroyBuffers();
 	}
 
 	m_isInitialized = ALC_FALSE;
@@ -382,7 +978,7 @@ ALCvoid DeviceAudioIn::destroyContext()
 
 const ALCchar *DeviceAudioIn::getExtensionList()
 {
-	return "";
+	return "ALC_NGS_CAPTURE_CONVERSION";
 }
 
 const ALCchar *DeviceAudioIn::getName()
@@ -1,6 +1,7 @@
 #include "AL/al.h"
 #include "AL/alc.h"
 #include "context.h"
+#include "resampler.h"
 
 #ifndef AL_DEVICE_H
 #define AL_DEVICE_H
@@ -14,6 +15,13 @@ namespace al {
 		DeviceType_AudioIn = AL_INTERNAL_MAGIC - 6
 	};
 
+	enum DeviceOutput
+	{
+		DeviceOutput_Port,
+		DeviceOutput_Loopback,
+		DeviceOutput_Null
+	};
+
 	class Device
 	{
 	public:
@@ -21,8 +29,6 @@ namespace al {
 		Device();
 		virtual ~Device();
 
-		virtual ALCint createContext() =0;
-		virtual ALCvoid destroyContext() =0;
 		virtual const ALCchar *getExtensionList() =0;
 		virtual const ALCchar *getName() =0;
 		virtual ALCint getAttributeCount() =0;
@@ -31,14 +37,12 @@ namespace al {
 		ALCboolean isValid();
 		ALCboolean isInitialized();
 		DeviceType getType();
-		Context *getContext();
 
 	protected:
 
 		ALCint m_magic;
 		DeviceType m_type;
 		ALCboolean m_isInitialized;
-		Context *m_ctx;
 	};
 
 	class DeviceAudioIn : public Device
@@ -62,14 +66,60 @@ namespace al {
 		ALCboolean start();
 		ALCboolean stop();
 		ALCboolean captureSamples(ALCvoid *buffer, ALCsizei samples);
+		ALCint getAvailableSamples();
+		ALCvoid setResamplerQuality(ResamplerQuality quality);
+		ALCint getConversionCost();
+
+		// One source may play the ring in place, it then owns the read position instead of alcCaptureSamples
+		ALCboolean beginMonitor();
+		ALCvoid endMonitor();
+		ALCboolean isMonitored();
+		uint32_t syncMonitor();
+		const ALCvoid *peekSlice(uint32_t pos);
+		ALCvoid releaseSlice();
+		ALCint getSliceFrames();
+		ALCuint getFrequency();
+		ALCint getChannels();
 
 	private:
 
+		static SceInt32 captureThread(SceSize argSize, void *pArgBlock);
+
+		ALCvoid convertGrain();
+		ALCvoid destroyBuffers();
+
 		ALCuint m_samplingFrequency;
-		const ALCenum m_format = AL_FORMAT_MONO16;
+		ALCenum m_format;
+		ALCint m_channels;
+		SampleType m_sampleType;
+		ALCint m_frameBytes;
 		ALCsizei m_buffersize;
+		ALCint m_portFrequency;
+		ALCint m_grain;
 		ALCint m_port;
-		ALCvoid *m_buffer;
+		int16_t *m_buffer;
+
+		// Port grains go S16 -> float -> resampled float -> requested format on the capture thread
+		Resampler m_resampler;
+		volatile ResamplerQuality m_quality;
+		float32_t *m_floatIn;
+		float32_t *m_floatOut;
+		uint8_t *m_convBuffer;
+		ALCint m_convFrames;
+		SceUInt64 m_convertTime;
+		SceUInt64 m_convertedFrames;
+
+		// Single producer (capture thread) and single consumer (alcCaptureSamples), positions only ever grow
+		uint8_t *m_ring;
+		ALCint m_ringFrames;
+		volatile int32_t m_writePos;
+		volatile int32_t m_readPos;
+		SceUID m_captureThread;
+		volatile ALCboolean m_captureActive;
+
+		// Power of two no larger than a converted grain, so slices never straddle the end of the ring
+		ALCint m_sliceFrames;
+		volatile ALCboolean m_monitored;
 	};
 
 	class DeviceNGS : public Device
@@ -78,11 +128,17 @@ namespace al {
 
 		static ALCboolean validate(ALCdevice *device);
 
-		DeviceNGS();
+		DeviceNGS(DeviceOutput output);
 		~DeviceNGS();
 
-		ALCint createContext();
-		ALCvoid destroyContext();
+		ALCint createContext(const ALCint* attrlist, Context **ppContext);
+		ALCvoid destroyContext(Context *ctx);
+		ALCvoid destroyAllContexts();
+		Context *getContext();
+		ALCboolean ownsContext(Context *ctx);
+		Buffer *findBuffer(const ALvoid *pStorage);
+		ALCvoid lockBuffers();
+		ALCvoid unlockBuffers();
 		const ALCchar *getExtensionList();
 		const ALCchar *getName();
 		ALCint getAttributeCount();
@@ -90,25 +146,40 @@ namespace al {
 
 		ALCboolean validateAttributes(const ALCint* attrlist);
 		ALCvoid setAttributes(const ALCint* attrlist);
+		ALCvoid applyAttributes(const ALCint* attrlist, ContextAttributes *pAttrs);
+		ALCint reset(const ALCint* attrlist);
 		ALCvoid setThreadAffinity(ALCuint outputThreadAffinity, ALCuint updateThreadAffinity);
 		ALCuint getOutputThreadAffinity();
 		ALCuint getUpdateThreadAffinity();
-		ALCint getMaxMonoVoiceCount();
-		ALCint getMaxStereoVoiceCount();
 		ALCint getSamplingFrequency();
+		ALCvoid pause();
+		ALCvoid resume();
+		ALCboolean isPaused();
+		DeviceOutput getOutputMode();
+		ALCboolean isPaced();
+		ALCboolean isRenderFormatSupported(ALCsizei frequency, ALCenum channels, ALCenum type);
+
+		// Buffers are shared by every context on the device
+		std::vector<Buffer *> m_bufferStack;
 
 	private:
 
-		const ALCint k_maxMonoChannels = 64;
-		const ALCint k_maxStereoChannels = 64;
+		const ALCint k_maxMonoChannels = 256;
+		const ALCint k_maxStereoChannels = 256;
+		const ALCint k_defaultMonoChannels = 64;
+		const ALCint k_defaultStereoChannels = 64;
 
-		ALCint m_maxMonoVoices;
-		ALCint m_maxStereoVoices;
+		// What a context starts from before its own attribute list is applied
+		ContextAttributes m_defaults;
 		ALCuint m_outputThreadAffinity;
 		ALCuint m_updateThreadAffinity;
 		const ALCint m_samplingFrequency = 48000;
-		const ALCint m_refreshRate = 60;
+		ALCboolean m_paused;
+		DeviceOutput m_output;
+		ALCboolean m_paced;
 		const ALCint m_sync = 0;
+		std::vector<Context *> m_contexts;
+		SceKernelLwMutexWork m_bufferLock;
 	};
 }
 
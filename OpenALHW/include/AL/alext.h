@@ -8,6 +8,15 @@
 extern "C" {
 #endif
 
+/*
+*
+* AL_EXT_float32
+*
+*/
+
+#define AL_FORMAT_MONO_FLOAT32                   0x10010
+#define AL_FORMAT_STEREO_FLOAT32                 0x10011
+
 /*
 *
 * OpenAL-Soft
@@ -22,6 +31,42 @@ AL_API void AL_APIENTRY alProcessUpdatesSOFT(void);
 typedef void           (AL_APIENTRY *LPALDEFERUPDATESSOFT)(void);
 typedef void           (AL_APIENTRY *LPALPROCESSUPDATESSOFT)(void);
 
+#define ALC_FORMAT_CHANNELS_SOFT                 0x1990
+#define ALC_FORMAT_TYPE_SOFT                     0x1991
+
+#define ALC_BYTE_SOFT                            0x1400
+#define ALC_UNSIGNED_BYTE_SOFT                   0x1401
+#define ALC_SHORT_SOFT                           0x1402
+#define ALC_UNSIGNED_SHORT_SOFT                  0x1403
+#define ALC_INT_SOFT                             0x1404
+#define ALC_UNSIGNED_INT_SOFT                    0x1405
+#define ALC_FLOAT_SOFT                           0x1406
+
+#define ALC_MONO_SOFT                            0x1500
+#define ALC_STEREO_SOFT                          0x1501
+#define ALC_QUAD_SOFT                            0x1503
+#define ALC_5POINT1_SOFT                         0x1504
+#define ALC_6POINT1_SOFT                         0x1505
+#define ALC_7POINT1_SOFT                         0x1506
+
+ALC_API ALCdevice* ALC_APIENTRY alcLoopbackOpenDeviceSOFT(const ALCchar *deviceName);
+ALC_API ALCboolean ALC_APIENTRY alcIsRenderFormatSupportedSOFT(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type);
+ALC_API void ALC_APIENTRY alcRenderSamplesSOFT(ALCdevice *device, ALCvoid *buffer, ALCsizei samples);
+
+typedef ALCdevice*     (ALC_APIENTRY *LPALCLOOPBACKOPENDEVICESOFT)(const ALCchar *deviceName);
+typedef ALCboolean     (ALC_APIENTRY *LPALCISRENDERFORMATSUPPORTEDSOFT)(ALCdevice *device, ALCsizei freq, ALCenum channels, ALCenum type);
+typedef void           (ALC_APIENTRY *LPALCRENDERSAMPLESSOFT)(ALCdevice *device, ALCvoid *buffer, ALCsizei samples);
+
+ALC_API void ALC_APIENTRY alcDevicePauseSOFT(ALCdevice *device);
+ALC_API void ALC_APIENTRY alcDeviceResumeSOFT(ALCdevice *device);
+
+typedef void           (ALC_APIENTRY *LPALCDEVICEPAUSESOFT)(ALCdevice *device);
+typedef void           (ALC_APIENTRY *LPALCDEVICERESUMESOFT)(ALCdevice *device);
+
+ALC_API ALCboolean ALC_APIENTRY alcResetDeviceSOFT(ALCdevice *device, const ALCint *attribs);
+
+typedef ALCboolean     (ALC_APIENTRY *LPALCRESETDEVICESOFT)(ALCdevice *device, const ALCint *attribs);
+
 /*
 *
 * NGS
@@ -32,11 +77,70 @@ typedef void*(*AlMemoryAllocNGS)(size_t size);
 typedef void*(*AlMemoryAllocAlignNGS)(size_t align, size_t size);
 typedef void(*AlMemoryFreeNGS)(void *ptr);
 
+typedef long long ALint64NGS;
+
+#define AL_POSITION_EXTRAPOLATION_NGS            0xC100
+#define AL_VELOCITY_FROM_POSITION_NGS            0xC101
+#define AL_TRACE_NGS                             0xC102
+#define AL_TICK_COUNT_NGS                        0xC110
+#define AL_TICK_TIME_MIN_NGS                     0xC111
+#define AL_TICK_TIME_AVG_NGS                     0xC112
+#define AL_TICK_TIME_MAX_NGS                     0xC113
+#define AL_TICK_SOURCES_AVG_NGS                  0xC114
+#define AL_SYSTEM_UPDATE_TIME_AVG_NGS            0xC115
+#define AL_SYSTEM_UPDATE_TIME_MAX_NGS            0xC116
+#define AL_OUTPUT_BLOCK_TIME_NGS                 0xC117
+#define AL_UNDERRUN_COUNT_NGS                    0xC118
+#define AL_LOCK_RETRIES_NGS                      0xC119
+#define AL_ACTIVE_VOICES_NGS                     0xC11A
+#define AL_VOICE_ALLOC_FAILURES_NGS              0xC11B
+#define AL_BUFFER_BYTES_NGS                      0xC11C
+#define AL_LOCK_STATS_API_NGS                    0xC11D
+#define AL_LOCK_STATS_CALLBACK_NGS               0xC11E
+#define AL_LOCK_STATS_UPDATE_NGS                 0xC11F
+#define AL_LOCK_STATS_RAMP_NGS                   0xC120
+#define AL_LOCK_STATS_FILTER_NGS                 0xC121
+#define AL_LOCK_STATS_GETTER_NGS                 0xC122
+#define AL_LOCK_STATS_DRAIN_NGS                  0xC123
+
+#define ALC_GRANULARITY_NGS                      0xC200
+#define ALC_OUTPUT_BUFFERS_NGS                   0xC201
+#define ALC_OUTPUT_LATENCY_NGS                   0xC202
+#define ALC_UNDERRUN_COUNT_NGS                   0xC203
+#define ALC_MAX_RENDER_TIME_NGS                  0xC204
+#define ALC_MAX_OUTPUT_BLOCK_TIME_NGS            0xC205
+#define ALC_IDLE_TIME_NGS                        0xC206
+#define ALC_NULL_PACED_NGS                       0xC207
+#define ALC_GRANULES_PER_SECOND_NGS              0xC208
+#define ALC_SOFTWARE_MIXER_NGS                   0xC209
+#define ALC_RENDER_SYSTEMS_NGS                   0xC20A
+#define ALC_RACK_COUNT_NGS                       0xC20B
+#define ALC_VOICE_CAPACITY_NGS                   0xC20C
+#define ALC_FIRST_SAMPLE_LATENCY_NGS             0xC20D
+#define ALC_RESAMPLER_POINT_NGS                  0xC20E
+#define ALC_RESAMPLER_LINEAR_NGS                 0xC20F
+#define ALC_RESAMPLER_CUBIC_NGS                  0xC210
+#define ALC_CAPTURE_CONVERSION_COST_NGS          0xC211
+
 AL_API void AL_APIENTRY alcSetThreadAffinityNGS(ALCdevice *device, ALCuint outputThreadAffinity, ALCuint updateThreadAffinity);
 AL_API void AL_APIENTRY alcSetMemoryFunctionsNGS(AlMemoryAllocNGS alloc, AlMemoryAllocAlignNGS allocAlign, AlMemoryFreeNGS free);
+AL_API void AL_APIENTRY alcCaptureResamplerNGS(ALCdevice *device, ALCenum resampler);
+AL_API void AL_APIENTRY alSourceCaptureNGS(ALuint source, ALCdevice *device);
+AL_API void AL_APIENTRY alTraceDumpNGS(const ALchar *path);
+AL_API void AL_APIENTRY alRecordStartNGS(const ALchar *path);
+AL_API void AL_APIENTRY alRecordStopNGS(void);
+AL_API void AL_APIENTRY alGetInteger64vNGS(ALenum param, ALint64NGS *values);
+AL_API void AL_APIENTRY alGetSourcesivNGS(ALsizei ns, const ALuint *sids, ALenum param, ALint *values);
 
 typedef void           (AL_APIENTRY *LPALCSETTHREADAFFINITYNGS)( ALCdevice *device, ALCuint outputThreadAffinity, ALCuint updateThreadAffinity );
 typedef void           (AL_APIENTRY *LPALCSETMEMORYFUNCTIONSNGS)( AlMemoryAllocNGS alloc, AlMemoryAllocAlignNGS allocAlign, AlMemoryFreeNGS free );
+typedef void           (AL_APIENTRY *LPALCCAPTURERESAMPLERNGS)( ALCdevice *device, ALCenum resampler );
+typedef void           (AL_APIENTRY *LPALSOURCECAPTURENGS)( ALuint source, ALCdevice *device );
+typedef void           (AL_APIENTRY *LPALTRACEDUMPNGS)( const ALchar *path );
+typedef void           (AL_APIENTRY *LPALRECORDSTARTNGS)( const ALchar *path );
+typedef void           (AL_APIENTRY *LPALRECORDSTOPNGS)( void );
+typedef void           (AL_APIENTRY *LPALGETINTEGER64VNGS)( ALenum param, ALint64NGS *values );
+typedef void           (AL_APIENTRY *LPALGETSOURCESIVNGS)( ALsizei ns, const ALuint *sids, ALenum param, ALint *values );
 
 #if defined(__cplusplus)
 }
@@ -6,10 +6,13 @@
 #include <vector>
 
 #include "common.h"
+#include "panner.h"
+#include "backend.h"
 
 namespace al {
 
 	class Context;
+	class DeviceAudioIn;
 
 	enum ObjectType
 	{
@@ -100,7 +103,7 @@ namespace al {
 		ALint m_bits;
 		ALint m_channels;
 
-		ALint m_data;			// the useless one
+		intptr_t m_data;		// the useless one
 
 		ALint m_size;
 		ALvoid *m_storage;	// the actual one
@@ -111,6 +114,18 @@ namespace al {
 
 	};
 
+	// Playback state as of the last rendered granule, see Source::publishSnapshot
+	struct SourceSnapshot
+	{
+		ALint generation;
+		ALint state;
+		ALint samplesGenerated;
+		ALint bytesConsumed;
+		ALint curIdx;
+		ALint frequency;
+		ALint channels;
+	};
+
 	class Source : public NamedObject
 	{
 	public:
@@ -121,29 +136,41 @@ namespace al {
 		#define NGS_BUFFER_IDX_3		(8)
 
 		static ALboolean validate(Source *src);
-		static ALvoid streamCallback(const SceNgsCallbackInfo *pCallbackInfo);
+		static ALvoid streamCallback(Voice *pVoice, VoiceEvent event, ALint bufferIdx, ALvoid *pUserData);
+		static ALvoid captureCallback(Voice *pVoice, VoiceEvent event, ALint bufferIdx, ALvoid *pUserData);
 
 		Source(Context *ctx);
 		~Source();
 
 		ALint init();
 		ALint release();
+		ALint rebind(Voice *pVoice);
 		ALint dropAllBuffers();
 		ALint bqPush(ALint frequency, ALint channels, Buffer *buf);
 		ALint switchToStaticBuffer(ALint frequency, ALint channels, Buffer *buf);
 		ALvoid update();
+		ALvoid applyRamp();
 		ALvoid beginParamUpdate();
 		ALvoid endParamUpdate();
 		ALint processedBufferCount();
 		ALint queuedBufferCount();
 		ALint seek(ALfloat value, ALint type);
+		ALint bindCapture(DeviceAudioIn *dev);
+		ALint startCapture();
+		ALvoid stopCapture();
+		ALvoid publishSnapshot();
+		ALint readSnapshot(SourceSnapshot *pSnap);
+		ALvoid invalidateSnapshot();
+		ALint getPlaybackState();
+
+		Context *getContext()
+		{
+			return m_ctx;
+		}
 
-		SceNgsHVoice m_voice;
-		SceNgsHPatch m_patch;
+		Voice *m_voice;
 		SourceParams m_params;
 
-		ALint m_voiceIdx;
-
 		ALfloat m_minGain;
 		ALfloat m_maxGain;
 		ALboolean m_looping;
@@ -159,9 +186,49 @@ namespace al {
 		ALboolean m_afterSeek;
 		ALboolean m_paramsDirty;
 
+		// Position extrapolation from vVelocity between AL_POSITION sets
+		ALboolean m_extrapolate;
+		SceUInt64 m_positionTime;
+
+		// Velocity derived from successive AL_POSITION sets
+		MotionTracker m_motion;
+
+		// Gain/pitch ramp, advanced once per granule by the output thread
+		ALint m_outputChannels;
+		float32_t m_curVolume[2];
+		float32_t m_targetVolume[2];
+		float32_t m_curPitch;
+		float32_t m_targetPitch;
+		ALint m_rampSteps;
+		ALboolean m_rampSnap;
+
+		// Capture device whose ring slices are played in place of queued buffers
+		DeviceAudioIn *m_capture;
+		uint32_t m_captureNext;
+		volatile ALboolean m_captureRunning;
+		volatile ALboolean m_captureStalled;
+
 	private:
 
+		#define NGS_CAPTURE_PREBUFFER_SLICES	(2)
+		#define NGS_SNAPSHOT_READ_RETRIES		(4)
+
+		ALint setPatchVolumes(const float32_t *volumeMatrix);
+		ALint pushCaptureSlices();
+		ALvoid restartCapture();
+		ALint querySnapshot(SourceSnapshot *pSnap);
+
 		Context *m_ctx;
+
+		// Format of the bound buffers, kept here so publishing a snapshot never touches the player params
+		ALint m_frequency;
+		ALint m_channels;
+
+		// Seqlock, only the thread rendering granules writes and m_snapshotSeq is odd while it does.
+		// API calls that change playback bump m_snapshotGeneration, which retires the snapshot until the next granule
+		volatile int32_t m_snapshotSeq;
+		volatile int32_t m_snapshotGeneration;
+		SourceSnapshot m_snapshot;
 	};
 }
 
@@ -823,4 +823,104 @@ namespace al {
 
 		return nRet;
 	}
+
+	#define AL_MOTION_MIN_INTERVAL_US		(1000)
+	#define AL_MOTION_MAX_INTERVAL_US		(500000)
+	#define AL_MOTION_SMOOTHING_US			(100000)
+
+	MotionTracker::MotionTracker()
+		: m_enabled(AL_FALSE)
+	{
+		reset();
+	}
+
+	MotionTracker::~MotionTracker()
+	{
+	}
+
+	ALvoid MotionTracker::reset()
+	{
+		m_lastPosition.x = 0.0f;
+		m_lastPosition.y = 0.0f;
+		m_lastPosition.z = 0.0f;
+
+		m_velocity.x = 0.0f;
+		m_velocity.y = 0.0f;
+		m_velocity.z = 0.0f;
+
+		m_lastTime = 0;
+		m_hasLast = AL_FALSE;
+	}
+
+	ALint MotionTracker::track(SceFVector4 vPosition, SceUInt64 uTimeUs, float32_t fMaxSpeed, SceFVector4 *pVelocityOut)
+	{
+		ALint res = AL_NO_ERROR;
+		SceUInt64 interval = 0;
+		SceFVector4 instant = { 0.0f, 0.0f, 0.0f };
+		float32_t seconds = 0.0f;
+		float32_t speed = 0.0f;
+		float32_t blend = 0.0f;
+
+		res = isVectorFinite(vPosition);
+		if (res != AL_NO_ERROR)
+		{
+			return res;
+		}
+		if (pVelocityOut == NULL)
+		{
+			return AL_INVALID_VALUE;
+		}
+
+		if (m_hasLast == AL_TRUE)
+		{
+			interval = uTimeUs - m_lastTime;
+
+			/* Several sets within one game frame, wait for a measurable delta */
+			if (interval < AL_MOTION_MIN_INTERVAL_US)
+			{
+				*pVelocityOut = m_velocity;
+				return AL_NO_ERROR;
+			}
+
+			/* The emitter stalled or teleported, restart the estimate */
+			if (interval > AL_MOTION_MAX_INTERVAL_US)
+			{
+				m_velocity.x = 0.0f;
+				m_velocity.y = 0.0f;
+				m_velocity.z = 0.0f;
+			}
+			else
+			{
+				seconds = (float32_t)interval / 1000000.0f;
+
+				instant.x = (vPosition.x - m_lastPosition.x) / seconds;
+				instant.y = (vPosition.y - m_lastPosition.y) / seconds;
+				instant.z = (vPosition.z - m_lastPosition.z) / seconds;
+
+				/* Keep doppler finite, the shift diverges as the speed approaches the speed of sound */
+				speed = sqrtf(_dotProduct(instant, instant));
+				if (speed > fMaxSpeed && speed > 0.0f)
+				{
+					instant.x *= fMaxSpeed / speed;
+					instant.y *= fMaxSpeed / speed;
+					instant.z *= fMaxSpeed / speed;
+				}
+
+				/* One-pole smoothing, independent of the rate positions arrive at */
+				blend = (float32_t)interval / (float32_t)(interval + AL_MOTION_SMOOTHING_US);
+
+				m_velocity.x = _lerpf(m_velocity.x, instant.x, blend);
+				m_velocity.y = _lerpf(m_velocity.y, instant.y, blend);
+				m_velocity.z = _lerpf(m_velocity.z, instant.z, blend);
+			}
+		}
+
+		m_lastPosition = vPosition;
+		m_lastTime = uTimeUs;
+		m_hasLast = AL_TRUE;
+
+		*pVelocityOut = m_velocity;
+
+		return AL_NO_ERROR;
+	}
 }
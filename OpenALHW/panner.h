@@ -74,6 +74,26 @@ namespace al {
 		float32_t m_gain;
 		int32_t m_distanceModel;*/
 	};
+
+	class MotionTracker
+	{
+	public:
+
+		MotionTracker();
+		~MotionTracker();
+
+		ALvoid reset();
+		ALint track(SceFVector4 vPosition, SceUInt64 uTimeUs, float32_t fMaxSpeed, SceFVector4 *pVelocityOut);
+
+		ALboolean m_enabled;
+
+	private:
+
+		SceFVector4 m_lastPosition;
+		SceFVector4 m_velocity;
+		SceUInt64 m_lastTime;
+		ALboolean m_hasLast;
+	};
 }
 
 #endif
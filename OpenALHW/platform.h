@@ -0,0 +1,218 @@
+#ifndef AL_PLATFORM_H
+#define AL_PLATFORM_H
+
+#include <stdint.h>
+
+#include "AL/al.h"
+
+#ifdef __psp2__
+#include <kernel.h>
+#include <sce_atomic.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+
+typedef float float32_t;
+#endif
+
+namespace al {
+
+	// Locks, threads and atomics of the mixing core. The Vita maps straight onto the kernel, other hosts use platform_posix.cpp
+
+	typedef ALvoid(*AlThreadEntry)(ALvoid *pArg);
+
+#ifdef __psp2__
+
+	typedef SceKernelLwMutexWork AlMutex;
+	typedef SceUID AlSema;
+	typedef SceUID AlThread;
+
+	#define AL_INVALID_SEMA				SCE_UID_INVALID_UID
+	#define AL_INVALID_THREAD			SCE_UID_INVALID_UID
+
+	#define AL_PLATFORM_USER_CORES		(3)
+	#define AL_PLATFORM_CORE_MASK(x)	(SCE_KERNEL_CPU_MASK_USER_0 << (x))
+
+	struct ThreadStart
+	{
+		AlThreadEntry entry;
+		ALvoid *pArg;
+	};
+
+	inline SceInt32 _alThreadTrampoline(SceSize argSize, void *pArgBlock)
+	{
+		ThreadStart *start = (ThreadStart *)pArgBlock;
+
+		start->entry(start->pArg);
+
+		return sceKernelExitThread(0);
+	}
+
+	inline ALboolean _alMutexCreate(AlMutex *pMutex, const char *name)
+	{
+		return (sceKernelCreateLwMutex(pMutex, name, 0, 0, NULL) == SCE_OK) ? AL_TRUE : AL_FALSE;
+	}
+
+	inline ALvoid _alMutexDelete(AlMutex *pMutex)
+	{
+		sceKernelDeleteLwMutex(pMutex);
+	}
+
+	inline ALvoid _alMutexLock(AlMutex *pMutex)
+	{
+		sceKernelLockLwMutex(pMutex, 1, NULL);
+	}
+
+	inline ALboolean _alMutexTryLock(AlMutex *pMutex)
+	{
+		return (sceKernelTryLockLwMutex(pMutex, 1) == SCE_OK) ? AL_TRUE : AL_FALSE;
+	}
+
+	inline ALvoid _alMutexUnlock(AlMutex *pMutex)
+	{
+		sceKernelUnlockLwMutex(pMutex, 1);
+	}
+
+	inline AlSema _alSemaCreate(const char *name, ALint initCount, ALint maxCount)
+	{
+		SceUID sema = sceKernelCreateSema(name, SCE_KERNEL_SEMA_ATTR_TH_FIFO, initCount, maxCount, NULL);
+
+		return (sema > 0) ? sema : AL_INVALID_SEMA;
+	}
+
+	inline ALvoid _alSemaDelete(AlSema sema)
+	{
+		sceKernelDeleteSema(sema);
+	}
+
+	inline ALvoid _alSemaWait(AlSema sema, ALint count)
+	{
+		sceKernelWaitSema(sema, count, NULL);
+	}
+
+	inline ALvoid _alSemaSignal(AlSema sema, ALint count)
+	{
+		sceKernelSignalSema(sema, count);
+	}
+
+	inline AlThread _alThreadStart(const char *name, AlThreadEntry entry, ALvoid *pArg, ALuint affinity)
+	{
+		ThreadStart start = { entry, pArg };
+		SceUID thread = sceKernelCreateThread(name, _alThreadTrampoline, SCE_KERNEL_HIGHEST_PRIORITY_USER, SCE_KERNEL_4KiB, 0, affinity, NULL);
+
+		if (thread <= 0)
+		{
+			return AL_INVALID_THREAD;
+		}
+
+		if (sceKernelStartThread(thread, sizeof(ThreadStart), &start) != SCE_OK)
+		{
+			sceKernelDeleteThread(thread);
+			return AL_INVALID_THREAD;
+		}
+
+		return thread;
+	}
+
+	inline ALvoid _alThreadJoin(AlThread thread)
+	{
+		sceKernelWaitThreadEnd(thread, NULL, NULL);
+		sceKernelDeleteThread(thread);
+	}
+
+	inline int32_t _alAtomicLoad32(volatile int32_t *pValue)
+	{
+		return sceAtomicLoad32AcqRel(pValue);
+	}
+
+	inline int32_t _alAtomicAdd32(volatile int32_t *pValue, int32_t value)
+	{
+		return sceAtomicAdd32AcqRel(pValue, value);
+	}
+
+	inline int64_t _alAtomicLoad64(volatile int64_t *pValue)
+	{
+		return sceAtomicLoad64AcqRel(pValue);
+	}
+
+	inline int64_t _alAtomicAdd64(volatile int64_t *pValue, int64_t value)
+	{
+		return sceAtomicAdd64AcqRel(pValue, value);
+	}
+
+	inline int64_t _alAtomicCompareAndSwap64(volatile int64_t *pValue, int64_t expected, int64_t value)
+	{
+		return sceAtomicCompareAndSwap64AcqRel(pValue, expected, value);
+	}
+
+	inline uint64_t _alTimeGet()
+	{
+		return sceKernelGetProcessTimeWide();
+	}
+
+	inline ALvoid _alDelay(ALuint us)
+	{
+		sceKernelDelayThread(us);
+	}
+
+#else
+
+	typedef pthread_mutex_t AlMutex;
+	typedef sem_t *AlSema;
+	typedef pthread_t *AlThread;
+
+	#define AL_INVALID_SEMA				NULL
+	#define AL_INVALID_THREAD			NULL
+
+	// Same bit layout as alcSetThreadAffinityNGS masks, bit 16 + i pins to host CPU i
+	#define AL_PLATFORM_USER_CORES		(3)
+	#define AL_PLATFORM_CORE_MASK(x)	(0x10000 << (x))
+
+	ALboolean _alMutexCreate(AlMutex *pMutex, const char *name);
+	ALvoid _alMutexDelete(AlMutex *pMutex);
+	ALvoid _alMutexLock(AlMutex *pMutex);
+	ALboolean _alMutexTryLock(AlMutex *pMutex);
+	ALvoid _alMutexUnlock(AlMutex *pMutex);
+
+	AlSema _alSemaCreate(const char *name, ALint initCount, ALint maxCount);
+	ALvoid _alSemaDelete(AlSema sema);
+	ALvoid _alSemaWait(AlSema sema, ALint count);
+	ALvoid _alSemaSignal(AlSema sema, ALint count);
+
+	AlThread _alThreadStart(const char *name, AlThreadEntry entry, ALvoid *pArg, ALuint affinity);
+	ALvoid _alThreadJoin(AlThread thread);
+
+	inline int32_t _alAtomicLoad32(volatile int32_t *pValue)
+	{
+		return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+	}
+
+	inline int32_t _alAtomicAdd32(volatile int32_t *pValue, int32_t value)
+	{
+		return __atomic_fetch_add(pValue, value, __ATOMIC_ACQ_REL);
+	}
+
+	inline int64_t _alAtomicLoad64(volatile int64_t *pValue)
+	{
+		return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+	}
+
+	inline int64_t _alAtomicAdd64(volatile int64_t *pValue, int64_t value)
+	{
+		return __atomic_fetch_add(pValue, value, __ATOMIC_ACQ_REL);
+	}
+
+	inline int64_t _alAtomicCompareAndSwap64(volatile int64_t *pValue, int64_t expected, int64_t value)
+	{
+		__atomic_compare_exchange_n(pValue, &expected, value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+
+		return expected;
+	}
+
+	uint64_t _alTimeGet();
+	ALvoid _alDelay(ALuint us);
+
+#endif
+}
+
+#endif
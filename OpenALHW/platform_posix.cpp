@@ -0,0 +1,191 @@
+#ifndef __psp2__
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include "platform.h"
+
+using namespace al;
+
+struct ThreadStart
+{
+	AlThreadEntry entry;
+	ALvoid *pArg;
+};
+
+static void *_alThreadTrampoline(void *pArg)
+{
+	ThreadStart start = *(ThreadStart *)pArg;
+
+	free(pArg);
+	start.entry(start.pArg);
+
+	return NULL;
+}
+
+// Names only show up in the Vita's debugger, pthreads has nowhere to put them
+ALboolean al::_alMutexCreate(AlMutex *pMutex, const char *)
+{
+	pthread_mutexattr_t attr;
+	ALboolean ret = AL_FALSE;
+
+	// LwMutexes refuse a recursive lock instead of deadlocking, a recursive mutex is the closest match
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+	if (pthread_mutex_init(pMutex, &attr) == 0)
+	{
+		ret = AL_TRUE;
+	}
+
+	pthread_mutexattr_destroy(&attr);
+
+	return ret;
+}
+
+ALvoid al::_alMutexDelete(AlMutex *pMutex)
+{
+	pthread_mutex_destroy(pMutex);
+}
+
+ALvoid al::_alMutexLock(AlMutex *pMutex)
+{
+	pthread_mutex_lock(pMutex);
+}
+
+ALboolean al::_alMutexTryLock(AlMutex *pMutex)
+{
+	return (pthread_mutex_trylock(pMutex) == 0) ? AL_TRUE : AL_FALSE;
+}
+
+ALvoid al::_alMutexUnlock(AlMutex *pMutex)
+{
+	pthread_mutex_unlock(pMutex);
+}
+
+// sem_t has no ceiling to hold the max count against
+AlSema al::_alSemaCreate(const char *, ALint initCount, ALint)
+{
+	sem_t *sema = (sem_t *)malloc(sizeof(sem_t));
+
+	if (sema == NULL)
+	{
+		return AL_INVALID_SEMA;
+	}
+
+	if (sem_init(sema, 0, initCount) != 0)
+	{
+		free(sema);
+		return AL_INVALID_SEMA;
+	}
+
+	return sema;
+}
+
+ALvoid al::_alSemaDelete(AlSema sema)
+{
+	sem_destroy(sema);
+	free(sema);
+}
+
+ALvoid al::_alSemaWait(AlSema sema, ALint count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		while (sem_wait(sema) != 0 && errno == EINTR)
+		{
+
+		}
+	}
+}
+
+ALvoid al::_alSemaSignal(AlSema sema, ALint count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		sem_post(sema);
+	}
+}
+
+AlThread al::_alThreadStart(const char *, AlThreadEntry entry, ALvoid *pArg, ALuint affinity)
+{
+	pthread_t *thread = (pthread_t *)malloc(sizeof(pthread_t));
+	ThreadStart *start = (ThreadStart *)malloc(sizeof(ThreadStart));
+
+	if (thread == NULL || start == NULL)
+	{
+		free(thread);
+		free(start);
+		return AL_INVALID_THREAD;
+	}
+
+	start->entry = entry;
+	start->pArg = pArg;
+
+	if (pthread_create(thread, NULL, _alThreadTrampoline, start) != 0)
+	{
+		free(thread);
+		free(start);
+		return AL_INVALID_THREAD;
+	}
+
+#ifdef __linux__
+	if (affinity != 0)
+	{
+		cpu_set_t cpus;
+
+		CPU_ZERO(&cpus);
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (affinity & (AL_PLATFORM_CORE_MASK(0) << i))
+			{
+				CPU_SET(i, &cpus);
+			}
+		}
+
+		// Best effort, a host with fewer CPUs just runs the thread wherever it lands
+		pthread_setaffinity_np(*thread, sizeof(cpu_set_t), &cpus);
+	}
+#endif
+
+	return thread;
+}
+
+ALvoid al::_alThreadJoin(AlThread thread)
+{
+	pthread_join(*thread, NULL);
+	free(thread);
+}
+
+uint64_t al::_alTimeGet()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+ALvoid al::_alDelay(ALuint us)
+{
+	struct timespec ts;
+
+	ts.tv_sec = us / 1000000;
+	ts.tv_nsec = (us % 1000000) * 1000;
+
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+	{
+
+	}
+}
+
+#endif
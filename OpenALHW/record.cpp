@@ -0,0 +1,237 @@
+#include <kernel.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "common.h"
+#include "record.h"
+
+using namespace al;
+
+volatile ALboolean al::g_recordEnabled = AL_FALSE;
+
+// Calls can come from any thread, the lock keeps records whole and in call order
+static SceKernelLwMutexWork s_recordLock;
+static ALboolean s_recordLockCreated = AL_FALSE;
+static SceUID s_recordFd = SCE_UID_INVALID_UID;
+static uint8_t *s_recordBuffer = NULL;
+static ALint s_recordFill = 0;
+static SceUInt64 s_recordLastTime = 0;
+static std::vector<uint64_t> s_recordBlobs;
+
+static uint64_t _alRecordHash(const ALvoid *data, ALsizei size)
+{
+	// FNV-1a, only has to tell buffer contents apart within one session
+	const uint8_t *bytes = (const uint8_t *)data;
+	uint64_t hash = 0xCBF29CE484222325ULL;
+
+	for (ALsizei i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+static ALvoid _alRecordFlush()
+{
+	if (s_recordFill > 0)
+	{
+		sceIoWrite(s_recordFd, s_recordBuffer, s_recordFill);
+		s_recordFill = 0;
+	}
+}
+
+static ALvoid _alRecordAppend(const ALvoid *data, ALint size)
+{
+	if (s_recordFill + size > AL_RECORD_BUFFER_SIZE)
+	{
+		_alRecordFlush();
+	}
+
+	// Large payloads such as buffer contents go straight to the file
+	if (size > AL_RECORD_BUFFER_SIZE)
+	{
+		sceIoWrite(s_recordFd, data, size);
+		return;
+	}
+
+	memcpy(s_recordBuffer + s_recordFill, data, size);
+	s_recordFill += size;
+}
+
+static ALvoid _alRecordWrite(RecordOp op, const ALvoid *head, ALint headSize, const ALvoid *body, ALint bodySize)
+{
+	RecordHeader header;
+	SceUInt64 now = sceKernelGetProcessTimeWide();
+
+	header.delta = (uint32_t)(now - s_recordLastTime);
+	header.op = op;
+	header.size = headSize + bodySize;
+
+	s_recordLastTime = now;
+
+	_alRecordAppend(&header, sizeof(RecordHeader));
+	_alRecordAppend(head, headSize);
+
+	if (bodySize > 0)
+	{
+		_alRecordAppend(body, bodySize);
+	}
+}
+
+ALboolean al::_alRecordStart(const ALchar *path)
+{
+	RecordFileHeader header;
+
+	if (s_recordLockCreated == AL_FALSE)
+	{
+		if (sceKernelCreateLwMutex(&s_recordLock, "OpenALHW::RecMtx", 0, 0, NULL) != SCE_OK)
+		{
+			return AL_FALSE;
+		}
+
+		s_recordLockCreated = AL_TRUE;
+	}
+
+	sceKernelLockLwMutex(&s_recordLock, 1, NULL);
+
+	if (g_recordEnabled == AL_TRUE)
+	{
+		sceKernelUnlockLwMutex(&s_recordLock, 1);
+		return AL_FALSE;
+	}
+
+	s_recordBuffer = (uint8_t *)AL_MALLOC(AL_RECORD_BUFFER_SIZE);
+	if (s_recordBuffer == NULL)
+	{
+		sceKernelUnlockLwMutex(&s_recordLock, 1);
+		return AL_FALSE;
+	}
+
+	s_recordFd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0666);
+	if (s_recordFd < 0)
+	{
+		AL_FREE(s_recordBuffer);
+		s_recordBuffer = NULL;
+		sceKernelUnlockLwMutex(&s_recordLock, 1);
+		return AL_FALSE;
+	}
+
+	header.magic = AL_RECORD_FILE_MAGIC;
+	header.version = AL_RECORD_FILE_VERSION;
+
+	s_recordFill = 0;
+	s_recordLastTime = sceKernelGetProcessTimeWide();
+	s_recordBlobs.clear();
+
+	_alRecordAppend(&header, sizeof(RecordFileHeader));
+
+	g_recordEnabled = AL_TRUE;
+
+	sceKernelUnlockLwMutex(&s_recordLock, 1);
+
+	return AL_TRUE;
+}
+
+ALvoid al::_alRecordStop()
+{
+	if (s_recordLockCreated == AL_FALSE)
+	{
+		return;
+	}
+
+	sceKernelLockLwMutex(&s_recordLock, 1, NULL);
+
+	if (g_recordEnabled == AL_TRUE)
+	{
+		g_recordEnabled = AL_FALSE;
+
+		_alRecordFlush();
+		sceIoClose(s_recordFd);
+		s_recordFd = SCE_UID_INVALID_UID;
+
+		AL_FREE(s_recordBuffer);
+		s_recordBuffer = NULL;
+
+		s_recordBlobs.clear();
+	}
+
+	sceKernelUnlockLwMutex(&s_recordLock, 1);
+}
+
+ALvoid al::_alRecordObjects(RecordOp op, ALuint object, ALsizei count, const ALuint *names)
+{
+	RecordObjects head;
+
+	head.object = object;
+	head.count = count;
+
+	sceKernelLockLwMutex(&s_recordLock, 1, NULL);
+
+	// Checked again under the lock in case recording stopped in between
+	if (g_recordEnabled == AL_TRUE)
+	{
+		_alRecordWrite(op, &head, sizeof(RecordObjects), names, (names != NULL && count > 0) ? count * sizeof(ALuint) : 0);
+	}
+
+	sceKernelUnlockLwMutex(&s_recordLock, 1);
+}
+
+ALvoid al::_alRecordValues(RecordOp op, ALuint object, ALenum param, ALsizei count, const ALvoid *values)
+{
+	RecordValues head;
+
+	head.object = object;
+	head.param = param;
+	head.count = count;
+
+	sceKernelLockLwMutex(&s_recordLock, 1, NULL);
+
+	if (g_recordEnabled == AL_TRUE)
+	{
+		_alRecordWrite(op, &head, sizeof(RecordValues), values, (values != NULL && count > 0) ? count * sizeof(ALint) : 0);
+	}
+
+	sceKernelUnlockLwMutex(&s_recordLock, 1);
+}
+
+ALvoid al::_alRecordBufferData(ALuint buffer, ALenum format, const ALvoid *data, ALsizei size, ALsizei frequency)
+{
+	RecordBufferData head;
+	RecordBlob blob;
+
+	if (data == NULL || size < 0)
+	{
+		size = 0;
+	}
+
+	head.hash = _alRecordHash(data, size);
+	head.buffer = buffer;
+	head.format = format;
+	head.size = size;
+	head.frequency = frequency;
+
+	sceKernelLockLwMutex(&s_recordLock, 1, NULL);
+
+	if (g_recordEnabled == AL_TRUE)
+	{
+		std::vector<uint64_t>::iterator it = std::lower_bound(s_recordBlobs.begin(), s_recordBlobs.end(), head.hash);
+
+		if (it == s_recordBlobs.end() || *it != head.hash)
+		{
+			s_recordBlobs.insert(it, head.hash);
+
+			blob.hash = head.hash;
+			blob.size = size;
+			blob.reserved = 0;
+
+			_alRecordWrite(RecordOp_BufferBlob, &blob, sizeof(RecordBlob), data, size);
+		}
+
+		_alRecordWrite(RecordOp_BufferData, &head, sizeof(RecordBufferData), NULL, 0);
+	}
+
+	sceKernelUnlockLwMutex(&s_recordLock, 1);
+}
@@ -0,0 +1,107 @@
+#ifndef AL_RECORD_H
+#define AL_RECORD_H
+
+#include <kernel.h>
+
+#include "AL/al.h"
+
+namespace al {
+
+	#define AL_RECORD_FILE_MAGIC		(0x43524C41) // "ALRC"
+	#define AL_RECORD_FILE_VERSION		(1)
+	#define AL_RECORD_BUFFER_SIZE		(64 * 1024)
+
+	// Only calls that change state are recorded, and only at the entry point that does the work,
+	// so alSourcefv(AL_POSITION) shows up as the alSource3f it forwards to
+	enum RecordOp
+	{
+		RecordOp_GenSources = 1,
+		RecordOp_DeleteSources,
+		RecordOp_GenBuffers,
+		RecordOp_DeleteBuffers,
+		RecordOp_BufferBlob,
+		RecordOp_BufferData,
+		RecordOp_Sourcef,
+		RecordOp_Source3f,
+		RecordOp_Sourcei,
+		RecordOp_SourcePlay,
+		RecordOp_SourceStop,
+		RecordOp_SourceRewind,
+		RecordOp_SourcePause,
+		RecordOp_SourceQueueBuffers,
+		RecordOp_SourceUnqueueBuffers,
+		RecordOp_Listenerf,
+		RecordOp_Listener3f,
+		RecordOp_Listenerfv,
+		RecordOp_Listeneri,
+		RecordOp_DopplerFactor,
+		RecordOp_DopplerVelocity,
+		RecordOp_SpeedOfSound,
+		RecordOp_DistanceModel,
+		RecordOp_DeferUpdates,
+		RecordOp_ProcessUpdates
+	};
+
+	// File layout, little endian: RecordFileHeader, then records until the end of the file
+	struct RecordFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+	};
+
+	// Every record starts with this, size counts the payload that follows
+	struct RecordHeader
+	{
+		uint32_t delta;	// microseconds since the previous record
+		uint32_t op;
+		uint32_t size;
+	};
+
+	// Gen/Delete/Play/Stop/Rewind/Pause/Queue/Unqueue, followed by count names unless the call outputs them
+	struct RecordObjects
+	{
+		ALuint object;
+		ALint count;
+	};
+
+	// Setters and globals, followed by count 32-bit values
+	struct RecordValues
+	{
+		ALuint object;
+		ALenum param;
+		ALint count;
+	};
+
+	// Buffer contents are stored once per distinct hash, later alBufferData calls only refer to them
+	struct RecordBlob
+	{
+		uint64_t hash;
+		uint32_t size;
+		uint32_t reserved;
+	};
+
+	struct RecordBufferData
+	{
+		uint64_t hash;
+		ALuint buffer;
+		ALenum format;
+		ALsizei size;
+		ALsizei frequency;
+	};
+
+	// Located in record.cpp
+	extern volatile ALboolean g_recordEnabled;
+
+	ALboolean _alRecordStart(const ALchar *path);
+	ALvoid _alRecordStop();
+	ALvoid _alRecordObjects(RecordOp op, ALuint object, ALsizei count, const ALuint *names);
+	ALvoid _alRecordValues(RecordOp op, ALuint object, ALenum param, ALsizei count, const ALvoid *values);
+	ALvoid _alRecordBufferData(ALuint buffer, ALenum format, const ALvoid *data, ALsizei size, ALsizei frequency);
+}
+
+#define AL_RECORD_OBJECTS(op, object, count, names) { if (al::g_recordEnabled == AL_TRUE) al::_alRecordObjects(op, object, count, names); }
+#define AL_RECORD_VALUES(op, object, param, count, values) { if (al::g_recordEnabled == AL_TRUE) al::_alRecordValues(op, object, param, count, values); }
+#define AL_RECORD_VALUES3F(op, object, param, v1, v2, v3) { if (al::g_recordEnabled == AL_TRUE) { const ALfloat _alRecordArgs[3] = { v1, v2, v3 }; al::_alRecordValues(op, object, param, 3, _alRecordArgs); } }
+#define AL_RECORD_BUFFER_DATA(buffer, format, data, size, frequency) { if (al::g_recordEnabled == AL_TRUE) al::_alRecordBufferData(buffer, format, data, size, frequency); }
+
+#endif
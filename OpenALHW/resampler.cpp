@@ -0,0 +1,362 @@
+#include <kernel.h>
+#include <string.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AL_RESAMPLER_NEON
+#endif
+
+#include "common.h"
+#include "AL/alext.h"
+#include "resampler.h"
+
+using namespace al;
+
+ALboolean al::_alFormatInfo(ALenum format, ALint *pChannels, SampleType *pType)
+{
+	switch (format)
+	{
+	case AL_FORMAT_MONO8:
+		*pChannels = 1;
+		*pType = SampleType_U8;
+		break;
+	case AL_FORMAT_MONO16:
+		*pChannels = 1;
+		*pType = SampleType_S16;
+		break;
+	case AL_FORMAT_MONO_FLOAT32:
+		*pChannels = 1;
+		*pType = SampleType_Float32;
+		break;
+	case AL_FORMAT_STEREO8:
+		*pChannels = 2;
+		*pType = SampleType_U8;
+		break;
+	case AL_FORMAT_STEREO16:
+		*pChannels = 2;
+		*pType = SampleType_S16;
+		break;
+	case AL_FORMAT_STEREO_FLOAT32:
+		*pChannels = 2;
+		*pType = SampleType_Float32;
+		break;
+	default:
+		return AL_FALSE;
+	}
+
+	return AL_TRUE;
+}
+
+ALint al::_alSampleTypeSize(SampleType type)
+{
+	switch (type)
+	{
+	case SampleType_U8:
+		return sizeof(uint8_t);
+	case SampleType_S16:
+		return sizeof(int16_t);
+	case SampleType_Float32:
+		return sizeof(float32_t);
+	}
+
+	return 0;
+}
+
+ALvoid al::_alConvertS16ToFloat(float32_t *pOut, const int16_t *pIn, ALint samples)
+{
+	ALint i = 0;
+
+#ifdef AL_RESAMPLER_NEON
+	for (; i + 8 <= samples; i += 8)
+	{
+		int16x8_t in = vld1q_s16(pIn + i);
+
+		vst1q_f32(pOut + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), 1.0f / 32768.0f));
+		vst1q_f32(pOut + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(in))), 1.0f / 32768.0f));
+	}
+#endif
+
+	for (; i < samples; i++)
+	{
+		pOut[i] = (float32_t)pIn[i] * (1.0f / 32768.0f);
+	}
+}
+
+static ALvoid _alConvertToU8(uint8_t *pOut, const float32_t *pIn, ALint frames, ALint channels)
+{
+	ALint i = 0;
+
+#ifdef AL_RESAMPLER_NEON
+	float32x4_t bias = vdupq_n_f32(128.0f);
+
+	for (; i + 8 <= frames; i += 8)
+	{
+		int32x4_t lo = vcvtq_s32_f32(vmlaq_n_f32(bias, vld1q_f32(pIn + i), 127.0f));
+		int32x4_t hi = vcvtq_s32_f32(vmlaq_n_f32(bias, vld1q_f32(pIn + i + 4), 127.0f));
+		uint8x8_t out = vqmovun_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+
+		if (channels == 2)
+		{
+			uint8x8x2_t pair = { { out, out } };
+			vst2_u8(pOut + i * 2, pair);
+		}
+		else
+		{
+			vst1_u8(pOut + i, out);
+		}
+	}
+#endif
+
+	for (; i < frames; i++)
+	{
+		float32_t s = pIn[i] * 127.0f + 128.0f;
+
+		if (s > 255.0f)
+			s = 255.0f;
+		else if (s < 0.0f)
+			s = 0.0f;
+
+		for (int ch = 0; ch < channels; ch++)
+		{
+			pOut[i * channels + ch] = (uint8_t)s;
+		}
+	}
+}
+
+static ALvoid _alConvertToS16(int16_t *pOut, const float32_t *pIn, ALint frames, ALint channels)
+{
+	ALint i = 0;
+
+#ifdef AL_RESAMPLER_NEON
+	for (; i + 8 <= frames; i += 8)
+	{
+		int32x4_t lo = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pIn + i), 32767.0f));
+		int32x4_t hi = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(pIn + i + 4), 32767.0f));
+		int16x8_t out = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+
+		if (channels == 2)
+		{
+			int16x8x2_t pair = { { out, out } };
+			vst2q_s16(pOut + i * 2, pair);
+		}
+		else
+		{
+			vst1q_s16(pOut + i, out);
+		}
+	}
+#endif
+
+	for (; i < frames; i++)
+	{
+		float32_t s = pIn[i] * 32767.0f;
+
+		if (s > 32767.0f)
+			s = 32767.0f;
+		else if (s < -32768.0f)
+			s = -32768.0f;
+
+		for (int ch = 0; ch < channels; ch++)
+		{
+			pOut[i * channels + ch] = (int16_t)s;
+		}
+	}
+}
+
+static ALvoid _alConvertToFloat(float32_t *pOut, const float32_t *pIn, ALint frames, ALint channels)
+{
+	ALint i = 0;
+
+	if (channels == 1)
+	{
+		memcpy(pOut, pIn, frames * sizeof(float32_t));
+		return;
+	}
+
+#ifdef AL_RESAMPLER_NEON
+	for (; i + 4 <= frames; i += 4)
+	{
+		float32x4_t in = vld1q_f32(pIn + i);
+		float32x4x2_t pair = { { in, in } };
+
+		vst2q_f32(pOut + i * 2, pair);
+	}
+#endif
+
+	for (; i < frames; i++)
+	{
+		pOut[i * 2] = pIn[i];
+		pOut[i * 2 + 1] = pIn[i];
+	}
+}
+
+ALvoid al::_alConvertFromFloat(ALvoid *pOut, const float32_t *pIn, ALint frames, ALint channels, SampleType type)
+{
+	// Sources are mono, a second channel is the same signal on both sides
+	switch (type)
+	{
+	case SampleType_U8:
+		_alConvertToU8((uint8_t *)pOut, pIn, frames, channels);
+		break;
+	case SampleType_S16:
+		_alConvertToS16((int16_t *)pOut, pIn, frames, channels);
+		break;
+	case SampleType_Float32:
+		_alConvertToFloat((float32_t *)pOut, pIn, frames, channels);
+		break;
+	}
+}
+
+Resampler::Resampler()
+	: m_quality(ResamplerQuality_Linear),
+	m_step(AL_RESAMPLER_FRAC_ONE),
+	m_pos(0),
+	m_maxInput(0),
+	m_work(NULL)
+{
+
+}
+
+Resampler::~Resampler()
+{
+	if (m_work)
+		AL_FREE(m_work);
+}
+
+ALint Resampler::init(ALint srcRate, ALint dstRate, ALint maxInput)
+{
+	if (srcRate <= 0 || dstRate <= 0 || maxInput <= 0)
+	{
+		return AL_INVALID_VALUE;
+	}
+
+	if (m_work)
+	{
+		AL_FREE(m_work);
+	}
+
+	m_work = (float32_t *)AL_MALLOC((maxInput + AL_RESAMPLER_HISTORY) * sizeof(float32_t));
+	if (m_work == NULL)
+	{
+		return AL_OUT_OF_MEMORY;
+	}
+
+	memset(m_work, 0, AL_RESAMPLER_HISTORY * sizeof(float32_t));
+
+	m_step = (uint32_t)(((uint64_t)srcRate << AL_RESAMPLER_FRAC_BITS) / dstRate);
+	if (m_step == 0)
+	{
+		m_step = 1;
+	}
+
+	m_pos = 0;
+	m_maxInput = maxInput;
+
+	return AL_NO_ERROR;
+}
+
+ALvoid Resampler::setQuality(ResamplerQuality quality)
+{
+	m_quality = quality;
+}
+
+ALint Resampler::getMaxOutput(ALint inFrames)
+{
+	return (ALint)((((uint64_t)inFrames << AL_RESAMPLER_FRAC_BITS) + m_step - 1) / m_step) + 1;
+}
+
+ALint Resampler::process(const float32_t *pIn, ALint inFrames, float32_t *pOut)
+{
+	uint32_t end = (uint32_t)inFrames << AL_RESAMPLER_FRAC_BITS;
+	uint32_t pos = m_pos;
+	ALint out = 0;
+
+	// Work holds the tail of the previous call ahead of the new input, position 0 maps to m_work[1]
+	memcpy(m_work + AL_RESAMPLER_HISTORY, pIn, inFrames * sizeof(float32_t));
+
+	const float32_t *src = m_work + 1;
+
+#ifdef AL_RESAMPLER_NEON
+	if (m_quality != ResamplerQuality_Point)
+	{
+		uint32x4_t vpos = { pos, pos + m_step, pos + 2 * m_step, pos + 3 * m_step };
+		uint32x4_t vstep = vdupq_n_u32(4 * m_step);
+		uint32x4_t fracMask = vdupq_n_u32(AL_RESAMPLER_FRAC_ONE - 1);
+
+		for (; pos + 3 * m_step < end; pos += 4 * m_step)
+		{
+			float32x4_t f = vcvtq_n_f32_u32(vandq_u32(vpos, fracMask), AL_RESAMPLER_FRAC_BITS);
+			uint32_t idx[4];
+			float32_t x0[4], x1[4], x2[4], x3[4];
+
+			vst1q_u32(idx, vshrq_n_u32(vpos, AL_RESAMPLER_FRAC_BITS));
+
+			for (int k = 0; k < 4; k++)
+			{
+				x0[k] = src[idx[k] - 1];
+				x1[k] = src[idx[k]];
+				x2[k] = src[idx[k] + 1];
+				x3[k] = src[idx[k] + 2];
+			}
+
+			float32x4_t v1 = vld1q_f32(x1);
+			float32x4_t v2 = vld1q_f32(x2);
+
+			if (m_quality == ResamplerQuality_Linear)
+			{
+				vst1q_f32(pOut + out, vmlaq_f32(v1, vsubq_f32(v2, v1), f));
+			}
+			else
+			{
+				float32x4_t v0 = vld1q_f32(x0);
+				float32x4_t v3 = vld1q_f32(x3);
+				float32x4_t a = vmulq_n_f32(vaddq_f32(vsubq_f32(v3, v0), vmulq_n_f32(vsubq_f32(v1, v2), 3.0f)), 0.5f);
+				float32x4_t b = vsubq_f32(vaddq_f32(v0, vmulq_n_f32(v2, 2.0f)), vmulq_n_f32(vaddq_f32(vmulq_n_f32(v1, 5.0f), v3), 0.5f));
+				float32x4_t c = vmulq_n_f32(vsubq_f32(v2, v0), 0.5f);
+
+				vst1q_f32(pOut + out, vmlaq_f32(v1, vmlaq_f32(c, vmlaq_f32(b, a, f), f), f));
+			}
+
+			vpos = vaddq_u32(vpos, vstep);
+			out += 4;
+		}
+	}
+#endif
+
+	for (; pos < end; pos += m_step)
+	{
+		uint32_t i = pos >> AL_RESAMPLER_FRAC_BITS;
+		float32_t f = (float32_t)(pos & (AL_RESAMPLER_FRAC_ONE - 1)) * (1.0f / AL_RESAMPLER_FRAC_ONE);
+
+		switch (m_quality)
+		{
+		case ResamplerQuality_Point:
+			pOut[out] = src[i];
+			break;
+		case ResamplerQuality_Linear:
+			pOut[out] = src[i] + (src[i + 1] - src[i]) * f;
+			break;
+		case ResamplerQuality_Cubic:
+		{
+			// Catmull-Rom through the two neighbours on each side
+			float32_t x0 = src[i - 1];
+			float32_t x1 = src[i];
+			float32_t x2 = src[i + 1];
+			float32_t x3 = src[i + 2];
+			float32_t a = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+			float32_t b = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+			float32_t c = 0.5f * (x2 - x0);
+
+			pOut[out] = ((a * f + b) * f + c) * f + x1;
+			break;
+		}
+		}
+
+		out++;
+	}
+
+	m_pos = pos - end;
+
+	memmove(m_work, m_work + inFrames, AL_RESAMPLER_HISTORY * sizeof(float32_t));
+
+	return out;
+}
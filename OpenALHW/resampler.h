@@ -0,0 +1,57 @@
+#ifndef AL_RESAMPLER_H
+#define AL_RESAMPLER_H
+
+#include <kernel.h>
+
+#include "common.h"
+
+namespace al {
+
+	enum ResamplerQuality
+	{
+		ResamplerQuality_Point,
+		ResamplerQuality_Linear,
+		ResamplerQuality_Cubic
+	};
+
+	// Sample encodings a converted stream can be written in, interleaved when there are two channels
+	enum SampleType
+	{
+		SampleType_U8,
+		SampleType_S16,
+		SampleType_Float32
+	};
+
+	ALboolean _alFormatInfo(ALenum format, ALint *pChannels, SampleType *pType);
+	ALint _alSampleTypeSize(SampleType type);
+	ALvoid _alConvertS16ToFloat(float32_t *pOut, const int16_t *pIn, ALint samples);
+	ALvoid _alConvertFromFloat(ALvoid *pOut, const float32_t *pIn, ALint frames, ALint channels, SampleType type);
+
+	// Streaming mono rate converter, keeps enough history to stay continuous across calls
+	class Resampler
+	{
+	public:
+
+		Resampler();
+		~Resampler();
+
+		ALint init(ALint srcRate, ALint dstRate, ALint maxInput);
+		ALvoid setQuality(ResamplerQuality quality);
+		ALint getMaxOutput(ALint inFrames);
+		ALint process(const float32_t *pIn, ALint inFrames, float32_t *pOut);
+
+	private:
+
+		#define AL_RESAMPLER_HISTORY	(3)
+		#define AL_RESAMPLER_FRAC_BITS	(16)
+		#define AL_RESAMPLER_FRAC_ONE	(1 << AL_RESAMPLER_FRAC_BITS)
+
+		ResamplerQuality m_quality;
+		uint32_t m_step;
+		uint32_t m_pos;
+		ALint m_maxInput;
+		float32_t *m_work;
+	};
+}
+
+#endif
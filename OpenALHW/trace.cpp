@@ -0,0 +1,291 @@
+#include <kernel.h>
+#include <string.h>
+#include <vector>
+#include <sce_atomic.h>
+
+#include "common.h"
+#include "trace.h"
+
+using namespace al;
+
+#define AL_TRACE_DUMP_BATCH (64)
+#define AL_TRACE_DUMP_WAIT_US (100)
+
+struct TraceEvent
+{
+	SceUInt64 begin;
+	SceUInt32 duration;
+	const char *func;
+	ALuint object;
+	ALint arg;
+};
+
+// One ring per calling thread so recording never needs a lock, each ring only has a single writer
+struct TraceRing
+{
+	volatile int32_t thread;
+	TraceEvent *pEvents;
+	volatile int32_t count;
+};
+
+volatile ALboolean al::g_traceEnabled = AL_FALSE;
+
+static TraceRing s_traceRings[AL_TRACE_THREADS];
+
+// Writers announce themselves so a dump can wait until none of them is inside a ring
+static volatile int32_t s_traceDumping = 0;
+static volatile int32_t s_traceWriters = 0;
+
+static ALboolean _alTraceThreadAlive(SceUID thread)
+{
+	SceKernelThreadInfo info;
+
+	memset(&info, 0, sizeof(SceKernelThreadInfo));
+	info.size = sizeof(SceKernelThreadInfo);
+
+	return (sceKernelGetThreadInfo(thread, &info) == SCE_OK) ? AL_TRUE : AL_FALSE;
+}
+
+static TraceRing *_alTraceClaimRing(TraceRing *ring, int32_t owner, SceUID thread)
+{
+	if (sceAtomicCompareAndSwap32AcqRel(&ring->thread, owner, thread) != owner)
+	{
+		return NULL;
+	}
+
+	sceAtomicStore32AcqRel(&ring->count, 0);
+
+	if (ring->pEvents == NULL)
+	{
+		ring->pEvents = (TraceEvent *)AL_MALLOC(AL_TRACE_RING_EVENTS * sizeof(TraceEvent));
+	}
+
+	return ring;
+}
+
+static TraceRing *_alTraceGetRing()
+{
+	SceUID thread = sceKernelGetThreadId();
+	TraceRing *ring = NULL;
+	int32_t owner = 0;
+
+	for (int i = 0; i < AL_TRACE_THREADS; i++)
+	{
+		if (s_traceRings[i].thread == thread)
+		{
+			return &s_traceRings[i];
+		}
+	}
+
+	// First call from this thread, claim a free ring
+	for (int i = 0; i < AL_TRACE_THREADS && ring == NULL; i++)
+	{
+		if (s_traceRings[i].thread == 0)
+		{
+			ring = _alTraceClaimRing(&s_traceRings[i], 0, thread);
+		}
+	}
+
+	// Application threads exit without telling us, take over the ring of one that is gone
+	for (int i = 0; i < AL_TRACE_THREADS && ring == NULL; i++)
+	{
+		owner = s_traceRings[i].thread;
+
+		if (owner != 0 && _alTraceThreadAlive(owner) == AL_FALSE)
+		{
+			ring = _alTraceClaimRing(&s_traceRings[i], owner, thread);
+		}
+	}
+
+	return ring;
+}
+
+ALvoid al::_alTraceThreadExit()
+{
+	SceUID thread = sceKernelGetThreadId();
+
+	sceAtomicIncrement32AcqRel(&s_traceWriters);
+
+	// A dump in progress may still be reading this ring, it is reclaimed later instead
+	if (sceAtomicLoad32AcqRel(&s_traceDumping) == 0)
+	{
+		for (int i = 0; i < AL_TRACE_THREADS; i++)
+		{
+			if (s_traceRings[i].thread == thread)
+			{
+				sceAtomicStore32AcqRel(&s_traceRings[i].count, 0);
+				sceAtomicStore32AcqRel(&s_traceRings[i].thread, 0);
+				break;
+			}
+		}
+	}
+
+	sceAtomicDecrement32AcqRel(&s_traceWriters);
+}
+
+ALvoid al::_alTraceRecord(const char *func, ALuint object, ALint arg, SceUInt64 begin, SceUInt64 end)
+{
+	TraceRing *ring = NULL;
+	TraceEvent *ev = NULL;
+	int32_t count = 0;
+
+	sceAtomicIncrement32AcqRel(&s_traceWriters);
+
+	if (sceAtomicLoad32AcqRel(&s_traceDumping) != 0)
+	{
+		sceAtomicDecrement32AcqRel(&s_traceWriters);
+		return;
+	}
+
+	ring = _alTraceGetRing();
+	if (ring == NULL || ring->pEvents == NULL)
+	{
+		sceAtomicDecrement32AcqRel(&s_traceWriters);
+		return;
+	}
+
+	count = ring->count;
+	ev = &ring->pEvents[count & (AL_TRACE_RING_EVENTS - 1)];
+
+	ev->begin = begin;
+	ev->duration = (SceUInt32)(end - begin);
+	ev->func = func;
+	ev->object = object;
+	ev->arg = arg;
+
+	sceAtomicStore32AcqRel(&ring->count, count + 1);
+
+	sceAtomicDecrement32AcqRel(&s_traceWriters);
+}
+
+static uint32_t _alTraceNameIndex(std::vector<const char *> &names, const char *func)
+{
+	// Function names are string literals, so the pointer identifies the function
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (names[i] == func)
+		{
+			return (uint32_t)i;
+		}
+	}
+
+	names.push_back(func);
+
+	return (uint32_t)(names.size() - 1);
+}
+
+ALboolean al::_alTraceDump(const ALchar *path)
+{
+	TraceFileHeader header;
+	TraceFileEvent batch[AL_TRACE_DUMP_BATCH];
+	std::vector<const char *> names;
+	ALboolean ok = AL_TRUE;
+	int32_t first[AL_TRACE_THREADS];
+	int32_t last[AL_TRACE_THREADS];
+	int32_t thread[AL_TRACE_THREADS];
+	uint32_t length = 0;
+	ALint fill = 0;
+	SceUID fd = SCE_UID_INVALID_UID;
+
+	// Recording stops for the duration so the rings hold still while they are read
+	if (sceAtomicCompareAndSwap32AcqRel(&s_traceDumping, 0, 1) != 0)
+	{
+		return AL_FALSE;
+	}
+
+	while (sceAtomicLoad32AcqRel(&s_traceWriters) != 0)
+	{
+		sceKernelDelayThread(AL_TRACE_DUMP_WAIT_US);
+	}
+
+	memset(&header, 0, sizeof(TraceFileHeader));
+	header.magic = AL_TRACE_FILE_MAGIC;
+	header.version = AL_TRACE_FILE_VERSION;
+
+	for (int i = 0; i < AL_TRACE_THREADS; i++)
+	{
+		first[i] = 0;
+		last[i] = 0;
+		thread[i] = s_traceRings[i].thread;
+
+		if (thread[i] == 0 || s_traceRings[i].pEvents == NULL)
+		{
+			continue;
+		}
+
+		last[i] = sceAtomicLoad32AcqRel(&s_traceRings[i].count);
+		first[i] = (last[i] > AL_TRACE_RING_EVENTS) ? last[i] - AL_TRACE_RING_EVENTS : 0;
+
+		for (int32_t j = first[i]; j < last[i]; j++)
+		{
+			_alTraceNameIndex(names, s_traceRings[i].pEvents[j & (AL_TRACE_RING_EVENTS - 1)].func);
+		}
+
+		header.eventCount += last[i] - first[i];
+	}
+
+	header.nameCount = names.size();
+
+	fd = sceIoOpen(path, SCE_O_WRONLY | SCE_O_CREAT | SCE_O_TRUNC, 0666);
+	if (fd < 0)
+	{
+		sceAtomicStore32AcqRel(&s_traceDumping, 0);
+		return AL_FALSE;
+	}
+
+	if (sceIoWrite(fd, &header, sizeof(TraceFileHeader)) != sizeof(TraceFileHeader))
+	{
+		ok = AL_FALSE;
+	}
+
+	for (size_t i = 0; i < names.size() && ok == AL_TRUE; i++)
+	{
+		length = strlen(names[i]);
+
+		if (sceIoWrite(fd, &length, sizeof(uint32_t)) != sizeof(uint32_t) || sceIoWrite(fd, names[i], length) != (SceSSize)length)
+		{
+			ok = AL_FALSE;
+		}
+	}
+
+	for (int i = 0; i < AL_TRACE_THREADS && ok == AL_TRUE; i++)
+	{
+		for (int32_t j = first[i]; j < last[i] && ok == AL_TRUE; j++)
+		{
+			const TraceEvent *ev = &s_traceRings[i].pEvents[j & (AL_TRACE_RING_EVENTS - 1)];
+
+			batch[fill].begin = ev->begin;
+			batch[fill].duration = ev->duration;
+			batch[fill].thread = (uint32_t)thread[i];
+			batch[fill].name = _alTraceNameIndex(names, ev->func);
+			batch[fill].object = ev->object;
+			batch[fill].arg = ev->arg;
+			batch[fill].reserved = 0;
+			fill++;
+
+			if (fill == AL_TRACE_DUMP_BATCH)
+			{
+				if (sceIoWrite(fd, batch, fill * sizeof(TraceFileEvent)) != (SceSSize)(fill * sizeof(TraceFileEvent)))
+				{
+					ok = AL_FALSE;
+				}
+
+				fill = 0;
+			}
+		}
+	}
+
+	if (fill > 0 && ok == AL_TRUE)
+	{
+		if (sceIoWrite(fd, batch, fill * sizeof(TraceFileEvent)) != (SceSSize)(fill * sizeof(TraceFileEvent)))
+		{
+			ok = AL_FALSE;
+		}
+	}
+
+	sceIoClose(fd);
+
+	sceAtomicStore32AcqRel(&s_traceDumping, 0);
+
+	return ok;
+}
@@ -0,0 +1,77 @@
+#ifndef AL_TRACE_H
+#define AL_TRACE_H
+
+#include <kernel.h>
+
+#include "AL/al.h"
+
+namespace al {
+
+	#define AL_TRACE_THREADS		(16)
+	#define AL_TRACE_RING_EVENTS	(2048)
+
+	#define AL_TRACE_FILE_MAGIC		(0x52544C41) // "ALTR"
+	#define AL_TRACE_FILE_VERSION	(1)
+
+	// Dump layout, little endian: header, nameCount names as a uint32_t length plus characters, then eventCount events
+	struct TraceFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t nameCount;
+		uint32_t eventCount;
+	};
+
+	struct TraceFileEvent
+	{
+		uint64_t begin;
+		uint32_t duration;
+		uint32_t thread;
+		uint32_t name;
+		uint32_t object;
+		int32_t arg;
+		uint32_t reserved;
+	};
+
+	// Located in trace.cpp
+	extern volatile ALboolean g_traceEnabled;
+
+	ALvoid _alTraceRecord(const char *func, ALuint object, ALint arg, SceUInt64 begin, SceUInt64 end);
+	ALboolean _alTraceDump(const ALchar *path);
+	ALvoid _alTraceThreadExit();
+
+	// Times one API call, costs a single load while tracing is off
+	class TraceScope
+	{
+	public:
+
+		TraceScope(const char *func, ALuint object, ALint arg)
+			: m_func(func),
+			m_object(object),
+			m_arg(arg),
+			m_begin(0)
+		{
+			if (g_traceEnabled == AL_TRUE)
+			{
+				m_begin = sceKernelGetProcessTimeWide();
+			}
+		}
+
+		~TraceScope()
+		{
+			if (m_begin != 0)
+			{
+				_alTraceRecord(m_func, m_object, m_arg, m_begin, sceKernelGetProcessTimeWide());
+			}
+		}
+
+	private:
+
+		const char *m_func;
+		ALuint m_object;
+		ALint m_arg;
+		SceUInt64 m_begin;
+	};
+}
+
+#endif
@@ -0,0 +1,113 @@
+// Voices mixed per core by the software backend at 48 kHz, run with a granule count to shorten it
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "backend.h"
+
+using namespace al;
+
+#define BENCH_FREQUENCY		(48000)
+#define BENCH_GRANULARITY	(256)
+#define BENCH_SOURCE_FRAMES	(44100)
+
+static double _benchCpuTime()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+static int _benchRun(const int16_t *pcm, ALint voiceCount, ALint granules)
+{
+	BackendSoft backend;
+	int16_t out[BENCH_GRANULARITY * 2];
+	const float32_t volumes[2][2] = { { 0.5f, 0.0f }, { 0.0f, 0.5f } };
+	ALint peak = 0;
+
+	if (backend.init(BENCH_GRANULARITY, BENCH_FREQUENCY, voiceCount) != AL_NO_ERROR)
+	{
+		printf("init failed for %d voices\n", voiceCount);
+		return -1;
+	}
+
+	for (int i = 0; i < voiceCount; i++)
+	{
+		Voice *voice = backend.acquireVoice();
+		PlayerParams *params = NULL;
+
+		if (voice == NULL || voice->lockPlayer(&params, LockSite_Api) != AL_NO_ERROR)
+		{
+			printf("voice %d unavailable\n", i);
+			return -1;
+		}
+
+		// 44.1 kHz looping data keeps the resampler on its fractional path, like most game assets
+		params->buffs[0].pBuffer = pcm;
+		params->buffs[0].nNumBytes = BENCH_SOURCE_FRAMES * sizeof(int16_t);
+		params->buffs[0].nLoopCount = AL_PLAYER_LOOP_CONTINUOUS;
+		params->buffs[0].nNextBuff = AL_PLAYER_NO_NEXT_BUFFER;
+		params->fPlaybackFrequency = 44100.0f;
+		params->fPlaybackScalar = 1.0f + (float32_t)(i % 7) * 0.01f;
+		params->nChannels = 1;
+		params->nStartBuffer = 0;
+		params->nStartByte = 0;
+		voice->unlockPlayer();
+
+		voice->setFilter(4000.0f + (float32_t)i);
+		voice->setPatchVolumes(volumes);
+		voice->play();
+	}
+
+	double begin = _benchCpuTime();
+
+	for (int i = 0; i < granules; i++)
+	{
+		backend.render(out);
+	}
+
+	double elapsed = _benchCpuTime() - begin;
+	double audio = (double)granules * BENCH_GRANULARITY / BENCH_FREQUENCY;
+
+	for (int i = 0; i < BENCH_GRANULARITY * 2; i++)
+	{
+		if (abs(out[i]) > peak)
+			peak = abs(out[i]);
+	}
+
+	printf("%4d voices: %8.2fx realtime, %8.0f voices per core\n", voiceCount, audio / elapsed, voiceCount * audio / elapsed);
+
+	// A silent mix means the voices never played and the figure above is meaningless
+	return (peak > 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+	static const ALint voiceCounts[] = { 16, 64, 256 };
+	ALint granules = (argc > 1) ? atoi(argv[1]) : 2000;
+	int16_t *pcm = (int16_t *)malloc(BENCH_SOURCE_FRAMES * sizeof(int16_t));
+	int ret = 0;
+
+	for (int i = 0; i < BENCH_SOURCE_FRAMES; i++)
+	{
+		pcm[i] = (int16_t)(sinf(6.2831853f * 440.0f * (float)i / 44100.0f) * 8000.0f);
+	}
+
+	printf("software mixer, %d Hz, %d frame granules\n", BENCH_FREQUENCY, BENCH_GRANULARITY);
+
+	for (unsigned i = 0; i < sizeof(voiceCounts) / sizeof(voiceCounts[0]); i++)
+	{
+		if (_benchRun(pcm, voiceCounts[i], granules) != 0)
+		{
+			ret = 1;
+		}
+	}
+
+	free(pcm);
+
+	return ret;
+}
@@ -0,0 +1,191 @@
+// Audio ports and the module loader. Ports keep the hardware clock, the samples themselves go nowhere
+#include <pthread.h>
+#include <string.h>
+
+#include "kernel.h"
+#include "audioout.h"
+#include "audioin.h"
+#include "libsysmodule.h"
+
+#define HOST_AUDIO_PORTS	(8)
+
+namespace {
+
+	struct Port
+	{
+		bool used;
+		SceInt32 len;
+		SceInt32 freq;
+		SceUInt64 nextTime;
+	};
+
+	pthread_mutex_t s_portLock = PTHREAD_MUTEX_INITIALIZER;
+	Port s_outPorts[HOST_AUDIO_PORTS];
+	Port s_inPorts[HOST_AUDIO_PORTS];
+
+	SceInt32 _openPort(Port *ports, SceInt32 len, SceInt32 freq)
+	{
+		SceInt32 ret = -1;
+
+		pthread_mutex_lock(&s_portLock);
+		for (int i = 0; i < HOST_AUDIO_PORTS; i++)
+		{
+			if (!ports[i].used)
+			{
+				ports[i].used = true;
+				ports[i].len = len;
+				ports[i].freq = freq;
+				ports[i].nextTime = 0;
+				ret = i + 1;
+				break;
+			}
+		}
+		pthread_mutex_unlock(&s_portLock);
+
+		return ret;
+	}
+
+	Port *_getPort(Port *ports, SceInt32 portId)
+	{
+		if (portId < 1 || portId > HOST_AUDIO_PORTS || !ports[portId - 1].used)
+		{
+			return NULL;
+		}
+
+		return &ports[portId - 1];
+	}
+
+	// Blocks until the port would have consumed one more grain, the way the hardware DMA paces its caller
+	void _pacePort(Port *port)
+	{
+		SceUInt64 now = sceKernelGetProcessTimeWide();
+		SceUInt64 grainTime = (SceUInt64)port->len * 1000000 / port->freq;
+
+		if (port->nextTime == 0 || now > port->nextTime + grainTime)
+		{
+			// First grain, or the caller fell behind and the port ran dry, the clock restarts from now
+			port->nextTime = now;
+		}
+		else if (now < port->nextTime)
+		{
+			sceKernelDelayThread((SceUInt32)(port->nextTime - now));
+		}
+
+		port->nextTime += grainTime;
+	}
+
+	bool s_moduleLoaded[0x100];
+}
+
+extern "C" {
+
+SceInt32 sceAudioOutOpenPort(SceInt32 portType, SceInt32 len, SceInt32 freq, SceInt32 param)
+{
+	if (len <= 0 || freq <= 0)
+	{
+		return SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+	}
+
+	SceInt32 ret = _openPort(s_outPorts, len, freq);
+
+	return (ret > 0) ? ret : SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+}
+
+SceInt32 sceAudioOutReleasePort(SceInt32 portId)
+{
+	Port *port = _getPort(s_outPorts, portId);
+
+	if (port == NULL)
+	{
+		return SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+	}
+
+	port->used = false;
+
+	return SCE_OK;
+}
+
+SceInt32 sceAudioOutOutput(SceInt32 portId, const void *buf)
+{
+	Port *port = _getPort(s_outPorts, portId);
+
+	if (port == NULL)
+	{
+		return SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+	}
+
+	// NULL only waits for the previous grain to drain
+	if (buf != NULL)
+	{
+		_pacePort(port);
+	}
+
+	return SCE_OK;
+}
+
+SceInt32 sceAudioOutSetVolume(SceInt32 portId, SceInt32 flag, SceInt32 *vol)
+{
+	return (_getPort(s_outPorts, portId) != NULL) ? SCE_OK : SCE_AUDIO_OUT_ERROR_INVALID_PORT;
+}
+
+SceInt32 sceAudioInOpenPort(SceInt32 portType, SceInt32 grain, SceUInt32 freq, SceInt32 param)
+{
+	if (grain <= 0 || freq == 0)
+	{
+		return SCE_AUDIO_IN_ERROR_INVALID_PORT;
+	}
+
+	SceInt32 ret = _openPort(s_inPorts, grain, (SceInt32)freq);
+
+	return (ret > 0) ? ret : SCE_AUDIO_IN_ERROR_INVALID_PORT;
+}
+
+SceInt32 sceAudioInReleasePort(SceInt32 portId)
+{
+	Port *port = _getPort(s_inPorts, portId);
+
+	if (port == NULL)
+	{
+		return SCE_AUDIO_IN_ERROR_INVALID_PORT;
+	}
+
+	port->used = false;
+
+	return SCE_OK;
+}
+
+SceInt32 sceAudioInInput(SceInt32 portId, void *destPtr)
+{
+	Port *port = _getPort(s_inPorts, portId);
+
+	if (port == NULL)
+	{
+		return SCE_AUDIO_IN_ERROR_INVALID_PORT;
+	}
+
+	_pacePort(port);
+	memset(destPtr, 0, port->len * sizeof(int16_t));
+
+	return SCE_OK;
+}
+
+SceInt32 sceSysmoduleIsLoaded(SceUInt16 id)
+{
+	return s_moduleLoaded[id & 0xFF] ? SCE_SYSMODULE_LOADED : SCE_SYSMODULE_ERROR_UNLOADED;
+}
+
+SceInt32 sceSysmoduleLoadModule(SceUInt16 id)
+{
+	s_moduleLoaded[id & 0xFF] = true;
+
+	return SCE_OK;
+}
+
+SceInt32 sceSysmoduleUnloadModule(SceUInt16 id)
+{
+	s_moduleLoaded[id & 0xFF] = false;
+
+	return SCE_OK;
+}
+
+}
@@ -0,0 +1,26 @@
+// Host stand-in for the SDK audio input, ports deliver silence at the real grain rate
+#ifndef HOST_SCE_AUDIOIN_H
+#define HOST_SCE_AUDIOIN_H
+
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCE_AUDIO_IN_PORT_TYPE_VOICE		(0)
+#define SCE_AUDIO_IN_PORT_TYPE_RAW			(0x2)
+
+#define SCE_AUDIO_IN_PARAM_FORMAT_S16_MONO	(0)
+
+#define SCE_AUDIO_IN_ERROR_INVALID_PORT		((SceInt32)0x80260104)
+
+SceInt32 sceAudioInOpenPort(SceInt32 portType, SceInt32 grain, SceUInt32 freq, SceInt32 param);
+SceInt32 sceAudioInReleasePort(SceInt32 portId);
+SceInt32 sceAudioInInput(SceInt32 portId, void *destPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+// Host stand-in for the SDK audio output, ports discard the data but block like the real clock would
+#ifndef HOST_SCE_AUDIOOUT_H
+#define HOST_SCE_AUDIOOUT_H
+
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCE_AUDIO_OUT_PORT_TYPE_MAIN			(0)
+#define SCE_AUDIO_OUT_PORT_TYPE_BGM				(1)
+#define SCE_AUDIO_OUT_PORT_TYPE_VOICE			(2)
+
+#define SCE_AUDIO_OUT_PARAM_FORMAT_S16_MONO		(0)
+#define SCE_AUDIO_OUT_PARAM_FORMAT_S16_STEREO	(1)
+
+#define SCE_AUDIO_VOLUME_0dB					(32768)
+#define SCE_AUDIO_VOLUME_FLAG_L_CH				(0x1)
+#define SCE_AUDIO_VOLUME_FLAG_R_CH				(0x2)
+
+#define SCE_AUDIO_OUT_ERROR_INVALID_PORT		((SceInt32)0x80260004)
+
+SceInt32 sceAudioOutOpenPort(SceInt32 portType, SceInt32 len, SceInt32 freq, SceInt32 param);
+SceInt32 sceAudioOutReleasePort(SceInt32 portId);
+SceInt32 sceAudioOutOutput(SceInt32 portId, const void *buf);
+SceInt32 sceAudioOutSetVolume(SceInt32 portId, SceInt32 flag, SceInt32 *vol);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,796 @@
+// Kernel objects over pthreads. UIDs index a process wide table, objects stay alive while a waiter still holds them
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "kernel.h"
+
+namespace {
+
+	struct Object
+	{
+		virtual ~Object() {}
+	};
+
+	struct Thread : Object
+	{
+		std::string name;
+		SceKernelThreadEntry entry;
+		SceInt32 affinity;
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+		bool started;
+		bool exited;
+		bool deleteOnExit;
+		SceInt32 exitStatus;
+		SceSize argSize;
+		void *pArgBlock;
+
+		Thread() : entry(NULL), affinity(0), started(false), exited(false), deleteOnExit(false), exitStatus(0), argSize(0), pArgBlock(NULL)
+		{
+			pthread_mutex_init(&lock, NULL);
+			pthread_cond_init(&cond, NULL);
+		}
+
+		~Thread()
+		{
+			free(pArgBlock);
+			pthread_cond_destroy(&cond);
+			pthread_mutex_destroy(&lock);
+		}
+	};
+
+	struct Sema : Object
+	{
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+		SceInt32 count;
+		SceInt32 maxCount;
+		bool deleted;
+
+		Sema() : count(0), maxCount(0), deleted(false)
+		{
+			pthread_mutex_init(&lock, NULL);
+			pthread_cond_init(&cond, NULL);
+		}
+
+		~Sema()
+		{
+			pthread_cond_destroy(&cond);
+			pthread_mutex_destroy(&lock);
+		}
+	};
+
+	struct EventFlag : Object
+	{
+		pthread_mutex_t lock;
+		pthread_cond_t cond;
+		SceUInt32 pattern;
+		bool deleted;
+
+		EventFlag() : pattern(0), deleted(false)
+		{
+			pthread_mutex_init(&lock, NULL);
+			pthread_cond_init(&cond, NULL);
+		}
+
+		~EventFlag()
+		{
+			pthread_cond_destroy(&cond);
+			pthread_mutex_destroy(&lock);
+		}
+	};
+
+	struct LwMutex
+	{
+		pthread_mutex_t lock;
+	};
+
+	pthread_mutex_t s_tableLock = PTHREAD_MUTEX_INITIALIZER;
+	std::map<SceUID, std::shared_ptr<Object> > s_objects;
+	SceUID s_nextUid = 0x40010001;
+
+	thread_local SceUID s_selfId = 0;
+	thread_local std::shared_ptr<Thread> s_self;
+
+	SceUID _addObject(const std::shared_ptr<Object> &object)
+	{
+		pthread_mutex_lock(&s_tableLock);
+		SceUID uid = s_nextUid;
+		s_nextUid += 2;
+		s_objects[uid] = object;
+		pthread_mutex_unlock(&s_tableLock);
+
+		return uid;
+	}
+
+	template<typename T> std::shared_ptr<T> _getObject(SceUID uid)
+	{
+		std::shared_ptr<T> ret;
+
+		pthread_mutex_lock(&s_tableLock);
+		std::map<SceUID, std::shared_ptr<Object> >::iterator it = s_objects.find(uid);
+		if (it != s_objects.end())
+		{
+			ret = std::dynamic_pointer_cast<T>(it->second);
+		}
+		pthread_mutex_unlock(&s_tableLock);
+
+		return ret;
+	}
+
+	bool _removeObject(SceUID uid)
+	{
+		pthread_mutex_lock(&s_tableLock);
+		bool found = s_objects.erase(uid) != 0;
+		pthread_mutex_unlock(&s_tableLock);
+
+		return found;
+	}
+
+	void _finishThread(SceInt32 status)
+	{
+		if (!s_self)
+		{
+			return;
+		}
+
+		pthread_mutex_lock(&s_self->lock);
+		s_self->exited = true;
+		s_self->exitStatus = status;
+		pthread_cond_broadcast(&s_self->cond);
+		pthread_mutex_unlock(&s_self->lock);
+	}
+
+	struct ThreadExit
+	{
+		SceInt32 status;
+	};
+
+	void *_threadMain(void *pArg)
+	{
+		s_self = *(std::shared_ptr<Thread> *)pArg;
+		delete (std::shared_ptr<Thread> *)pArg;
+
+		pthread_mutex_lock(&s_tableLock);
+		for (std::map<SceUID, std::shared_ptr<Object> >::iterator it = s_objects.begin(); it != s_objects.end(); ++it)
+		{
+			if (it->second == s_self)
+			{
+				s_selfId = it->first;
+			}
+		}
+		pthread_mutex_unlock(&s_tableLock);
+
+		SceInt32 status = 0;
+
+		// sceKernelExitThread unwinds back to here so the thread object sees the exit either way
+		try
+		{
+			status = s_self->entry(s_self->argSize, s_self->pArgBlock);
+		}
+		catch (ThreadExit &exit)
+		{
+			status = exit.status;
+		}
+
+		// Off the table before the joiner wakes, after that it may tear everything down up to the table itself
+		if (s_self->deleteOnExit)
+		{
+			_removeObject(s_selfId);
+		}
+
+		_finishThread(status);
+
+		s_self.reset();
+
+		return NULL;
+	}
+
+	SceUInt64 _monotonicMicros()
+	{
+		struct timespec ts;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		return (SceUInt64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+	}
+
+	const SceUInt64 s_processStart = _monotonicMicros();
+
+	void _addMicros(struct timespec *ts, SceUInt32 us)
+	{
+		clock_gettime(CLOCK_REALTIME, ts);
+		ts->tv_sec += us / 1000000;
+		ts->tv_nsec += (long)(us % 1000000) * 1000;
+		if (ts->tv_nsec >= 1000000000)
+		{
+			ts->tv_sec++;
+			ts->tv_nsec -= 1000000000;
+		}
+	}
+
+	LwMutex *_getLwMutex(SceKernelLwMutexWork *pWork)
+	{
+		LwMutex *mutex = NULL;
+
+		memcpy(&mutex, pWork->data, sizeof(LwMutex *));
+
+		return mutex;
+	}
+}
+
+extern "C" {
+
+SceUID sceKernelCreateThread(const char *pName, SceKernelThreadEntry entry, SceInt32 initPriority, SceSize stackSize, SceUInt32 attr, SceInt32 cpuAffinityMask, const void *pOptParam)
+{
+	std::shared_ptr<Thread> thread(new Thread());
+
+	thread->name = (pName != NULL) ? pName : "";
+	thread->entry = entry;
+	thread->affinity = cpuAffinityMask;
+
+	return _addObject(thread);
+}
+
+SceInt32 sceKernelStartThread(SceUID threadId, SceSize argSize, const void *pArgBlock)
+{
+	std::shared_ptr<Thread> thread = _getObject<Thread>(threadId);
+	pthread_t handle;
+
+	if (!thread || thread->started)
+	{
+		return SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID;
+	}
+
+	// The argument block is copied like the kernel copies it onto the new stack
+	thread->argSize = argSize;
+	if (argSize > 0)
+	{
+		thread->pArgBlock = malloc(argSize);
+		memcpy(thread->pArgBlock, pArgBlock, argSize);
+	}
+
+	thread->started = true;
+
+	std::shared_ptr<Thread> *arg = new std::shared_ptr<Thread>(thread);
+	if (pthread_create(&handle, NULL, _threadMain, arg) != 0)
+	{
+		delete arg;
+		thread->started = false;
+		return SCE_KERNEL_ERROR_ERROR;
+	}
+
+	pthread_detach(handle);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelExitThread(SceInt32 exitStatus)
+{
+	ThreadExit exit = { exitStatus };
+
+	throw exit;
+}
+
+SceInt32 sceKernelExitDeleteThread(SceInt32 exitStatus)
+{
+	if (s_self)
+	{
+		s_self->deleteOnExit = true;
+	}
+
+	return sceKernelExitThread(exitStatus);
+}
+
+SceInt32 sceKernelWaitThreadEnd(SceUID threadId, SceInt32 *pExitStatus, SceUInt32 *pTimeout)
+{
+	std::shared_ptr<Thread> thread = _getObject<Thread>(threadId);
+
+	if (!thread)
+	{
+		return SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID;
+	}
+
+	pthread_mutex_lock(&thread->lock);
+	while (thread->started && !thread->exited)
+	{
+		pthread_cond_wait(&thread->cond, &thread->lock);
+	}
+	if (pExitStatus != NULL)
+	{
+		*pExitStatus = thread->exitStatus;
+	}
+	pthread_mutex_unlock(&thread->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelDeleteThread(SceUID threadId)
+{
+	return _removeObject(threadId) ? SCE_OK : SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID;
+}
+
+SceInt32 sceKernelDelayThread(SceUInt32 usec)
+{
+	struct timespec ts;
+
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (long)(usec % 1000000) * 1000;
+
+	while (nanosleep(&ts, &ts) != 0 && errno == EINTR)
+	{
+
+	}
+
+	return SCE_OK;
+}
+
+SceUID sceKernelGetThreadId(void)
+{
+	// Threads the host created itself get an id the first time they ask
+	if (s_selfId == 0)
+	{
+		std::shared_ptr<Thread> thread(new Thread());
+
+		thread->name = "host";
+		thread->started = true;
+		s_selfId = _addObject(thread);
+		s_self = thread;
+	}
+
+	return s_selfId;
+}
+
+SceInt32 sceKernelGetThreadInfo(SceUID threadId, SceKernelThreadInfo *pInfo)
+{
+	std::shared_ptr<Thread> thread = _getObject<Thread>(threadId);
+
+	if (!thread)
+	{
+		return SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID;
+	}
+
+	pthread_mutex_lock(&thread->lock);
+	bool exited = thread->exited;
+	pthread_mutex_unlock(&thread->lock);
+
+	if (exited)
+	{
+		return SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID;
+	}
+
+	if (pInfo != NULL)
+	{
+		memset(pInfo, 0, sizeof(SceKernelThreadInfo));
+		pInfo->size = sizeof(SceKernelThreadInfo);
+		strncpy(pInfo->name, thread->name.c_str(), sizeof(pInfo->name) - 1);
+	}
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelCreateLwMutex(SceKernelLwMutexWork *pWork, const char *pName, SceUInt32 attr, SceInt32 initCount, const void *pOptParam)
+{
+	LwMutex *mutex = new LwMutex();
+	pthread_mutexattr_t mutexAttr;
+
+	// Recursive so a nested lock from the owner neither deadlocks nor drops the outer hold
+	pthread_mutexattr_init(&mutexAttr);
+	pthread_mutexattr_settype(&mutexAttr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mutex->lock, &mutexAttr);
+	pthread_mutexattr_destroy(&mutexAttr);
+
+	memset(pWork, 0, sizeof(SceKernelLwMutexWork));
+	memcpy(pWork->data, &mutex, sizeof(LwMutex *));
+
+	for (SceInt32 i = 0; i < initCount; i++)
+	{
+		pthread_mutex_lock(&mutex->lock);
+	}
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelDeleteLwMutex(SceKernelLwMutexWork *pWork)
+{
+	LwMutex *mutex = _getLwMutex(pWork);
+
+	if (mutex == NULL)
+	{
+		return SCE_KERNEL_ERROR_ERROR;
+	}
+
+	pthread_mutex_destroy(&mutex->lock);
+	delete mutex;
+	memset(pWork, 0, sizeof(SceKernelLwMutexWork));
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelLockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 lockCount, SceUInt32 *pTimeout)
+{
+	LwMutex *mutex = _getLwMutex(pWork);
+
+	if (mutex == NULL)
+	{
+		return SCE_KERNEL_ERROR_ERROR;
+	}
+
+	for (SceInt32 i = 0; i < lockCount; i++)
+	{
+		pthread_mutex_lock(&mutex->lock);
+	}
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelTryLockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 lockCount)
+{
+	LwMutex *mutex = _getLwMutex(pWork);
+
+	if (mutex == NULL || pthread_mutex_trylock(&mutex->lock) != 0)
+	{
+		return SCE_KERNEL_ERROR_LW_MUTEX_FAILED_TO_OWN;
+	}
+
+	for (SceInt32 i = 1; i < lockCount; i++)
+	{
+		pthread_mutex_lock(&mutex->lock);
+	}
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelUnlockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 unlockCount)
+{
+	LwMutex *mutex = _getLwMutex(pWork);
+
+	if (mutex == NULL)
+	{
+		return SCE_KERNEL_ERROR_ERROR;
+	}
+
+	for (SceInt32 i = 0; i < unlockCount; i++)
+	{
+		pthread_mutex_unlock(&mutex->lock);
+	}
+
+	return SCE_OK;
+}
+
+SceUID sceKernelCreateSema(const char *pName, SceUInt32 attr, SceInt32 initCount, SceInt32 maxCount, const void *pOptParam)
+{
+	std::shared_ptr<Sema> sema(new Sema());
+
+	sema->count = initCount;
+	sema->maxCount = maxCount;
+
+	return _addObject(sema);
+}
+
+SceInt32 sceKernelDeleteSema(SceUID semaId)
+{
+	std::shared_ptr<Sema> sema = _getObject<Sema>(semaId);
+
+	if (!sema)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID;
+	}
+
+	_removeObject(semaId);
+
+	pthread_mutex_lock(&sema->lock);
+	sema->deleted = true;
+	pthread_cond_broadcast(&sema->cond);
+	pthread_mutex_unlock(&sema->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelSignalSema(SceUID semaId, SceInt32 signalCount)
+{
+	std::shared_ptr<Sema> sema = _getObject<Sema>(semaId);
+
+	if (!sema)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID;
+	}
+
+	pthread_mutex_lock(&sema->lock);
+	sema->count += signalCount;
+	if (sema->count > sema->maxCount)
+	{
+		sema->count = sema->maxCount;
+	}
+	pthread_cond_broadcast(&sema->cond);
+	pthread_mutex_unlock(&sema->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelWaitSema(SceUID semaId, SceInt32 needCount, SceUInt32 *pTimeout)
+{
+	std::shared_ptr<Sema> sema = _getObject<Sema>(semaId);
+	SceInt32 ret = SCE_OK;
+	struct timespec deadline;
+
+	if (!sema)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID;
+	}
+
+	if (pTimeout != NULL)
+	{
+		_addMicros(&deadline, *pTimeout);
+	}
+
+	pthread_mutex_lock(&sema->lock);
+	while (!sema->deleted && sema->count < needCount)
+	{
+		if (pTimeout == NULL)
+		{
+			pthread_cond_wait(&sema->cond, &sema->lock);
+		}
+		else if (pthread_cond_timedwait(&sema->cond, &sema->lock, &deadline) == ETIMEDOUT)
+		{
+			break;
+		}
+	}
+
+	if (sema->deleted || sema->count < needCount)
+	{
+		ret = SCE_KERNEL_ERROR_ERROR;
+	}
+	else
+	{
+		sema->count -= needCount;
+	}
+	pthread_mutex_unlock(&sema->lock);
+
+	return ret;
+}
+
+SceInt32 sceKernelPollSema(SceUID semaId, SceInt32 needCount)
+{
+	std::shared_ptr<Sema> sema = _getObject<Sema>(semaId);
+	SceInt32 ret = SCE_OK;
+
+	if (!sema)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID;
+	}
+
+	pthread_mutex_lock(&sema->lock);
+	if (sema->count < needCount)
+	{
+		ret = SCE_KERNEL_ERROR_SEMA_ZERO;
+	}
+	else
+	{
+		sema->count -= needCount;
+	}
+	pthread_mutex_unlock(&sema->lock);
+
+	return ret;
+}
+
+SceUID sceKernelCreateEventFlag(const char *pName, SceUInt32 attr, SceUInt32 initPattern, const void *pOptParam)
+{
+	std::shared_ptr<EventFlag> evf(new EventFlag());
+
+	evf->pattern = initPattern;
+
+	return _addObject(evf);
+}
+
+SceInt32 sceKernelDeleteEventFlag(SceUID evfId)
+{
+	std::shared_ptr<EventFlag> evf = _getObject<EventFlag>(evfId);
+
+	if (!evf)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_EVF_ID;
+	}
+
+	_removeObject(evfId);
+
+	pthread_mutex_lock(&evf->lock);
+	evf->deleted = true;
+	pthread_cond_broadcast(&evf->cond);
+	pthread_mutex_unlock(&evf->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelSetEventFlag(SceUID evfId, SceUInt32 bitPattern)
+{
+	std::shared_ptr<EventFlag> evf = _getObject<EventFlag>(evfId);
+
+	if (!evf)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_EVF_ID;
+	}
+
+	pthread_mutex_lock(&evf->lock);
+	evf->pattern |= bitPattern;
+	pthread_cond_broadcast(&evf->cond);
+	pthread_mutex_unlock(&evf->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelClearEventFlag(SceUID evfId, SceUInt32 bitPattern)
+{
+	std::shared_ptr<EventFlag> evf = _getObject<EventFlag>(evfId);
+
+	if (!evf)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_EVF_ID;
+	}
+
+	// Like the kernel, the pattern is ANDed in, the bits left at zero are the ones cleared
+	pthread_mutex_lock(&evf->lock);
+	evf->pattern &= bitPattern;
+	pthread_mutex_unlock(&evf->lock);
+
+	return SCE_OK;
+}
+
+SceInt32 sceKernelWaitEventFlag(SceUID evfId, SceUInt32 bitPattern, SceUInt32 waitMode, SceUInt32 *pResultPat, SceUInt32 *pTimeout)
+{
+	std::shared_ptr<EventFlag> evf = _getObject<EventFlag>(evfId);
+	SceInt32 ret = SCE_OK;
+	struct timespec deadline;
+
+	if (!evf)
+	{
+		return SCE_KERNEL_ERROR_UNKNOWN_EVF_ID;
+	}
+
+	if (pTimeout != NULL)
+	{
+		_addMicros(&deadline, *pTimeout);
+	}
+
+	pthread_mutex_lock(&evf->lock);
+	for (;;)
+	{
+		bool match = (waitMode & SCE_KERNEL_EVF_WAITMODE_OR) ?
+			(evf->pattern & bitPattern) != 0 :
+			(evf->pattern & bitPattern) == bitPattern;
+
+		if (match || evf->deleted)
+		{
+			ret = match ? SCE_OK : SCE_KERNEL_ERROR_ERROR;
+			break;
+		}
+
+		if (pTimeout == NULL)
+		{
+			pthread_cond_wait(&evf->cond, &evf->lock);
+		}
+		else if (pthread_cond_timedwait(&evf->cond, &evf->lock, &deadline) == ETIMEDOUT)
+		{
+			ret = SCE_KERNEL_ERROR_ERROR;
+			break;
+		}
+	}
+
+	if (pResultPat != NULL)
+	{
+		*pResultPat = evf->pattern;
+	}
+
+	if (ret == SCE_OK)
+	{
+		if (waitMode & SCE_KERNEL_EVF_WAITMODE_CLEAR_ALL)
+			evf->pattern = 0;
+		else if (waitMode & SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT)
+			evf->pattern &= ~bitPattern;
+	}
+	pthread_mutex_unlock(&evf->lock);
+
+	return ret;
+}
+
+SceUInt64 sceKernelGetProcessTimeWide(void)
+{
+	// Offset so the first reading is not zero, the library uses zero as "no timestamp yet"
+	return _monotonicMicros() - s_processStart + 1;
+}
+
+SceUID sceKernelLoadStartModule(const char *moduleFileName, SceSize args, const void *argp, SceUInt32 flags, const void *pOpt, SceInt32 *pRes)
+{
+	// The library is linked in statically on the host, there is nothing to load
+	if (pRes != NULL)
+	{
+		*pRes = 0;
+	}
+
+	return 0x40000001;
+}
+
+SceInt32 sceClibPrintf(const char *pFmt, ...)
+{
+	va_list args;
+
+	va_start(args, pFmt);
+	SceInt32 ret = vprintf(pFmt, args);
+	va_end(args);
+
+	return ret;
+}
+
+SceUID sceIoOpen(const char *filename, SceInt32 flag, SceInt32 mode)
+{
+	std::string path = filename;
+	int flags = 0;
+
+	// "ux0:data/file" lives at ux0/data/file under the working directory
+	size_t colon = path.find(':');
+	if (colon != std::string::npos && path.find('/') > colon)
+	{
+		path[colon] = '/';
+		if (colon + 1 < path.size() && path[colon + 1] == '/')
+		{
+			path.erase(colon + 1, 1);
+		}
+	}
+
+	if ((flag & SCE_O_RDWR) == SCE_O_RDWR)
+		flags = O_RDWR;
+	else if (flag & SCE_O_WRONLY)
+		flags = O_WRONLY;
+	else
+		flags = O_RDONLY;
+
+	if (flag & SCE_O_CREAT)
+		flags |= O_CREAT;
+	if (flag & SCE_O_TRUNC)
+		flags |= O_TRUNC;
+	if (flag & SCE_O_APPEND)
+		flags |= O_APPEND;
+
+	int fd = open(path.c_str(), flags, mode);
+
+	return (fd >= 0) ? fd : SCE_KERNEL_ERROR_ERROR;
+}
+
+SceInt32 sceIoClose(SceUID fd)
+{
+	return (close(fd) == 0) ? SCE_OK : SCE_KERNEL_ERROR_ERROR;
+}
+
+SceSSize sceIoRead(SceUID fd, void *buf, SceSize nbyte)
+{
+	ssize_t ret = read(fd, buf, nbyte);
+
+	return (ret >= 0) ? (SceSSize)ret : SCE_KERNEL_ERROR_ERROR;
+}
+
+SceSSize sceIoWrite(SceUID fd, const void *buf, SceSize nbyte)
+{
+	ssize_t ret = write(fd, buf, nbyte);
+
+	return (ret >= 0) ? (SceSSize)ret : SCE_KERNEL_ERROR_ERROR;
+}
+
+SceOff sceIoLseek(SceUID fd, SceOff offset, SceInt32 whence)
+{
+	off_t ret = lseek(fd, (off_t)offset, (whence == SCE_SEEK_END) ? SEEK_END : (whence == SCE_SEEK_CUR) ? SEEK_CUR : SEEK_SET);
+
+	return (ret >= 0) ? (SceOff)ret : SCE_KERNEL_ERROR_ERROR;
+}
+
+}
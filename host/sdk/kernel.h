@@ -0,0 +1,143 @@
+// Host stand-in for the SDK kernel header, just what OpenALHW and its tools call, implemented in kernel.cpp
+#ifndef HOST_SCE_KERNEL_H
+#define HOST_SCE_KERNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int8_t SceInt8;
+typedef uint8_t SceUInt8;
+typedef int16_t SceInt16;
+typedef uint16_t SceUInt16;
+typedef int32_t SceInt32;
+typedef uint32_t SceUInt32;
+typedef int64_t SceInt64;
+typedef uint64_t SceUInt64;
+typedef float SceFloat32;
+typedef float float32_t;
+typedef void SceVoid;
+typedef void *ScePVoid;
+typedef unsigned int SceSize;
+typedef int SceSSize;
+typedef int SceUID;
+typedef char SceChar8;
+typedef int SceBool;
+typedef int64_t SceOff;
+typedef SceUInt64 SceKernelSysClock;
+
+typedef struct SceFVector4
+{
+	SceFloat32 x, y, z, w;
+} SceFVector4;
+
+// Holds a pointer to the host lock, the size matches the real work area
+typedef struct SceKernelLwMutexWork
+{
+	int64_t data[4];
+} SceKernelLwMutexWork;
+
+typedef struct SceKernelThreadInfo
+{
+	SceSize size;
+	SceUID processId;
+	char name[32];
+	SceUInt32 attr;
+	SceUInt32 status;
+} SceKernelThreadInfo;
+
+typedef SceInt32 (*SceKernelThreadEntry)(SceSize argSize, void *pArgBlock);
+
+#define SCE_OK								(0)
+#define SCE_UID_INVALID_UID					(-1)
+
+#define SCE_KERNEL_ERROR_ERROR				((SceInt32)0x80020001)
+#define SCE_KERNEL_ERROR_ILLEGAL_THREAD_ID	((SceInt32)0x80028001)
+#define SCE_KERNEL_ERROR_UNKNOWN_SEMA_ID	((SceInt32)0x800281E2)
+#define SCE_KERNEL_ERROR_SEMA_ZERO			((SceInt32)0x800281E6)
+#define SCE_KERNEL_ERROR_LW_MUTEX_FAILED_TO_OWN	((SceInt32)0x800281EB)
+#define SCE_KERNEL_ERROR_UNKNOWN_EVF_ID		((SceInt32)0x80028224)
+
+#define SCE_KERNEL_HIGHEST_PRIORITY_USER	(64)
+#define SCE_KERNEL_DEFAULT_PRIORITY_USER	(160)
+#define SCE_KERNEL_LOWEST_PRIORITY_USER		(191)
+
+#define SCE_KERNEL_4KiB						(4 * 1024)
+#define SCE_KERNEL_16KiB					(16 * 1024)
+
+#define SCE_KERNEL_CPU_MASK_USER_0			(0x1 << 16)
+#define SCE_KERNEL_CPU_MASK_USER_1			(0x1 << 17)
+#define SCE_KERNEL_CPU_MASK_USER_2			(0x1 << 18)
+#define SCE_KERNEL_CPU_MASK_USER_ALL		(0x7 << 16)
+#define SCE_KERNEL_THREAD_CPU_AFFINITY_MASK_DEFAULT	(0)
+
+#define SCE_KERNEL_SEMA_ATTR_TH_FIFO		(0x0)
+#define SCE_KERNEL_SEMA_ATTR_TH_PRIO		(0x2000)
+
+#define SCE_KERNEL_EVF_ATTR_TH_FIFO			(0x0)
+#define SCE_KERNEL_EVF_ATTR_SINGLE			(0x0)
+#define SCE_KERNEL_EVF_ATTR_MULTI			(0x1000)
+#define SCE_KERNEL_EVF_WAITMODE_AND			(0x0)
+#define SCE_KERNEL_EVF_WAITMODE_OR			(0x1)
+#define SCE_KERNEL_EVF_WAITMODE_CLEAR_ALL	(0x2)
+#define SCE_KERNEL_EVF_WAITMODE_CLEAR_PAT	(0x4)
+
+#define SCE_O_RDONLY						(0x0001)
+#define SCE_O_WRONLY						(0x0002)
+#define SCE_O_RDWR							(SCE_O_RDONLY | SCE_O_WRONLY)
+#define SCE_O_APPEND						(0x0100)
+#define SCE_O_CREAT							(0x0200)
+#define SCE_O_TRUNC							(0x0400)
+
+#define SCE_SEEK_SET						(0)
+#define SCE_SEEK_CUR						(1)
+#define SCE_SEEK_END						(2)
+
+SceUID sceKernelCreateThread(const char *pName, SceKernelThreadEntry entry, SceInt32 initPriority, SceSize stackSize, SceUInt32 attr, SceInt32 cpuAffinityMask, const void *pOptParam);
+SceInt32 sceKernelStartThread(SceUID threadId, SceSize argSize, const void *pArgBlock);
+SceInt32 sceKernelExitThread(SceInt32 exitStatus);
+SceInt32 sceKernelExitDeleteThread(SceInt32 exitStatus);
+SceInt32 sceKernelWaitThreadEnd(SceUID threadId, SceInt32 *pExitStatus, SceUInt32 *pTimeout);
+SceInt32 sceKernelDeleteThread(SceUID threadId);
+SceInt32 sceKernelDelayThread(SceUInt32 usec);
+SceUID sceKernelGetThreadId(void);
+SceInt32 sceKernelGetThreadInfo(SceUID threadId, SceKernelThreadInfo *pInfo);
+
+SceInt32 sceKernelCreateLwMutex(SceKernelLwMutexWork *pWork, const char *pName, SceUInt32 attr, SceInt32 initCount, const void *pOptParam);
+SceInt32 sceKernelDeleteLwMutex(SceKernelLwMutexWork *pWork);
+SceInt32 sceKernelLockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 lockCount, SceUInt32 *pTimeout);
+SceInt32 sceKernelTryLockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 lockCount);
+SceInt32 sceKernelUnlockLwMutex(SceKernelLwMutexWork *pWork, SceInt32 unlockCount);
+
+SceUID sceKernelCreateSema(const char *pName, SceUInt32 attr, SceInt32 initCount, SceInt32 maxCount, const void *pOptParam);
+SceInt32 sceKernelDeleteSema(SceUID semaId);
+SceInt32 sceKernelSignalSema(SceUID semaId, SceInt32 signalCount);
+SceInt32 sceKernelWaitSema(SceUID semaId, SceInt32 needCount, SceUInt32 *pTimeout);
+SceInt32 sceKernelPollSema(SceUID semaId, SceInt32 needCount);
+
+SceUID sceKernelCreateEventFlag(const char *pName, SceUInt32 attr, SceUInt32 initPattern, const void *pOptParam);
+SceInt32 sceKernelDeleteEventFlag(SceUID evfId);
+SceInt32 sceKernelSetEventFlag(SceUID evfId, SceUInt32 bitPattern);
+SceInt32 sceKernelClearEventFlag(SceUID evfId, SceUInt32 bitPattern);
+SceInt32 sceKernelWaitEventFlag(SceUID evfId, SceUInt32 bitPattern, SceUInt32 waitMode, SceUInt32 *pResultPat, SceUInt32 *pTimeout);
+
+SceUInt64 sceKernelGetProcessTimeWide(void);
+
+SceUID sceKernelLoadStartModule(const char *moduleFileName, SceSize args, const void *argp, SceUInt32 flags, const void *pOpt, SceInt32 *pRes);
+
+SceInt32 sceClibPrintf(const char *pFmt, ...);
+
+SceUID sceIoOpen(const char *filename, SceInt32 flag, SceInt32 mode);
+SceInt32 sceIoClose(SceUID fd);
+SceSSize sceIoRead(SceUID fd, void *buf, SceSize nbyte);
+SceSSize sceIoWrite(SceUID fd, const void *buf, SceSize nbyte);
+SceOff sceIoLseek(SceUID fd, SceOff offset, SceInt32 whence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,11 @@
+// Host stand-in for the SDK debug log macros
+#ifndef HOST_SCE_LIBDBG_H
+#define HOST_SCE_LIBDBG_H
+
+#include <stdio.h>
+
+#define SCE_DBG_LOG_ERROR(...)		fprintf(stderr, __VA_ARGS__)
+#define SCE_DBG_LOG_WARNING(...)	fprintf(stderr, __VA_ARGS__)
+#define SCE_DBG_LOG_INFO(...)		((void)0)
+
+#endif
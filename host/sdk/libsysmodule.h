@@ -0,0 +1,24 @@
+// Host stand-in for the SDK module loader, every module counts as loadable
+#ifndef HOST_SCE_LIBSYSMODULE_H
+#define HOST_SCE_LIBSYSMODULE_H
+
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCE_SYSMODULE_NGS				(0x000B)
+
+#define SCE_SYSMODULE_LOADED			(0)
+#define SCE_SYSMODULE_ERROR_UNLOADED	((SceInt32)0x805A1000)
+
+SceInt32 sceSysmoduleIsLoaded(SceUInt16 id);
+SceInt32 sceSysmoduleLoadModule(SceUInt16 id);
+SceInt32 sceSysmoduleUnloadModule(SceUInt16 id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
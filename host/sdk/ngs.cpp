@@ -0,0 +1,1079 @@
+// NGS stand-in that really mixes: PCM players with linear resampling, the one-pole send filter,
+// 2x2 patch matrices into a master buss, and the player callbacks, one granule per sceNgsSystemUpdate
+#include <pthread.h>
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "kernel.h"
+#include "ngs.h"
+
+#define HOST_NGS_TWO_PI			(6.28318530718f)
+#define HOST_NGS_FILTER_CHANNELS	(2)
+
+namespace {
+
+	enum HandleType
+	{
+		HandleType_System = 1,
+		HandleType_Rack,
+		HandleType_Voice,
+		HandleType_Patch
+	};
+
+	struct NgsSystem;
+	struct NgsRack;
+	struct NgsVoice;
+
+	struct NgsPatch
+	{
+		SceNgsHPatch handle;
+		NgsVoice *pSource;
+		NgsVoice *pDest;
+		SceNgsVolumeMatrix vols;
+	};
+
+	struct NgsVoice
+	{
+		SceNgsHVoice handle;
+		NgsRack *pRack;
+		bool master;
+
+		SceUInt32 state;
+		bool paused;
+
+		SceNgsPlayerParams player;
+		SceNgsPlayerParams playerStage;
+		bool playerLocked;
+		SceNgsFilterParams filter[HOST_NGS_FILTER_CHANNELS];
+		SceNgsFilterParams filterStage[HOST_NGS_FILTER_CHANNELS];
+		bool filterLocked;
+		bool filterBypassed;
+
+		SceNgsModuleCallbackFunc callback;
+		void *pUserData;
+
+		SceInt32 bufIdx;
+		SceInt32 framePos;
+		float frac;
+		SceInt32 loopsLeft;
+		SceInt32 bytesConsumed;
+		SceInt32 samplesGenerated;
+		SceInt32 totalBytes;
+		float filterState[HOST_NGS_FILTER_CHANNELS];
+
+		std::vector<NgsPatch *> outputs;
+		std::vector<float> scratch;
+		std::vector<float> input;
+		std::vector<int16_t> output;
+	};
+
+	struct NgsRack
+	{
+		SceNgsHRack handle;
+		NgsSystem *pSystem;
+		bool master;
+		std::vector<NgsVoice *> voices;
+	};
+
+	struct NgsSystem
+	{
+		SceNgsHSynSystem handle;
+		pthread_mutex_t lock;
+		SceInt32 granularity;
+		SceInt32 sampleRate;
+		SceInt32 maxVoices;
+		SceInt32 maxRacks;
+		SceInt32 voiceCount;
+		std::vector<NgsRack *> racks;
+	};
+
+	struct Event
+	{
+		SceNgsModuleCallbackFunc callback;
+		SceNgsCallbackInfo info;
+	};
+
+	struct Handle
+	{
+		HandleType type;
+		void *pObject;
+	};
+
+	const SceNgsVoiceDefinition s_simpleVoice = { 1 };
+	const SceNgsVoiceDefinition s_masterBuss = { 2 };
+
+	pthread_mutex_t s_handleLock = PTHREAD_MUTEX_INITIALIZER;
+	std::vector<Handle> s_handles;
+
+	SceUInt32 _addHandle(HandleType type, void *pObject)
+	{
+		SceUInt32 ret = 0;
+
+		pthread_mutex_lock(&s_handleLock);
+		for (size_t i = 0; i < s_handles.size(); i++)
+		{
+			if (s_handles[i].pObject == NULL)
+			{
+				s_handles[i].type = type;
+				s_handles[i].pObject = pObject;
+				ret = (SceUInt32)i + 1;
+				break;
+			}
+		}
+
+		if (ret == 0)
+		{
+			Handle handle = { type, pObject };
+			s_handles.push_back(handle);
+			ret = (SceUInt32)s_handles.size();
+		}
+		pthread_mutex_unlock(&s_handleLock);
+
+		return ret;
+	}
+
+	void *_getHandle(SceUInt32 handle, HandleType type)
+	{
+		void *ret = NULL;
+
+		pthread_mutex_lock(&s_handleLock);
+		if (handle > 0 && handle <= s_handles.size() && s_handles[handle - 1].type == type)
+		{
+			ret = s_handles[handle - 1].pObject;
+		}
+		pthread_mutex_unlock(&s_handleLock);
+
+		return ret;
+	}
+
+	void _removeHandle(SceUInt32 handle)
+	{
+		pthread_mutex_lock(&s_handleLock);
+		if (handle > 0 && handle <= s_handles.size())
+		{
+			s_handles[handle - 1].pObject = NULL;
+		}
+		pthread_mutex_unlock(&s_handleLock);
+	}
+
+	NgsVoice *_lockVoice(SceNgsHVoice handle)
+	{
+		NgsVoice *voice = (NgsVoice *)_getHandle(handle, HandleType_Voice);
+
+		if (voice != NULL)
+		{
+			pthread_mutex_lock(&voice->pRack->pSystem->lock);
+		}
+
+		return voice;
+	}
+
+	void _unlockVoice(NgsVoice *pVoice)
+	{
+		pthread_mutex_unlock(&pVoice->pRack->pSystem->lock);
+	}
+
+	void _removePatch(NgsPatch *pPatch)
+	{
+		std::vector<NgsPatch *> &outputs = pPatch->pSource->outputs;
+
+		outputs.erase(std::remove(outputs.begin(), outputs.end(), pPatch), outputs.end());
+		_removeHandle(pPatch->handle);
+		delete pPatch;
+	}
+
+	void _releaseRack(NgsRack *pRack)
+	{
+		NgsSystem *system = pRack->pSystem;
+
+		// Patches pointing into this rack go with it
+		for (NgsRack *rack : system->racks)
+		{
+			for (NgsVoice *voice : rack->voices)
+			{
+				for (size_t i = 0; i < voice->outputs.size();)
+				{
+					if (voice->outputs[i]->pDest->pRack == pRack || voice->pRack == pRack)
+						_removePatch(voice->outputs[i]);
+					else
+						i++;
+				}
+			}
+		}
+
+		for (NgsVoice *voice : pRack->voices)
+		{
+			_removeHandle(voice->handle);
+			delete voice;
+		}
+
+		system->voiceCount -= (SceInt32)pRack->voices.size();
+		system->racks.erase(std::remove(system->racks.begin(), system->racks.end(), pRack), system->racks.end());
+		_removeHandle(pRack->handle);
+		delete pRack;
+	}
+
+	void _keyOn(NgsVoice *pVoice)
+	{
+		SceInt32 channels = (pVoice->player.nChannels == 2) ? 2 : 1;
+
+		pVoice->bufIdx = pVoice->player.nStartBuffer;
+		pVoice->framePos = pVoice->player.nStartByte / (SceInt32)(sizeof(int16_t) * channels);
+		pVoice->frac = 0.0f;
+		pVoice->loopsLeft = (pVoice->bufIdx >= 0 && pVoice->bufIdx < SCE_NGS_PLAYER_MAX_BUFFERS) ? pVoice->player.buffs[pVoice->bufIdx].nLoopCount : 0;
+		pVoice->bytesConsumed = 0;
+		pVoice->samplesGenerated = 0;
+		pVoice->filterState[0] = 0.0f;
+		pVoice->filterState[1] = 0.0f;
+		pVoice->state = SCE_NGS_VOICE_STATE_ACTIVE;
+		pVoice->paused = false;
+	}
+
+	void _pushEvent(std::vector<Event> *pEvents, NgsVoice *pVoice, SceInt32 reason, SceInt32 bufferIdx)
+	{
+		Event event;
+
+		if (pVoice->callback == NULL)
+		{
+			return;
+		}
+
+		memset(&event, 0, sizeof(Event));
+		event.callback = pVoice->callback;
+		event.info.hVoiceHandle = pVoice->handle;
+		event.info.hRackHandle = pVoice->pRack->handle;
+		event.info.uModuleID = SCE_NGS_SIMPLE_VOICE_PCM_PLAYER;
+		event.info.nCallbackData = reason;
+		event.info.nCallbackData2 = bufferIdx;
+		event.info.pCallbackPtr = (void *)pVoice->player.buffs[bufferIdx].pBuffer;
+		event.info.pUserData = pVoice->pUserData;
+
+		pEvents->push_back(event);
+	}
+
+	// Stereo float output for one granule, returns the frames produced before the data ran out
+	SceInt32 _generate(NgsVoice *pVoice, float *pOut, SceInt32 frames, SceInt32 sampleRate, std::vector<Event> *pEvents)
+	{
+		const SceNgsPlayerParams *player = &pVoice->player;
+		float step = player->fPlaybackFrequency * player->fPlaybackScalar / (float)sampleRate;
+		SceInt32 channels = (player->nChannels == 2) ? 2 : 1;
+		SceInt32 leftChannel = (channels == 2) ? player->nChannelMap[0] : 0;
+		SceInt32 rightChannel = (channels == 2) ? player->nChannelMap[1] : 0;
+		SceInt32 i = 0;
+
+		if (pVoice->bufIdx < 0 || pVoice->bufIdx >= SCE_NGS_PLAYER_MAX_BUFFERS)
+		{
+			pVoice->state = SCE_NGS_VOICE_STATE_AVAILABLE;
+			return 0;
+		}
+
+		for (; i < frames && pVoice->state == SCE_NGS_VOICE_STATE_ACTIVE; i++)
+		{
+			const SceNgsPlayerBufferParams *buf = &player->buffs[pVoice->bufIdx];
+			SceInt32 bufFrames = buf->nNumBytes / (SceInt32)(sizeof(int16_t) * channels);
+			const int16_t *pcm = (const int16_t *)buf->pBuffer;
+
+			if (pcm != NULL && bufFrames > 0)
+			{
+				SceInt32 next = (pVoice->framePos + 1 < bufFrames) ? pVoice->framePos + 1 : pVoice->framePos;
+				const int16_t *cur = pcm + pVoice->framePos * channels;
+				const int16_t *nxt = pcm + next * channels;
+
+				pOut[i * 2] = ((float)cur[leftChannel] + ((float)nxt[leftChannel] - (float)cur[leftChannel]) * pVoice->frac) * (1.0f / 32768.0f);
+				pOut[i * 2 + 1] = ((float)cur[rightChannel] + ((float)nxt[rightChannel] - (float)cur[rightChannel]) * pVoice->frac) * (1.0f / 32768.0f);
+
+				pVoice->frac += step;
+				SceInt32 advance = (SceInt32)pVoice->frac;
+				pVoice->frac -= (float)advance;
+				pVoice->framePos += advance;
+				pVoice->bytesConsumed += advance * (SceInt32)sizeof(int16_t) * channels;
+				pVoice->totalBytes += advance * (SceInt32)sizeof(int16_t) * channels;
+				pVoice->samplesGenerated++;
+			}
+			else
+			{
+				pOut[i * 2] = 0.0f;
+				pOut[i * 2 + 1] = 0.0f;
+				bufFrames = 1;
+				pVoice->framePos = 1;
+			}
+
+			while (pVoice->framePos >= bufFrames && pVoice->state == SCE_NGS_VOICE_STATE_ACTIVE)
+			{
+				pVoice->framePos -= bufFrames;
+
+				if (pVoice->loopsLeft == SCE_NGS_PLAYER_LOOP_CONTINUOUS)
+				{
+					continue;
+				}
+
+				if (pVoice->loopsLeft > 0)
+				{
+					pVoice->loopsLeft--;
+					continue;
+				}
+
+				SceInt32 nextBuff = player->buffs[pVoice->bufIdx].nNextBuff;
+				if (nextBuff == SCE_NGS_PLAYER_NO_NEXT_BUFFER || nextBuff < 0 || nextBuff >= SCE_NGS_PLAYER_MAX_BUFFERS)
+				{
+					_pushEvent(pEvents, pVoice, SCE_NGS_PLAYER_END_OF_DATA, pVoice->bufIdx);
+					pVoice->state = SCE_NGS_VOICE_STATE_AVAILABLE;
+					break;
+				}
+
+				_pushEvent(pEvents, pVoice, SCE_NGS_PLAYER_SWAPPED_BUFFER, pVoice->bufIdx);
+
+				pVoice->bufIdx = nextBuff;
+				pVoice->loopsLeft = player->buffs[pVoice->bufIdx].nLoopCount;
+
+				bufFrames = player->buffs[pVoice->bufIdx].nNumBytes / (SceInt32)(sizeof(int16_t) * channels);
+				if (bufFrames <= 0)
+				{
+					bufFrames = 1;
+				}
+			}
+		}
+
+		return i;
+	}
+
+	void _filter(NgsVoice *pVoice, float *pData, SceInt32 frames, SceInt32 sampleRate)
+	{
+		if (pVoice->filterBypassed)
+		{
+			return;
+		}
+
+		for (int c = 0; c < HOST_NGS_FILTER_CHANNELS; c++)
+		{
+			const SceNgsFilterParams *params = &pVoice->filter[c];
+			float state = pVoice->filterState[c];
+
+			if (params->eFilterMode != SCE_NGS_FILTER_LOWPASS_ONEPOLE || params->fFrequency <= 0.0f || params->fFrequency >= (float)sampleRate * 0.5f)
+			{
+				continue;
+			}
+
+			float coef = 1.0f - expf(-HOST_NGS_TWO_PI * params->fFrequency / (float)sampleRate);
+
+			for (SceInt32 i = 0; i < frames; i++)
+			{
+				state += coef * (pData[i * 2 + c] - state);
+				pData[i * 2 + c] = state;
+			}
+
+			pVoice->filterState[c] = state;
+		}
+	}
+}
+
+extern "C" {
+
+const SceNgsVoiceDefinition *sceNgsVoiceDefGetSimpleVoice(void)
+{
+	return &s_simpleVoice;
+}
+
+const SceNgsVoiceDefinition *sceNgsVoiceDefGetMasterBuss(void)
+{
+	return &s_masterBuss;
+}
+
+SceInt32 sceNgsSystemGetRequiredMemorySize(const SceNgsSystemInitParams *pSynthParams, SceSize *pnSize)
+{
+	if (pSynthParams == NULL || pnSize == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	// The stand-in keeps its state on the heap, callers still get a plausible block to allocate
+	*pnSize = 1024 + pSynthParams->nMaxVoices * 64;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsSystemInit(void *pSynthSysMemory, const SceSize uMemSize, const SceNgsSystemInitParams *pSynthParams, SceNgsHSynSystem *pSystemHandle)
+{
+	pthread_mutexattr_t attr;
+
+	if (pSynthSysMemory == NULL || pSynthParams == NULL || pSystemHandle == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	if (pSynthParams->nGranularity <= 0 || pSynthParams->nSampleRate <= 0 || pSynthParams->nMaxVoices <= 0 || pSynthParams->nMaxRacks <= 0)
+	{
+		return SCE_NGS_ERROR_PARAM_OUT_OF_RANGE;
+	}
+
+	NgsSystem *system = new NgsSystem();
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&system->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	system->granularity = pSynthParams->nGranularity;
+	system->sampleRate = pSynthParams->nSampleRate;
+	system->maxVoices = pSynthParams->nMaxVoices;
+	system->maxRacks = pSynthParams->nMaxRacks;
+	system->voiceCount = 0;
+	system->handle = _addHandle(HandleType_System, system);
+
+	*pSystemHandle = system->handle;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsSystemRelease(SceNgsHSynSystem hSystemHandle)
+{
+	NgsSystem *system = (NgsSystem *)_getHandle(hSystemHandle, HandleType_System);
+
+	if (system == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	pthread_mutex_lock(&system->lock);
+	while (!system->racks.empty())
+	{
+		_releaseRack(system->racks.back());
+	}
+	pthread_mutex_unlock(&system->lock);
+
+	_removeHandle(hSystemHandle);
+	pthread_mutex_destroy(&system->lock);
+	delete system;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsSystemUpdate(SceNgsHSynSystem hSystemHandle)
+{
+	NgsSystem *system = (NgsSystem *)_getHandle(hSystemHandle, HandleType_System);
+	std::vector<Event> events;
+
+	if (system == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	pthread_mutex_lock(&system->lock);
+
+	for (NgsRack *rack : system->racks)
+	{
+		if (rack->master)
+		{
+			for (NgsVoice *voice : rack->voices)
+			{
+				std::fill(voice->input.begin(), voice->input.end(), 0.0f);
+			}
+		}
+	}
+
+	for (NgsRack *rack : system->racks)
+	{
+		if (rack->master)
+		{
+			continue;
+		}
+
+		for (NgsVoice *voice : rack->voices)
+		{
+			if (voice->state != SCE_NGS_VOICE_STATE_ACTIVE || voice->paused)
+			{
+				continue;
+			}
+
+			float *scratch = &voice->scratch[0];
+			SceInt32 generated = _generate(voice, scratch, system->granularity, system->sampleRate, &events);
+
+			_filter(voice, scratch, generated, system->sampleRate);
+
+			for (NgsPatch *patch : voice->outputs)
+			{
+				float *mix = &patch->pDest->input[0];
+				const float (*m)[2] = patch->vols.m;
+
+				for (SceInt32 i = 0; i < generated; i++)
+				{
+					float l = scratch[i * 2];
+					float r = scratch[i * 2 + 1];
+
+					mix[i * 2] += m[0][0] * l + m[1][0] * r;
+					mix[i * 2 + 1] += m[0][1] * l + m[1][1] * r;
+				}
+			}
+		}
+	}
+
+	for (NgsRack *rack : system->racks)
+	{
+		if (!rack->master)
+		{
+			continue;
+		}
+
+		for (NgsVoice *voice : rack->voices)
+		{
+			bool running = voice->state == SCE_NGS_VOICE_STATE_ACTIVE && !voice->paused;
+
+			for (size_t i = 0; i < voice->output.size(); i++)
+			{
+				float s = running ? voice->input[i] * 32767.0f : 0.0f;
+
+				if (s > 32767.0f)
+					s = 32767.0f;
+				else if (s < -32768.0f)
+					s = -32768.0f;
+
+				voice->output[i] = (int16_t)s;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&system->lock);
+
+	// Outside the system lock, handlers are free to lock params or the system again
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		events[i].callback(&events[i].info);
+	}
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsSystemLock(SceNgsHSynSystem hSystemHandle)
+{
+	NgsSystem *system = (NgsSystem *)_getHandle(hSystemHandle, HandleType_System);
+
+	if (system == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	pthread_mutex_lock(&system->lock);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsSystemUnlock(SceNgsHSynSystem hSystemHandle)
+{
+	NgsSystem *system = (NgsSystem *)_getHandle(hSystemHandle, HandleType_System);
+
+	if (system == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	pthread_mutex_unlock(&system->lock);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsRackGetRequiredMemorySize(SceNgsHSynSystem hSystemHandle, const SceNgsRackDescription *pRackDesc, SceUInt32 *pnSize)
+{
+	if (_getHandle(hSystemHandle, HandleType_System) == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (pRackDesc == NULL || pnSize == NULL || pRackDesc->nVoices <= 0)
+	{
+		return SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	*pnSize = 256 + pRackDesc->nVoices * 256;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsRackInit(SceNgsHSynSystem hSystemHandle, SceNgsBufferInfo *pRackBuffer, const SceNgsRackDescription *pRackDesc, SceNgsHRack *pRackHandle)
+{
+	NgsSystem *system = (NgsSystem *)_getHandle(hSystemHandle, HandleType_System);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (system == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (pRackBuffer == NULL || pRackBuffer->data == NULL || pRackDesc == NULL || pRackHandle == NULL || pRackDesc->nVoices <= 0)
+	{
+		return SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	if (pRackDesc->pVoiceDefn != &s_simpleVoice && pRackDesc->pVoiceDefn != &s_masterBuss)
+	{
+		return SCE_NGS_ERROR_INVALID_VOICE_TYPE;
+	}
+
+	pthread_mutex_lock(&system->lock);
+
+	// Same limits the real system was sized for in sceNgsSystemInit
+	if ((SceInt32)system->racks.size() >= system->maxRacks || system->voiceCount + pRackDesc->nVoices > system->maxVoices)
+	{
+		ret = SCE_NGS_ERROR_OUT_OF_ASSETS;
+	}
+	else
+	{
+		NgsRack *rack = new NgsRack();
+
+		rack->pSystem = system;
+		rack->master = (pRackDesc->pVoiceDefn == &s_masterBuss);
+		rack->handle = _addHandle(HandleType_Rack, rack);
+
+		for (SceInt32 i = 0; i < pRackDesc->nVoices; i++)
+		{
+			NgsVoice *voice = new NgsVoice();
+
+			voice->pRack = rack;
+			voice->master = rack->master;
+			voice->state = SCE_NGS_VOICE_STATE_AVAILABLE;
+			voice->paused = false;
+			memset(&voice->player, 0, sizeof(SceNgsPlayerParams));
+			memset(voice->filter, 0, sizeof(voice->filter));
+			voice->playerLocked = false;
+			voice->filterLocked = false;
+			voice->filterBypassed = false;
+			voice->callback = NULL;
+			voice->pUserData = NULL;
+			voice->totalBytes = 0;
+			voice->scratch.resize(system->granularity * 2);
+			if (voice->master)
+			{
+				voice->input.resize(system->granularity * 2);
+				voice->output.resize(system->granularity * 2);
+			}
+			voice->handle = _addHandle(HandleType_Voice, voice);
+
+			rack->voices.push_back(voice);
+		}
+
+		system->voiceCount += pRackDesc->nVoices;
+		system->racks.push_back(rack);
+
+		*pRackHandle = rack->handle;
+	}
+
+	pthread_mutex_unlock(&system->lock);
+
+	return ret;
+}
+
+SceInt32 sceNgsRackRelease(SceNgsHRack hRackHandle, void *callbackFuncPtr)
+{
+	NgsRack *rack = (NgsRack *)_getHandle(hRackHandle, HandleType_Rack);
+
+	if (rack == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	NgsSystem *system = rack->pSystem;
+
+	pthread_mutex_lock(&system->lock);
+	_releaseRack(rack);
+	pthread_mutex_unlock(&system->lock);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsRackGetVoiceHandle(SceNgsHRack hRackHandle, const SceUInt32 uIndex, SceNgsHVoice *pVoiceHandle)
+{
+	NgsRack *rack = (NgsRack *)_getHandle(hRackHandle, HandleType_Rack);
+
+	if (rack == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (pVoiceHandle == NULL || uIndex >= rack->voices.size())
+	{
+		return SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	*pVoiceHandle = rack->voices[uIndex]->handle;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsVoiceLockParams(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceNgsParamsID uParamsInterfaceId, SceNgsBufferInfo *pParamsBuffer)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	// Writers get a staging copy, the mixer only sees it once the params are unlocked
+	if (voice->master)
+	{
+		ret = SCE_NGS_ERROR_MODULE_NOT_AVAIL;
+	}
+	else if (uModule == SCE_NGS_SIMPLE_VOICE_PCM_PLAYER && uParamsInterfaceId == SCE_NGS_PLAYER_PARAMS_STRUCT_ID)
+	{
+		if (voice->playerLocked)
+		{
+			ret = SCE_NGS_ERROR_RESOURCE_LOCKED;
+		}
+		else
+		{
+			voice->playerStage = voice->player;
+			voice->playerLocked = true;
+			pParamsBuffer->data = &voice->playerStage;
+			pParamsBuffer->size = sizeof(SceNgsPlayerParams);
+		}
+	}
+	else if (uModule == SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER && uParamsInterfaceId == SCE_NGS_FILTER_PARAMS_STRUCT_ID)
+	{
+		if (voice->filterLocked)
+		{
+			ret = SCE_NGS_ERROR_RESOURCE_LOCKED;
+		}
+		else
+		{
+			memcpy(voice->filterStage, voice->filter, sizeof(voice->filter));
+			voice->filterLocked = true;
+			pParamsBuffer->data = voice->filterStage;
+			pParamsBuffer->size = sizeof(voice->filterStage);
+		}
+	}
+	else if (uModule == SCE_NGS_SIMPLE_VOICE_PCM_PLAYER || uModule == SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER)
+	{
+		ret = SCE_NGS_ERROR_PARAM_TYPE_MISMATCH;
+	}
+	else
+	{
+		ret = SCE_NGS_ERROR_MODULE_NOT_AVAIL;
+	}
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoiceUnlockParams(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (uModule == SCE_NGS_SIMPLE_VOICE_PCM_PLAYER && voice->playerLocked)
+	{
+		if (voice->playerStage.nChannels < 1 || voice->playerStage.nChannels > SCE_NGS_PLAYER_MAX_PCM_CHANNELS)
+		{
+			ret = SCE_NGS_ERROR_PARAM_OUT_OF_RANGE;
+		}
+		else
+		{
+			voice->player = voice->playerStage;
+		}
+
+		voice->playerLocked = false;
+	}
+	else if (uModule == SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER && voice->filterLocked)
+	{
+		memcpy(voice->filter, voice->filterStage, sizeof(voice->filter));
+		voice->filterLocked = false;
+	}
+	else
+	{
+		ret = SCE_NGS_ERROR_INVALID_STATE;
+	}
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoicePlay(SceNgsHVoice hVoiceHandle)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (voice->master)
+	{
+		voice->state = SCE_NGS_VOICE_STATE_ACTIVE;
+		voice->paused = false;
+	}
+	else
+	{
+		_keyOn(voice);
+	}
+
+	_unlockVoice(voice);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsVoiceKill(SceNgsHVoice hVoiceHandle)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	voice->state = SCE_NGS_VOICE_STATE_AVAILABLE;
+	voice->paused = false;
+
+	_unlockVoice(voice);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsVoiceKeyOff(SceNgsHVoice hVoiceHandle)
+{
+	// No envelope to release, key off ends the voice right away
+	return sceNgsVoiceKill(hVoiceHandle);
+}
+
+SceInt32 sceNgsVoicePause(SceNgsHVoice hVoiceHandle)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (voice->state == SCE_NGS_VOICE_STATE_ACTIVE)
+		voice->paused = true;
+	else
+		ret = SCE_NGS_ERROR_INVALID_STATE;
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoiceResume(SceNgsHVoice hVoiceHandle)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (voice->state == SCE_NGS_VOICE_STATE_ACTIVE && voice->paused)
+		voice->paused = false;
+	else
+		ret = SCE_NGS_ERROR_INVALID_STATE;
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoiceGetInfo(SceNgsHVoice hVoiceHandle, SceNgsVoiceInfo *pInfo)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	memset(pInfo, 0, sizeof(SceNgsVoiceInfo));
+	pInfo->uVoiceState = voice->state | (voice->paused ? SCE_NGS_VOICE_STATE_PAUSED : 0);
+	pInfo->uNumModules = voice->master ? 1 : 4;
+	pInfo->uNumInputs = voice->master ? 1 : 0;
+	pInfo->uNumOutputs = voice->master ? 0 : 1;
+	pInfo->uNumPatchesPerOutput = voice->master ? 0 : 1;
+
+	_unlockVoice(voice);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsVoiceGetStateData(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, void *pMem, const SceUInt32 uMemSize)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (voice->master && uModule == SCE_NGS_MASTER_BUSS_OUTPUT_MODULE)
+	{
+		memcpy(pMem, &voice->output[0], std::min((size_t)uMemSize, voice->output.size() * sizeof(int16_t)));
+	}
+	else if (!voice->master && uModule == SCE_NGS_SIMPLE_VOICE_PCM_PLAYER && uMemSize >= sizeof(SceNgsPlayerStates))
+	{
+		SceNgsPlayerStates *states = (SceNgsPlayerStates *)pMem;
+
+		states->nSamplesGeneratedSinceKeyOn = voice->samplesGenerated;
+		states->nBytesConsumedSinceKeyOn = voice->bytesConsumed;
+		states->nTotalBytesConsumed = voice->totalBytes;
+		states->nCurrentByte = voice->framePos * (SceInt32)sizeof(int16_t) * ((voice->player.nChannels == 2) ? 2 : 1);
+		states->nCurrentBuffer = voice->bufIdx;
+		states->nNumBuffersBuffered = 0;
+
+		for (SceInt32 i = voice->bufIdx; i >= 0 && i < SCE_NGS_PLAYER_MAX_BUFFERS && states->nNumBuffersBuffered < SCE_NGS_PLAYER_MAX_BUFFERS; i = voice->player.buffs[i].nNextBuff)
+		{
+			states->nNumBuffersBuffered++;
+		}
+	}
+	else
+	{
+		ret = SCE_NGS_ERROR_INVALID_PARAM;
+	}
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoiceBypassModule(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceUInt32 uBypassFlag)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	// The EQ is never modelled, bypassing it changes nothing
+	if (uModule == SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER)
+	{
+		voice->filterBypassed = (uBypassFlag == SCE_NGS_MODULE_FLAG_BYPASSED);
+	}
+
+	_unlockVoice(voice);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsVoiceSetModuleCallback(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, SceNgsModuleCallbackFunc callbackFuncPtr, void *pUserData)
+{
+	NgsVoice *voice = _lockVoice(hVoiceHandle);
+	SceInt32 ret = SCE_NGS_OK;
+
+	if (voice == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (voice->master || uModule != SCE_NGS_SIMPLE_VOICE_PCM_PLAYER)
+	{
+		ret = SCE_NGS_ERROR_MODULE_NOT_AVAIL;
+	}
+	else
+	{
+		voice->callback = callbackFuncPtr;
+		voice->pUserData = pUserData;
+	}
+
+	_unlockVoice(voice);
+
+	return ret;
+}
+
+SceInt32 sceNgsVoicePatchSetVolumesMatrix(SceNgsHPatch hPatchHandle, const SceNgsVolumeMatrix *pVolumeMatrix)
+{
+	NgsPatch *patch = (NgsPatch *)_getHandle(hPatchHandle, HandleType_Patch);
+
+	if (patch == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	NgsSystem *system = patch->pSource->pRack->pSystem;
+
+	pthread_mutex_lock(&system->lock);
+	patch->vols = *pVolumeMatrix;
+	pthread_mutex_unlock(&system->lock);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsPatchCreateRouting(const SceNgsPatchSetupInfo *pPatchInfo, SceNgsHPatch *pPatchHandle)
+{
+	NgsVoice *source = (NgsVoice *)_getHandle(pPatchInfo->hVoiceSource, HandleType_Voice);
+	NgsVoice *dest = (NgsVoice *)_getHandle(pPatchInfo->hVoiceDestination, HandleType_Voice);
+
+	if (source == NULL || dest == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (source->master || !dest->master || source->pRack->pSystem != dest->pRack->pSystem)
+	{
+		return SCE_NGS_ERROR_PATCH_NOT_AVAIL;
+	}
+
+	NgsSystem *system = source->pRack->pSystem;
+	NgsPatch *patch = new NgsPatch();
+
+	patch->pSource = source;
+	patch->pDest = dest;
+	memset(&patch->vols, 0, sizeof(SceNgsVolumeMatrix));
+	patch->handle = _addHandle(HandleType_Patch, patch);
+
+	pthread_mutex_lock(&system->lock);
+	source->outputs.push_back(patch);
+	pthread_mutex_unlock(&system->lock);
+
+	*pPatchHandle = patch->handle;
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsPatchRemoveRouting(SceNgsHPatch hPatchHandle)
+{
+	NgsPatch *patch = (NgsPatch *)_getHandle(hPatchHandle, HandleType_Patch);
+
+	if (patch == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	NgsSystem *system = patch->pSource->pRack->pSystem;
+
+	pthread_mutex_lock(&system->lock);
+	_removePatch(patch);
+	pthread_mutex_unlock(&system->lock);
+
+	return SCE_NGS_OK;
+}
+
+SceInt32 sceNgsPatchGetInfo(SceNgsHPatch hPatchHandle, SceNgsPatchRouteInfo *pRouteInfo, void *pOutRouteInfo)
+{
+	NgsPatch *patch = (NgsPatch *)_getHandle(hPatchHandle, HandleType_Patch);
+
+	if (patch == NULL)
+	{
+		return SCE_NGS_ERROR_INVALID_HANDLE;
+	}
+
+	if (pRouteInfo != NULL)
+	{
+		pRouteInfo->nOutputChannels = 2;
+		pRouteInfo->nInputChannels = 2;
+		pRouteInfo->vols = patch->vols;
+	}
+
+	return SCE_NGS_OK;
+}
+
+}
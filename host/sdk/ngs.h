@@ -0,0 +1,236 @@
+// Host stand-in for the NGS synthesiser: PCM player, one-pole filter, patches and a master buss, implemented in ngs.cpp
+#ifndef HOST_SCE_NGS_H
+#define HOST_SCE_NGS_H
+
+#include "kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef SceUInt32 SceNgsHVoice;
+typedef SceUInt32 SceNgsHPatch;
+typedef SceUInt32 SceNgsHRack;
+typedef SceUInt32 SceNgsHSynSystem;
+typedef SceUInt32 SceNgsParamsID;
+typedef SceUInt32 SceNgsModuleID;
+
+typedef struct SceNgsVoiceDefinition
+{
+	SceUInt32 uVoiceType;
+} SceNgsVoiceDefinition;
+
+typedef struct SceNgsBufferInfo
+{
+	void *data;
+	SceUInt32 size;
+} SceNgsBufferInfo;
+
+typedef struct SceNgsSystemInitParams
+{
+	SceInt32 nMaxRacks;
+	SceInt32 nMaxVoices;
+	SceInt32 nGranularity;
+	SceInt32 nSampleRate;
+	SceInt32 nMaxModules;
+} SceNgsSystemInitParams;
+
+typedef struct SceNgsRackDescription
+{
+	const SceNgsVoiceDefinition *pVoiceDefn;
+	SceInt32 nVoices;
+	SceInt32 nChannelsPerVoice;
+	SceInt32 nMaxPatchesPerInput;
+	SceInt32 nPatchesPerOutput;
+	void *pUserReleaseData;
+} SceNgsRackDescription;
+
+typedef struct SceNgsParamsDescriptor
+{
+	SceNgsParamsID id;
+	SceUInt32 size;
+} SceNgsParamsDescriptor;
+
+#define SCE_NGS_PLAYER_MAX_BUFFERS		(4)
+#define SCE_NGS_PLAYER_MAX_PCM_CHANNELS	(2)
+
+typedef struct SceNgsPlayerBufferParams
+{
+	const void *pBuffer;
+	SceInt32 nNumBytes;
+	SceInt16 nLoopCount;
+	SceInt16 nNextBuff;
+} SceNgsPlayerBufferParams;
+
+typedef struct SceNgsPlayerParams
+{
+	SceNgsParamsDescriptor desc;
+	SceNgsPlayerBufferParams buffs[SCE_NGS_PLAYER_MAX_BUFFERS];
+	SceFloat32 fPlaybackFrequency;
+	SceFloat32 fPlaybackScalar;
+	SceInt32 nLeadInSamples;
+	SceInt32 nLimitNumberOfSamplesPlayed;
+	SceInt8 nChannels;
+	SceInt8 nChannelMap[SCE_NGS_PLAYER_MAX_PCM_CHANNELS];
+	SceInt8 nType;
+	SceInt8 nUnused;
+	SceInt8 nStartBuffer;
+	SceInt32 nStartByte;
+} SceNgsPlayerParams;
+
+typedef struct SceNgsPlayerStates
+{
+	SceInt32 nSamplesGeneratedSinceKeyOn;
+	SceInt32 nBytesConsumedSinceKeyOn;
+	SceInt32 nTotalBytesConsumed;
+	SceInt32 nCurrentByte;
+	SceInt32 nCurrentBuffer;
+	SceInt32 nNumBuffersBuffered;
+} SceNgsPlayerStates;
+
+typedef struct SceNgsFilterParams
+{
+	SceNgsParamsDescriptor desc;
+	SceInt32 eFilterMode;
+	SceFloat32 fFrequency;
+	SceFloat32 fResonance;
+	SceFloat32 fGain;
+} SceNgsFilterParams;
+
+typedef struct SceNgsVolumeMatrix
+{
+	SceFloat32 m[2][2];
+} SceNgsVolumeMatrix;
+
+typedef struct SceNgsPatchRouteInfo
+{
+	SceInt32 nOutputChannels;
+	SceInt32 nInputChannels;
+	SceNgsVolumeMatrix vols;
+} SceNgsPatchRouteInfo;
+
+typedef struct SceNgsPatchSetupInfo
+{
+	SceNgsHVoice hVoiceSource;
+	SceInt32 nSourceOutputIndex;
+	SceInt32 nSourceOutputSubIndex;
+	SceNgsHVoice hVoiceDestination;
+	SceInt32 nTargetInputIndex;
+} SceNgsPatchSetupInfo;
+
+typedef struct SceNgsVoiceInfo
+{
+	SceUInt32 uVoiceState;
+	SceUInt32 uNumModules;
+	SceUInt32 uNumInputs;
+	SceUInt32 uNumOutputs;
+	SceUInt32 uNumPatchesPerOutput;
+} SceNgsVoiceInfo;
+
+typedef struct SceNgsCallbackInfo
+{
+	SceNgsHVoice hVoiceHandle;
+	SceNgsHRack hRackHandle;
+	SceNgsModuleID uModuleID;
+	SceInt32 nCallbackData;
+	SceInt32 nCallbackData2;
+	void *pCallbackPtr;
+	void *pUserData;
+} SceNgsCallbackInfo;
+
+typedef void (*SceNgsModuleCallbackFunc)(const SceNgsCallbackInfo *pCallbackInfo);
+
+#define SCE_NGS_OK								(0)
+#define SCE_NGS_ERROR							((SceInt32)0x804A0001)
+#define SCE_NGS_ERROR_INVALID_PARAM				((SceInt32)0x804A0002)
+#define SCE_NGS_ERROR_INVALID_ALIGNMENT			((SceInt32)0x804A0003)
+#define SCE_NGS_ERROR_PARAM_OUT_OF_RANGE		((SceInt32)0x804A0004)
+#define SCE_NGS_ERROR_INVALID_VOICE_TYPE		((SceInt32)0x804A0005)
+#define SCE_NGS_ERROR_SYSTEM_MISMATCH			((SceInt32)0x804A0006)
+#define SCE_NGS_ERROR_INVALID_HANDLE			((SceInt32)0x804A0007)
+#define SCE_NGS_ERROR_SIZE_MISMATCH				((SceInt32)0x804A0008)
+#define SCE_NGS_ERROR_PARAM_TYPE_MISMATCH		((SceInt32)0x804A0009)
+#define SCE_NGS_ERROR_INVALID_BUFFER			((SceInt32)0x804A000A)
+#define SCE_NGS_ERROR_NOT_IMPL					((SceInt32)0x804A000B)
+#define SCE_NGS_ERROR_DEPENDENCY				((SceInt32)0x804A000C)
+#define SCE_NGS_ERROR_MODULE_NOT_AVAIL			((SceInt32)0x804A000D)
+#define SCE_NGS_ERROR_RESOURCE_LOCKED			((SceInt32)0x804A000E)
+#define SCE_NGS_ERROR_PATCH_NOT_AVAIL			((SceInt32)0x804A000F)
+#define SCE_NGS_ERROR_INVALID_STATE				((SceInt32)0x804A0010)
+#define SCE_NGS_ERROR_INTERNAL_PROCESSING		((SceInt32)0x804A0011)
+#define SCE_NGS_ERROR_OUT_OF_ASSETS				((SceInt32)0x804A0012)
+#define SCE_NGS_ERROR_INTERNAL_ALLOC			((SceInt32)0x804A0013)
+
+#define SCE_NGS_MEMORY_ALIGN_SIZE				(16)
+
+#define SCE_NGS_SIMPLE_VOICE_PCM_PLAYER			(0)
+#define SCE_NGS_SIMPLE_VOICE_EQ					(1)
+#define SCE_NGS_SIMPLE_VOICE_SEND_1_FILTER		(3)
+#define SCE_NGS_MASTER_BUSS_OUTPUT_MODULE		(0)
+
+#define SCE_NGS_PLAYER_PARAMS_STRUCT_ID			(0x100)
+#define SCE_NGS_FILTER_PARAMS_STRUCT_ID			(0x200)
+
+#define SCE_NGS_PLAYER_NO_NEXT_BUFFER			(-1)
+#define SCE_NGS_PLAYER_LOOP_CONTINUOUS			(-1)
+#define SCE_NGS_PLAYER_LEFT_CHANNEL				(0)
+#define SCE_NGS_PLAYER_RIGHT_CHANNEL			(1)
+#define SCE_NGS_PLAYER_TYPE_PCM					(0)
+
+#define SCE_NGS_PLAYER_END_OF_DATA				(1)
+#define SCE_NGS_PLAYER_SWAPPED_BUFFER			(2)
+
+#define SCE_NGS_NO_CALLBACK						(NULL)
+
+#define SCE_NGS_MODULE_FLAG_NOT_BYPASSED		(0)
+#define SCE_NGS_MODULE_FLAG_BYPASSED			(2)
+
+#define SCE_NGS_FILTER_LOWPASS_ONEPOLE			(1)
+
+#define SCE_NGS_VOICE_PATCH_AUTO_SUBINDEX		(-1)
+
+#define SCE_NGS_VOICE_STATE_AVAILABLE			(0x0)
+#define SCE_NGS_VOICE_STATE_ACTIVE				(0x1)
+#define SCE_NGS_VOICE_STATE_FINALIZING			(0x2)
+#define SCE_NGS_VOICE_STATE_UNLOADING			(0x3)
+#define SCE_NGS_VOICE_STATE_PENDING				(0x10)
+#define SCE_NGS_VOICE_STATE_PAUSED				(0x20)
+#define SCE_NGS_VOICE_STATE_KEY_OFF				(0x40)
+
+const SceNgsVoiceDefinition *sceNgsVoiceDefGetSimpleVoice(void);
+const SceNgsVoiceDefinition *sceNgsVoiceDefGetMasterBuss(void);
+
+SceInt32 sceNgsSystemGetRequiredMemorySize(const SceNgsSystemInitParams *pSynthParams, SceSize *pnSize);
+SceInt32 sceNgsSystemInit(void *pSynthSysMemory, const SceSize uMemSize, const SceNgsSystemInitParams *pSynthParams, SceNgsHSynSystem *pSystemHandle);
+SceInt32 sceNgsSystemRelease(SceNgsHSynSystem hSystemHandle);
+SceInt32 sceNgsSystemUpdate(SceNgsHSynSystem hSystemHandle);
+SceInt32 sceNgsSystemLock(SceNgsHSynSystem hSystemHandle);
+SceInt32 sceNgsSystemUnlock(SceNgsHSynSystem hSystemHandle);
+
+SceInt32 sceNgsRackGetRequiredMemorySize(SceNgsHSynSystem hSystemHandle, const SceNgsRackDescription *pRackDesc, SceUInt32 *pnSize);
+SceInt32 sceNgsRackInit(SceNgsHSynSystem hSystemHandle, SceNgsBufferInfo *pRackBuffer, const SceNgsRackDescription *pRackDesc, SceNgsHRack *pRackHandle);
+SceInt32 sceNgsRackRelease(SceNgsHRack hRackHandle, void *callbackFuncPtr);
+SceInt32 sceNgsRackGetVoiceHandle(SceNgsHRack hRackHandle, const SceUInt32 uIndex, SceNgsHVoice *pVoiceHandle);
+
+SceInt32 sceNgsVoiceLockParams(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceNgsParamsID uParamsInterfaceId, SceNgsBufferInfo *pParamsBuffer);
+SceInt32 sceNgsVoiceUnlockParams(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule);
+SceInt32 sceNgsVoicePlay(SceNgsHVoice hVoiceHandle);
+SceInt32 sceNgsVoiceKill(SceNgsHVoice hVoiceHandle);
+SceInt32 sceNgsVoiceKeyOff(SceNgsHVoice hVoiceHandle);
+SceInt32 sceNgsVoicePause(SceNgsHVoice hVoiceHandle);
+SceInt32 sceNgsVoiceResume(SceNgsHVoice hVoiceHandle);
+SceInt32 sceNgsVoiceGetInfo(SceNgsHVoice hVoiceHandle, SceNgsVoiceInfo *pInfo);
+SceInt32 sceNgsVoiceGetStateData(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, void *pMem, const SceUInt32 uMemSize);
+SceInt32 sceNgsVoiceBypassModule(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, const SceUInt32 uBypassFlag);
+SceInt32 sceNgsVoiceSetModuleCallback(SceNgsHVoice hVoiceHandle, const SceUInt32 uModule, SceNgsModuleCallbackFunc callbackFuncPtr, void *pUserData);
+SceInt32 sceNgsVoicePatchSetVolumesMatrix(SceNgsHPatch hPatchHandle, const SceNgsVolumeMatrix *pVolumeMatrix);
+
+SceInt32 sceNgsPatchCreateRouting(const SceNgsPatchSetupInfo *pPatchInfo, SceNgsHPatch *pPatchHandle);
+SceInt32 sceNgsPatchRemoveRouting(SceNgsHPatch hPatchHandle);
+SceInt32 sceNgsPatchGetInfo(SceNgsHPatch hPatchHandle, SceNgsPatchRouteInfo *pRouteInfo, void *pOutRouteInfo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
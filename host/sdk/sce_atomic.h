@@ -0,0 +1,59 @@
+// Host stand-in for the SDK atomics, all acquire/release over the compiler builtins
+#ifndef HOST_SCE_ATOMIC_H
+#define HOST_SCE_ATOMIC_H
+
+#include <stdint.h>
+
+static inline int32_t sceAtomicLoad32AcqRel(volatile int32_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void sceAtomicStore32AcqRel(volatile int32_t *ptr, int32_t value)
+{
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline int32_t sceAtomicAdd32AcqRel(volatile int32_t *ptr, int32_t value)
+{
+	return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+static inline int32_t sceAtomicIncrement32AcqRel(volatile int32_t *ptr)
+{
+	return __atomic_fetch_add(ptr, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline int32_t sceAtomicDecrement32AcqRel(volatile int32_t *ptr)
+{
+	return __atomic_fetch_sub(ptr, 1, __ATOMIC_ACQ_REL);
+}
+
+static inline int32_t sceAtomicCompareAndSwap32AcqRel(volatile int32_t *ptr, int32_t expected, int32_t value)
+{
+	__atomic_compare_exchange_n(ptr, &expected, value, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	return expected;
+}
+
+static inline int64_t sceAtomicLoad64AcqRel(volatile int64_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static inline void sceAtomicStore64AcqRel(volatile int64_t *ptr, int64_t value)
+{
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+static inline int64_t sceAtomicAdd64AcqRel(volatile int64_t *ptr, int64_t value)
+{
+	return __atomic_fetch_add(ptr, value, __ATOMIC_ACQ_REL);
+}
+
+static inline int64_t sceAtomicCompareAndSwap64AcqRel(volatile int64_t *ptr, int64_t expected, int64_t value)
+{
+	__atomic_compare_exchange_n(ptr, &expected, value, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+	return expected;
+}
+
+#endif
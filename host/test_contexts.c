@@ -0,0 +1,110 @@
+// Plays one buffer from two contexts on the same device and deletes a source while the other context is current
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_PLAY_TIME		(100000)
+
+int main(void)
+{
+	static short tone[TEST_FREQUENCY / 10];
+	ALCdevice *device = NULL;
+	ALCcontext *contexts[2] = { NULL, NULL };
+	ALuint buffer = 0;
+	ALuint sources[2] = { 0, 0 };
+	ALint state = AL_STOPPED;
+	ALenum error = AL_NO_ERROR;
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_FREQUENCY / 10; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcOpenDevice(NULL);
+	if (device == NULL)
+	{
+		printf("alcOpenDevice failed\n");
+		return EXIT_FAILURE;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		contexts[i] = alcCreateContext(device, NULL);
+		if (contexts[i] == NULL)
+		{
+			printf("alcCreateContext %d failed: 0x%04X\n", i, alcGetError(device));
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Buffers belong to the device, the one upload is shared by both contexts
+	alcMakeContextCurrent(contexts[0]);
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	for (int i = 0; i < 2; i++)
+	{
+		alcMakeContextCurrent(contexts[i]);
+		alGenSources(1, &sources[i]);
+		alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+		alSourcei(sources[i], AL_BUFFER, buffer);
+		alSourcePlay(sources[i]);
+	}
+
+	usleep(TEST_PLAY_TIME);
+
+	// The second context is current, the first context's threads still walk the source being deleted
+	alSourceStop(sources[0]);
+	alSourcei(sources[0], AL_BUFFER, 0);
+	alDeleteSources(1, &sources[0]);
+
+	error = alGetError();
+	if (error != AL_NO_ERROR)
+	{
+		printf("deleting the other context's source failed: 0x%04X\n", error);
+		ret = EXIT_FAILURE;
+	}
+
+	if (alIsSource(sources[0]))
+	{
+		printf("deleted source is still valid\n");
+		ret = EXIT_FAILURE;
+	}
+
+	usleep(TEST_PLAY_TIME);
+
+	alGetSourcei(sources[1], AL_SOURCE_STATE, &state);
+	printf("remaining source state 0x%04X\n", state);
+
+	if (state != AL_PLAYING || !alIsBuffer(buffer))
+	{
+		printf("the other context lost its source or the shared buffer\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alSourceStop(sources[1]);
+	alSourcei(sources[1], AL_BUFFER, 0);
+	alDeleteSources(1, &sources[1]);
+	alDeleteBuffers(1, &buffer);
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("teardown hit an AL error\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alcDestroyContext(contexts[1]);
+	alcDestroyContext(contexts[0]);
+	alcCloseDevice(device);
+
+	return ret;
+}
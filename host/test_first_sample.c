@@ -0,0 +1,107 @@
+// Times alcCreateContext and the first play up to the first granule handed to the audio port
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_POLL_TIME		(1000)
+#define TEST_POLL_COUNT		(1000)
+#define TEST_MAX_LATENCY	(100000)
+
+static long long _timeUs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+int main(void)
+{
+	static short tone[TEST_FREQUENCY / 10];
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffer = 0;
+	ALuint source = 0;
+	ALCint latency = 0;
+	ALCint outputLatency = 0;
+	long long createTime = 0;
+	long long playTime = 0;
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_FREQUENCY / 10; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcOpenDevice(NULL);
+	if (device == NULL)
+	{
+		printf("alcOpenDevice failed\n");
+		return EXIT_FAILURE;
+	}
+
+	createTime = _timeUs();
+	context = alcCreateContext(device, NULL);
+	createTime = _timeUs() - createTime;
+
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	// Nothing has played yet, so there is no first sample to report
+	alcGetIntegerv(device, ALC_FIRST_SAMPLE_LATENCY_NGS, 1, &latency);
+	if (latency != 0)
+	{
+		printf("first sample latency %d us reported before anything played\n", latency);
+		ret = EXIT_FAILURE;
+	}
+
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	alGenSources(1, &source);
+	alSourcei(source, AL_LOOPING, AL_TRUE);
+	alSourcei(source, AL_BUFFER, buffer);
+
+	playTime = _timeUs();
+	alSourcePlay(source);
+	playTime = _timeUs() - playTime;
+
+	for (int i = 0; i < TEST_POLL_COUNT && latency == 0; i++)
+	{
+		usleep(TEST_POLL_TIME);
+		alcGetIntegerv(device, ALC_FIRST_SAMPLE_LATENCY_NGS, 1, &latency);
+	}
+
+	alcGetIntegerv(device, ALC_OUTPUT_LATENCY_NGS, 1, &outputLatency);
+
+	printf("alcCreateContext %lld us, first alSourcePlay %lld us, first sample after %d us, output latency %d us\n",
+		createTime, playTime, latency, outputLatency);
+
+	if (latency <= 0 || latency > TEST_MAX_LATENCY)
+	{
+		printf("first sample latency out of range\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alSourceStop(source);
+	alSourcei(source, AL_BUFFER, 0);
+	alDeleteSources(1, &source);
+	alDeleteBuffers(1, &buffer);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	return ret;
+}
@@ -0,0 +1,123 @@
+// Renders a looping 1 kHz tone through a loopback device and checks level and pitch of the mix
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_TONE			(1000)
+#define TEST_AMPLITUDE		(16384)
+#define TEST_RENDER_FRAMES	(TEST_FREQUENCY)
+#define TEST_CHUNK_FRAMES	(1000)
+
+int main(void)
+{
+	const ALCint attrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		0
+	};
+	static short tone[TEST_FREQUENCY];
+	static short mix[TEST_RENDER_FRAMES * 2];
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffer = 0;
+	ALuint source = 0;
+	double sumSquares = 0.0;
+	int crossings = 0;
+	int peak = 0;
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_FREQUENCY; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * TEST_TONE * i / TEST_FREQUENCY));
+	}
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (device == NULL)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!alcIsRenderFormatSupportedSOFT(device, TEST_FREQUENCY, ALC_STEREO_SOFT, ALC_SHORT_SOFT))
+	{
+		printf("48 kHz stereo 16 bit not supported\n");
+		return EXIT_FAILURE;
+	}
+
+	context = alcCreateContext(device, attrs);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	alGenSources(1, &source);
+	alSourcei(source, AL_SOURCE_RELATIVE, AL_TRUE);
+	alSource3f(source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+	alSourcei(source, AL_LOOPING, AL_TRUE);
+	alSourcei(source, AL_BUFFER, buffer);
+	alSourcePlay(source);
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("source setup failed\n");
+		return EXIT_FAILURE;
+	}
+
+	// Odd chunk size so renders straddle granule boundaries
+	for (int i = 0; i < TEST_RENDER_FRAMES; i += TEST_CHUNK_FRAMES)
+	{
+		alcRenderSamplesSOFT(device, mix + i * 2, TEST_CHUNK_FRAMES);
+	}
+
+	// Skip the first tenth, the gain ramp and the voice start-up live there
+	for (int i = TEST_RENDER_FRAMES / 10; i < TEST_RENDER_FRAMES; i++)
+	{
+		int left = mix[i * 2];
+		int right = mix[i * 2 + 1];
+
+		sumSquares += (double)left * left + (double)right * right;
+		peak = (abs(left) > peak) ? abs(left) : peak;
+
+		if ((mix[(i - 1) * 2] < 0) != (left < 0))
+		{
+			crossings++;
+		}
+	}
+
+	double rms = sqrt(sumSquares / ((TEST_RENDER_FRAMES - TEST_RENDER_FRAMES / 10) * 2));
+	double pitch = crossings / 2.0 * TEST_FREQUENCY / (TEST_RENDER_FRAMES - TEST_RENDER_FRAMES / 10);
+
+	printf("peak %d, rms %.1f, pitch %.1f Hz\n", peak, rms, pitch);
+
+	if (peak < TEST_AMPLITUDE / 8 || peak > 32767)
+	{
+		printf("mix level out of range\n");
+		ret = EXIT_FAILURE;
+	}
+
+	if (fabs(pitch - TEST_TONE) > TEST_TONE * 0.02)
+	{
+		printf("mix pitch out of range\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alSourceStop(source);
+	alSourcei(source, AL_BUFFER, 0);
+	alDeleteSources(1, &source);
+	alDeleteBuffers(1, &buffer);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	return ret;
+}
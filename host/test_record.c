@@ -0,0 +1,99 @@
+// Records a short session through a loopback device, replay/ then plays the file back as the replay test
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_CHUNK_FRAMES	(1024)
+#define TEST_STEPS			(16)
+
+int main(int argc, char *argv[])
+{
+	const ALCint attrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		0
+	};
+	static short tone[TEST_FREQUENCY / 10];
+	static short mix[TEST_CHUNK_FRAMES * 2];
+	const char *path = (argc > 1) ? argv[1] : "session.alrec";
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffers[2];
+	ALuint sources[2];
+
+	for (int i = 0; i < TEST_FREQUENCY / 10; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (device == NULL)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		return EXIT_FAILURE;
+	}
+
+	context = alcCreateContext(device, attrs);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	alRecordStartNGS(path);
+
+	alGenBuffers(2, buffers);
+	alGenSources(2, sources);
+
+	// The same data twice, the second upload must be stored as a reference to the first blob
+	alBufferData(buffers[0], AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+	alBufferData(buffers[1], AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	alSourcei(sources[0], AL_LOOPING, AL_TRUE);
+	alSourcei(sources[0], AL_BUFFER, buffers[0]);
+	alSourceQueueBuffers(sources[1], 2, buffers);
+
+	alSourcePlay(sources[0]);
+	alSourcePlay(sources[1]);
+
+	for (int i = 0; i < TEST_STEPS; i++)
+	{
+		alSource3f(sources[0], AL_POSITION, (float)i - TEST_STEPS / 2, 0.0f, -2.0f);
+		alSourcef(sources[1], AL_PITCH, 1.0f + i * 0.05f);
+		alcRenderSamplesSOFT(device, mix, TEST_CHUNK_FRAMES);
+
+		// Recorded deltas are wall time, this keeps them in step with the audio rendered so replay renders it again
+		usleep(TEST_CHUNK_FRAMES * 1000000 / TEST_FREQUENCY);
+	}
+
+	alSourceStop(sources[0]);
+	alSourceStop(sources[1]);
+	alSourcei(sources[0], AL_BUFFER, 0);
+	alSourcei(sources[1], AL_BUFFER, 0);
+	alDeleteSources(2, sources);
+	alDeleteBuffers(2, buffers);
+
+	alRecordStopNGS();
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("recorded session hit an AL error\n");
+		return EXIT_FAILURE;
+	}
+
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	printf("recorded %s\n", path);
+
+	return EXIT_SUCCESS;
+}
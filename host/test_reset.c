@@ -0,0 +1,183 @@
+// Resets a loopback device under playing sources, buffers and sources must come through with their state and keep rendering
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_RENDER_FRAMES	(TEST_FREQUENCY / 10)
+#define TEST_GAIN			(0.5f)
+
+static short s_mix[TEST_RENDER_FRAMES * 2];
+
+static int _renderPeak(ALCdevice *device)
+{
+	int peak = 0;
+
+	alcRenderSamplesSOFT(device, s_mix, TEST_RENDER_FRAMES);
+
+	for (int i = 0; i < TEST_RENDER_FRAMES * 2; i++)
+	{
+		peak = (abs(s_mix[i]) > peak) ? abs(s_mix[i]) : peak;
+	}
+
+	return peak;
+}
+
+static int _checkSources(const char *name, const ALuint *sources, ALuint buffer)
+{
+	ALint state = AL_STOPPED;
+	ALint bound = 0;
+	ALint looping = AL_FALSE;
+	ALfloat gain = 0.0f;
+
+	if (!alIsBuffer(buffer) || !alIsSource(sources[0]) || !alIsSource(sources[1]))
+	{
+		printf("%s: a buffer or source name did not survive\n", name);
+		return -1;
+	}
+
+	alGetSourcei(sources[0], AL_SOURCE_STATE, &state);
+	alGetSourcei(sources[0], AL_BUFFER, &bound);
+	alGetSourcei(sources[0], AL_LOOPING, &looping);
+	alGetSourcef(sources[1], AL_GAIN, &gain);
+
+	if (state != AL_PLAYING || bound != (ALint)buffer || looping != AL_TRUE || gain != TEST_GAIN)
+	{
+		printf("%s: state 0x%04X, buffer %d, looping %d, gain %f\n", name, state, bound, looping, gain);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	const ALCint attrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		0
+	};
+	// Moves every voice over to the other mixer, the heaviest reset there is. Loopback resets restate the render format
+	const ALCint softAttrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		ALC_SOFTWARE_MIXER_NGS, ALC_TRUE,
+		0
+	};
+	// Fewer voices than there are sources, the reset must fail and leave the device as it was
+	const ALCint tooFewAttrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		ALC_MONO_SOURCES, 1,
+		ALC_STEREO_SOURCES, 0,
+		0
+	};
+	static short tone[TEST_FREQUENCY];
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffer = 0;
+	ALuint sources[2];
+	ALint state = AL_STOPPED;
+	int peak = 0;
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_FREQUENCY; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (device == NULL)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		return EXIT_FAILURE;
+	}
+
+	context = alcCreateContext(device, attrs);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	alGenSources(2, sources);
+	alSourcei(sources[0], AL_LOOPING, AL_TRUE);
+	alSourcei(sources[0], AL_BUFFER, buffer);
+	alSourcef(sources[1], AL_GAIN, TEST_GAIN);
+	alSourcei(sources[1], AL_BUFFER, buffer);
+	alSourcePlay(sources[0]);
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("source setup failed\n");
+		return EXIT_FAILURE;
+	}
+
+	peak = _renderPeak(device);
+	printf("before reset: peak %d\n", peak);
+
+	if (alcResetDeviceSOFT(device, tooFewAttrs))
+	{
+		printf("reset with fewer voices than sources succeeded\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alcGetError(device);
+
+	if (_checkSources("failed reset", sources, buffer) != 0)
+	{
+		ret = EXIT_FAILURE;
+	}
+
+	if (!alcResetDeviceSOFT(device, softAttrs))
+	{
+		printf("alcResetDeviceSOFT failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	if (_checkSources("reset", sources, buffer) != 0)
+	{
+		ret = EXIT_FAILURE;
+	}
+
+	peak = _renderPeak(device);
+	printf("after reset: peak %d\n", peak);
+
+	if (peak < TEST_AMPLITUDE / 4)
+	{
+		printf("playing source went quiet across the reset\n");
+		ret = EXIT_FAILURE;
+	}
+
+	// A source that was stopped through the reset still starts on its new voice
+	alSourcePlay(sources[1]);
+	alGetSourcei(sources[1], AL_SOURCE_STATE, &state);
+
+	if (state != AL_PLAYING || alGetError() != AL_NO_ERROR)
+	{
+		printf("stopped source does not play after the reset\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alSourceStopv(2, sources);
+	alSourcei(sources[0], AL_BUFFER, 0);
+	alSourcei(sources[1], AL_BUFFER, 0);
+	alDeleteSources(2, sources);
+	alDeleteBuffers(1, &buffer);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	return ret;
+}
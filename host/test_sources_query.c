@@ -0,0 +1,154 @@
+// Reads the state of several sources at once with alGetSourcesivNGS and checks it against the single source getters
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_SOURCES		(3)
+#define TEST_RENDER_FRAMES	(TEST_FREQUENCY / 20)
+#define TEST_UNTOUCHED		(-12345)
+
+static short s_mix[TEST_RENDER_FRAMES * 2];
+
+static int _compare(const char *name, const ALuint *sources, ALenum param)
+{
+	ALint batch[TEST_SOURCES];
+	ALint single = 0;
+	ALenum error = AL_NO_ERROR;
+
+	alGetSourcesivNGS(TEST_SOURCES, sources, param, batch);
+
+	error = alGetError();
+	if (error != AL_NO_ERROR)
+	{
+		printf("%s: alGetSourcesivNGS failed: 0x%04X\n", name, error);
+		return -1;
+	}
+
+	for (int i = 0; i < TEST_SOURCES; i++)
+	{
+		alGetSourcei(sources[i], param, &single);
+		if (batch[i] != single)
+		{
+			printf("%s: source %d reads %d in the batch and %d alone\n", name, i, batch[i], single);
+			return -1;
+		}
+	}
+
+	printf("%s: %d %d %d\n", name, batch[0], batch[1], batch[2]);
+
+	return 0;
+}
+
+int main(void)
+{
+	const ALCint attrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		0
+	};
+	static short tone[TEST_FREQUENCY / 10];
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffers[2];
+	ALuint sources[TEST_SOURCES];
+	ALuint badNames[2];
+	ALint values[TEST_SOURCES];
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_FREQUENCY / 10; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (device == NULL)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		return EXIT_FAILURE;
+	}
+
+	context = alcCreateContext(device, attrs);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	alGenBuffers(2, buffers);
+	alBufferData(buffers[0], AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+	alBufferData(buffers[1], AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	// One looping, one streaming two buffers and one left without any, each reads differently
+	alGenSources(TEST_SOURCES, sources);
+	alSourcei(sources[0], AL_LOOPING, AL_TRUE);
+	alSourcei(sources[0], AL_BUFFER, buffers[0]);
+	alSourceQueueBuffers(sources[1], 2, buffers);
+	alSourcePlay(sources[0]);
+	alSourcePlay(sources[1]);
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("source setup failed\n");
+		return EXIT_FAILURE;
+	}
+
+	alcRenderSamplesSOFT(device, s_mix, TEST_RENDER_FRAMES);
+
+	if (_compare("state", sources, AL_SOURCE_STATE) != 0 ||
+		_compare("looping", sources, AL_LOOPING) != 0 ||
+		_compare("queued", sources, AL_BUFFERS_QUEUED) != 0 ||
+		_compare("processed", sources, AL_BUFFERS_PROCESSED) != 0)
+	{
+		ret = EXIT_FAILURE;
+	}
+
+	// Offsets come from the voice snapshot, a source without buffers reads 0 instead of failing
+	alGetSourcesivNGS(TEST_SOURCES, sources, AL_SAMPLE_OFFSET, values);
+	printf("sample offset: %d %d %d\n", values[0], values[1], values[2]);
+
+	if (alGetError() != AL_NO_ERROR || values[0] <= 0 || values[1] <= 0 || values[2] != 0)
+	{
+		printf("sample offsets do not follow the rendered audio\n");
+		ret = EXIT_FAILURE;
+	}
+
+	// One bad name fails the whole call before anything is written
+	badNames[0] = sources[0];
+	badNames[1] = 0xFFFF;
+	values[0] = TEST_UNTOUCHED;
+	values[1] = TEST_UNTOUCHED;
+
+	alGetSourcesivNGS(2, badNames, AL_SOURCE_STATE, values);
+
+	if (alGetError() != AL_INVALID_NAME || values[0] != TEST_UNTOUCHED || values[1] != TEST_UNTOUCHED)
+	{
+		printf("a bad name did not fail the call cleanly\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alGetSourcesivNGS(TEST_SOURCES, sources, AL_GAIN, values);
+
+	if (alGetError() != AL_INVALID_ENUM)
+	{
+		printf("a param outside the batch list was accepted\n");
+		ret = EXIT_FAILURE;
+	}
+
+	alSourceStopv(TEST_SOURCES, sources);
+	alSourcei(sources[0], AL_BUFFER, 0);
+	alSourcei(sources[1], AL_BUFFER, 0);
+	alDeleteSources(TEST_SOURCES, sources);
+	alDeleteBuffers(2, buffers);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	return ret;
+}
@@ -0,0 +1,157 @@
+// Renders the same tones on one and on several NGS systems, the summed split mix must match the single system
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_SOURCES		(8)
+#define TEST_AMPLITUDE		(2000)
+#define TEST_RENDER_FRAMES	(TEST_FREQUENCY / 2)
+#define TEST_CHUNK_FRAMES	(960)
+#define TEST_TOLERANCE		(4)
+
+static short s_tones[TEST_SOURCES][TEST_FREQUENCY];
+static short s_reference[TEST_RENDER_FRAMES * 2];
+static short s_split[TEST_RENDER_FRAMES * 2];
+
+static int _renderTones(ALCint systems, ALCint software, short *pOut)
+{
+	const ALCint attrs[] = {
+		ALC_FREQUENCY, TEST_FREQUENCY,
+		ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+		ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+		ALC_RENDER_SYSTEMS_NGS, systems,
+		ALC_SOFTWARE_MIXER_NGS, software,
+		0
+	};
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffers[TEST_SOURCES];
+	ALuint sources[TEST_SOURCES];
+	ALCint racks = 0;
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (device == NULL)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		return -1;
+	}
+
+	context = alcCreateContext(device, attrs);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed for %d systems: 0x%04X\n", systems, alcGetError(device));
+		alcCloseDevice(device);
+		return -1;
+	}
+
+	alGenBuffers(TEST_SOURCES, buffers);
+	alGenSources(TEST_SOURCES, sources);
+
+	// Panned apart so every voice takes a different path through the patch matrices
+	for (int i = 0; i < TEST_SOURCES; i++)
+	{
+		alBufferData(buffers[i], AL_FORMAT_MONO16, s_tones[i], sizeof(s_tones[i]), TEST_FREQUENCY);
+
+		alSourcei(sources[i], AL_SOURCE_RELATIVE, AL_TRUE);
+		alSource3f(sources[i], AL_POSITION, (float)i / TEST_SOURCES * 2.0f - 1.0f, 0.0f, -1.0f);
+		alSourcei(sources[i], AL_LOOPING, AL_TRUE);
+		alSourcei(sources[i], AL_BUFFER, buffers[i]);
+	}
+
+	alSourcePlayv(TEST_SOURCES, sources);
+
+	if (alGetError() != AL_NO_ERROR)
+	{
+		printf("source setup failed for %d systems\n", systems);
+		return -1;
+	}
+
+	for (int i = 0; i < TEST_RENDER_FRAMES; i += TEST_CHUNK_FRAMES)
+	{
+		alcRenderSamplesSOFT(device, pOut + i * 2, TEST_CHUNK_FRAMES);
+	}
+
+	alcGetIntegerv(device, ALC_RACK_COUNT_NGS, 1, &racks);
+
+	alSourceStopv(TEST_SOURCES, sources);
+
+	for (int i = 0; i < TEST_SOURCES; i++)
+	{
+		alSourcei(sources[i], AL_BUFFER, 0);
+	}
+
+	alDeleteSources(TEST_SOURCES, sources);
+	alDeleteBuffers(TEST_SOURCES, buffers);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	// Every NGS system brings at least its own master rack, the software mixer has none
+	if (software == ALC_FALSE && racks < systems)
+	{
+		printf("%d systems requested, context reports %d racks\n", systems, racks);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int _compare(const char *name, ALCint systems, ALCint software)
+{
+	int peak = 0;
+	int diff = 0;
+
+	if (_renderTones(1, software, s_reference) != 0 || _renderTones(systems, software, s_split) != 0)
+	{
+		return -1;
+	}
+
+	for (int i = 0; i < TEST_RENDER_FRAMES * 2; i++)
+	{
+		int d = abs(s_reference[i] - s_split[i]);
+
+		peak = (abs(s_reference[i]) > peak) ? abs(s_reference[i]) : peak;
+		diff = (d > diff) ? d : diff;
+	}
+
+	printf("%s, %d systems: peak %d, max difference %d\n", name, systems, peak, diff);
+
+	// Each system rounds its own master buss, the sum may be off by a step per system
+	if (peak < TEST_AMPLITUDE || diff > TEST_TOLERANCE)
+	{
+		printf("%s split mix does not match the single system\n", name);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	int ret = EXIT_SUCCESS;
+
+	for (int i = 0; i < TEST_SOURCES; i++)
+	{
+		for (int j = 0; j < TEST_FREQUENCY; j++)
+		{
+			s_tones[i][j] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * (250 * (i + 1)) * j / TEST_FREQUENCY));
+		}
+	}
+
+	if (_compare("ngs", 2, ALC_FALSE) != 0 || _compare("ngs", 3, ALC_FALSE) != 0)
+	{
+		ret = EXIT_FAILURE;
+	}
+
+	if (_compare("software", 2, ALC_TRUE) != 0 || _compare("software", 3, ALC_TRUE) != 0)
+	{
+		ret = EXIT_FAILURE;
+	}
+
+	return ret;
+}
@@ -0,0 +1,76 @@
+// Plays a steady tone through the paced audio port for a second, a mixer that keeps up must report no underruns
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+#define TEST_FREQUENCY		(48000)
+#define TEST_AMPLITUDE		(8000)
+#define TEST_PLAY_TIME		(1000000)
+
+int main(void)
+{
+	static short tone[TEST_FREQUENCY];
+	ALCdevice *device = NULL;
+	ALCcontext *context = NULL;
+	ALuint buffer = 0;
+	ALuint source = 0;
+	ALCint underruns = -1;
+	ALCint latency = 0;
+	ALint state = AL_STOPPED;
+
+	for (int i = 0; i < TEST_FREQUENCY; i++)
+	{
+		tone[i] = (short)(TEST_AMPLITUDE * sin(2.0 * M_PI * 440 * i / TEST_FREQUENCY));
+	}
+
+	device = alcOpenDevice(NULL);
+	if (device == NULL)
+	{
+		printf("alcOpenDevice failed\n");
+		return EXIT_FAILURE;
+	}
+
+	context = alcCreateContext(device, NULL);
+	if (context == NULL || !alcMakeContextCurrent(context))
+	{
+		printf("alcCreateContext failed: 0x%04X\n", alcGetError(device));
+		return EXIT_FAILURE;
+	}
+
+	alGenBuffers(1, &buffer);
+	alBufferData(buffer, AL_FORMAT_MONO16, tone, sizeof(tone), TEST_FREQUENCY);
+
+	alGenSources(1, &source);
+	alSourcei(source, AL_LOOPING, AL_TRUE);
+	alSourcei(source, AL_BUFFER, buffer);
+	alSourcePlay(source);
+
+	usleep(TEST_PLAY_TIME);
+
+	alGetSourcei(source, AL_SOURCE_STATE, &state);
+	alcGetIntegerv(device, ALC_UNDERRUN_COUNT_NGS, 1, &underruns);
+	alcGetIntegerv(device, ALC_OUTPUT_LATENCY_NGS, 1, &latency);
+
+	printf("state 0x%04X, output latency %d us, underruns %d\n", state, latency, underruns);
+
+	alSourceStop(source);
+	alSourcei(source, AL_BUFFER, 0);
+	alDeleteSources(1, &source);
+	alDeleteBuffers(1, &buffer);
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+	if (state != AL_PLAYING || underruns != 0)
+	{
+		printf("steady playback must not underrun\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,419 @@
+#include <kernel.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+unsigned int sceLibcHeapSize = 200 * 1024 * 1024;
+
+// Session written by alRecordStartNGS/alRecordStopNGS, a path given on the command line takes precedence
+#define REPLAY_FILE "ux0:data/session.alrec"
+
+// Off: render the recorded time through a loopback device as fast as the library allows, which is the benchmark.
+// On: sleep out the recorded gaps against the paced null device, which reproduces the session as it ran
+//#define REPLAY_AT_RECORDED_TIMING
+
+#define REPLAY_FREQUENCY 48000
+#define REPLAY_RENDER_FRAMES 1024
+#define REPLAY_MAX_NAMES 65536
+#define REPLAY_MAX_BLOBS 4096
+
+#define RECORD_FILE_MAGIC 0x43524C41
+#define RECORD_FILE_VERSION 1
+
+// Mirrors RecordOp and the record layouts in OpenALHW/record.h
+enum
+{
+	RecordOp_GenSources = 1,
+	RecordOp_DeleteSources,
+	RecordOp_GenBuffers,
+	RecordOp_DeleteBuffers,
+	RecordOp_BufferBlob,
+	RecordOp_BufferData,
+	RecordOp_Sourcef,
+	RecordOp_Source3f,
+	RecordOp_Sourcei,
+	RecordOp_SourcePlay,
+	RecordOp_SourceStop,
+	RecordOp_SourceRewind,
+	RecordOp_SourcePause,
+	RecordOp_SourceQueueBuffers,
+	RecordOp_SourceUnqueueBuffers,
+	RecordOp_Listenerf,
+	RecordOp_Listener3f,
+	RecordOp_Listenerfv,
+	RecordOp_Listeneri,
+	RecordOp_DopplerFactor,
+	RecordOp_DopplerVelocity,
+	RecordOp_SpeedOfSound,
+	RecordOp_DistanceModel,
+	RecordOp_DeferUpdates,
+	RecordOp_ProcessUpdates
+};
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+} RecordFileHeader;
+
+typedef struct
+{
+	uint32_t delta;
+	uint32_t op;
+	uint32_t size;
+} RecordHeader;
+
+typedef struct
+{
+	ALuint object;
+	ALint count;
+} RecordObjects;
+
+typedef struct
+{
+	ALuint object;
+	ALenum param;
+	ALint count;
+} RecordValues;
+
+typedef struct
+{
+	uint64_t hash;
+	uint32_t size;
+	uint32_t reserved;
+} RecordBlob;
+
+typedef struct
+{
+	uint64_t hash;
+	ALuint buffer;
+	ALenum format;
+	ALsizei size;
+	ALsizei frequency;
+} RecordBufferData;
+
+typedef struct
+{
+	uint64_t hash;
+	const void *data;
+	uint32_t size;
+} Blob;
+
+// Names handed out during replay differ from the recorded ones, recorded name -> replayed name
+static ALuint s_names[REPLAY_MAX_NAMES];
+static Blob s_blobs[REPLAY_MAX_BLOBS];
+static int s_blobCount = 0;
+static ALuint s_scratch[REPLAY_MAX_NAMES];
+
+static ALuint mapName(ALuint name)
+{
+	return (name < REPLAY_MAX_NAMES) ? s_names[name] : 0;
+}
+
+static const Blob *findBlob(uint64_t hash)
+{
+	int i = 0;
+
+	for (i = 0; i < s_blobCount; i++)
+	{
+		if (s_blobs[i].hash == hash)
+		{
+			return &s_blobs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void replayObjects(uint32_t op, const RecordObjects *rec)
+{
+	const ALuint *names = (const ALuint *)(rec + 1);
+	ALint count = rec->count;
+	ALint i = 0;
+
+	if (count < 0 || count > REPLAY_MAX_NAMES)
+	{
+		return;
+	}
+
+	switch (op)
+	{
+	case RecordOp_GenSources:
+	case RecordOp_GenBuffers:
+		if (op == RecordOp_GenSources)
+			alGenSources(count, s_scratch);
+		else
+			alGenBuffers(count, s_scratch);
+
+		for (i = 0; i < count; i++)
+		{
+			if (names[i] < REPLAY_MAX_NAMES)
+			{
+				s_names[names[i]] = s_scratch[i];
+			}
+		}
+		break;
+	case RecordOp_DeleteSources:
+	case RecordOp_DeleteBuffers:
+		for (i = 0; i < count; i++)
+		{
+			s_scratch[i] = mapName(names[i]);
+		}
+
+		if (op == RecordOp_DeleteSources)
+			alDeleteSources(count, s_scratch);
+		else
+			alDeleteBuffers(count, s_scratch);
+		break;
+	case RecordOp_SourcePlay:
+		alSourcePlay(mapName(rec->object));
+		break;
+	case RecordOp_SourceStop:
+		alSourceStop(mapName(rec->object));
+		break;
+	case RecordOp_SourceRewind:
+		alSourceRewind(mapName(rec->object));
+		break;
+	case RecordOp_SourcePause:
+		alSourcePause(mapName(rec->object));
+		break;
+	case RecordOp_SourceQueueBuffers:
+		for (i = 0; i < count; i++)
+		{
+			s_scratch[i] = mapName(names[i]);
+		}
+
+		alSourceQueueBuffers(mapName(rec->object), count, s_scratch);
+		break;
+	case RecordOp_SourceUnqueueBuffers:
+		alSourceUnqueueBuffers(mapName(rec->object), count, s_scratch);
+		break;
+	}
+}
+
+static void replayValues(uint32_t op, const RecordValues *rec)
+{
+	const ALfloat *f = (const ALfloat *)(rec + 1);
+	const ALint *i = (const ALint *)(rec + 1);
+	ALuint object = mapName(rec->object);
+
+	switch (op)
+	{
+	case RecordOp_Sourcef:
+		alSourcef(object, rec->param, f[0]);
+		break;
+	case RecordOp_Source3f:
+		alSource3f(object, rec->param, f[0], f[1], f[2]);
+		break;
+	case RecordOp_Sourcei:
+		// AL_BUFFER carries a buffer name, everything else is a plain value
+		alSourcei(object, rec->param, (rec->param == AL_BUFFER) ? (ALint)mapName(i[0]) : i[0]);
+		break;
+	case RecordOp_Listenerf:
+		alListenerf(rec->param, f[0]);
+		break;
+	case RecordOp_Listener3f:
+		alListener3f(rec->param, f[0], f[1], f[2]);
+		break;
+	case RecordOp_Listenerfv:
+		alListenerfv(rec->param, f);
+		break;
+	case RecordOp_Listeneri:
+		alListeneri(rec->param, i[0]);
+		break;
+	case RecordOp_DopplerFactor:
+		alDopplerFactor(f[0]);
+		break;
+	case RecordOp_DopplerVelocity:
+		alDopplerVelocity(f[0]);
+		break;
+	case RecordOp_SpeedOfSound:
+		alSpeedOfSound(f[0]);
+		break;
+	case RecordOp_DistanceModel:
+		alDistanceModel(i[0]);
+		break;
+	case RecordOp_DeferUpdates:
+		alDeferUpdatesSOFT();
+		break;
+	case RecordOp_ProcessUpdates:
+		alProcessUpdatesSOFT();
+		break;
+	}
+}
+
+static void replayRecord(uint32_t op, const void *payload)
+{
+	const RecordBlob *blob = NULL;
+	const RecordBufferData *data = NULL;
+	const Blob *stored = NULL;
+
+	switch (op)
+	{
+	case RecordOp_BufferBlob:
+		blob = (const RecordBlob *)payload;
+		if (s_blobCount < REPLAY_MAX_BLOBS)
+		{
+			s_blobs[s_blobCount].hash = blob->hash;
+			s_blobs[s_blobCount].data = blob + 1;
+			s_blobs[s_blobCount].size = blob->size;
+			s_blobCount++;
+		}
+		break;
+	case RecordOp_BufferData:
+		data = (const RecordBufferData *)payload;
+		stored = findBlob(data->hash);
+		alBufferData(mapName(data->buffer), data->format, stored ? stored->data : NULL, stored ? (ALsizei)stored->size : 0, data->frequency);
+		break;
+	case RecordOp_GenSources:
+	case RecordOp_DeleteSources:
+	case RecordOp_GenBuffers:
+	case RecordOp_DeleteBuffers:
+	case RecordOp_SourcePlay:
+	case RecordOp_SourceStop:
+	case RecordOp_SourceRewind:
+	case RecordOp_SourcePause:
+	case RecordOp_SourceQueueBuffers:
+	case RecordOp_SourceUnqueueBuffers:
+		replayObjects(op, (const RecordObjects *)payload);
+		break;
+	default:
+		replayValues(op, (const RecordValues *)payload);
+		break;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int returnCode = SCE_OK;
+	const char *path = (argc > 1) ? argv[1] : REPLAY_FILE;
+	uint8_t *session = NULL;
+	unsigned int sessionSize = 0;
+	unsigned int offset = sizeof(RecordFileHeader);
+	unsigned int records = 0;
+	SceUInt64 recordedTime = 0;
+	SceUInt64 renderTime = 0;
+	SceUInt64 start = 0;
+	SceUInt64 mark = 0;
+
+	SceUID fd = sceIoOpen(path, SCE_O_RDONLY, 0);
+	if (fd < 0)
+	{
+		printf("cannot open %s\n", path);
+		abort();
+	}
+	sessionSize = sceIoLseek(fd, 0, SCE_SEEK_END);
+	sceIoLseek(fd, 0, SCE_SEEK_SET);
+	session = malloc(sessionSize);
+	sceIoRead(fd, session, sessionSize);
+	sceIoClose(fd);
+
+	if (sessionSize < sizeof(RecordFileHeader) || ((RecordFileHeader *)session)->magic != RECORD_FILE_MAGIC || ((RecordFileHeader *)session)->version != RECORD_FILE_VERSION)
+	{
+		printf("%s is not a recorded session\n", path);
+		abort();
+	}
+
+	returnCode = sceKernelLoadStartModule("app0:module/OpenALHW.suprx", 0, NULL, 0, NULL, NULL);
+	if (returnCode <= 0)
+	{
+		printf("sceKernelLoadStartModule failed: 0x%08X\n", returnCode);
+		abort();
+	}
+
+	// Initialization
+	ALCcontext *context;
+	ALCdevice *device = NULL;
+
+#ifdef REPLAY_AT_RECORDED_TIMING
+	ALCint attrs[] = { ALC_NULL_PACED_NGS, ALC_TRUE, 0 };
+
+	device = alcOpenDevice("Null");
+	if (!device)
+	{
+		printf("alcOpenDevice failed\n");
+		abort();
+	}
+#else
+	ALCint attrs[] = { ALC_FREQUENCY, REPLAY_FREQUENCY, ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT, ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT, 0 };
+	int16_t *mix = malloc(REPLAY_RENDER_FRAMES * 2 * sizeof(int16_t));
+	SceUInt64 pendingFrames = 0;
+
+	device = alcLoopbackOpenDeviceSOFT(NULL);
+	if (!device)
+	{
+		printf("alcLoopbackOpenDeviceSOFT failed\n");
+		abort();
+	}
+#endif
+
+	context = alcCreateContext(device, attrs);
+	if (!context)
+	{
+		printf("alcCreateContext failed\n");
+		abort();
+	}
+
+	alcMakeContextCurrent(context);
+
+	start = sceKernelGetProcessTimeWide();
+
+	while (offset + sizeof(RecordHeader) <= sessionSize)
+	{
+		const RecordHeader *header = (const RecordHeader *)(session + offset);
+
+		if (offset + sizeof(RecordHeader) + header->size > sessionSize)
+		{
+			printf("session truncated after %u records\n", records);
+			break;
+		}
+
+		recordedTime += header->delta;
+
+#ifdef REPLAY_AT_RECORDED_TIMING
+		if (header->delta > 0)
+		{
+			sceKernelDelayThread(header->delta);
+		}
+#else
+		// The mixer advances by exactly the time that passed between the two calls in the session
+		pendingFrames += (SceUInt64)header->delta * REPLAY_FREQUENCY;
+
+		mark = sceKernelGetProcessTimeWide();
+
+		while (pendingFrames >= 1000000ULL * REPLAY_RENDER_FRAMES)
+		{
+			alcRenderSamplesSOFT(device, mix, REPLAY_RENDER_FRAMES);
+			pendingFrames -= 1000000ULL * REPLAY_RENDER_FRAMES;
+		}
+
+		renderTime += sceKernelGetProcessTimeWide() - mark;
+#endif
+
+		replayRecord(header->op, header + 1);
+
+		offset += sizeof(RecordHeader) + header->size;
+		records++;
+	}
+
+	SceUInt64 elapsed = sceKernelGetProcessTimeWide() - start;
+
+	printf("replayed %u records covering %llu us in %llu us\n", records, (unsigned long long)recordedTime, (unsigned long long)elapsed);
+	printf("rendering took %llu us, AL calls took %llu us\n", (unsigned long long)renderTime, (unsigned long long)(elapsed - renderTime));
+
+	alcDestroyContext(context);
+	alcCloseDevice(device);
+
+#ifndef REPLAY_AT_RECORDED_TIMING
+	free(mix);
+#endif
+	free(session);
+
+	return returnCode;
+}
@@ -0,0 +1,146 @@
+/*
+ * Converts a dump written by alTraceDumpNGS into Chrome trace event JSON,
+ * which chrome://tracing and Perfetto open directly.
+ *
+ * Host side tool, build with any C compiler:
+ *
+ *     cc -O2 -o altrace2json altrace2json.c
+ *     altrace2json trace.bin trace.json
+ *
+ * The layout mirrors TraceFileHeader and TraceFileEvent in OpenALHW/trace.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define AL_TRACE_FILE_MAGIC		(0x52544C41)
+#define AL_TRACE_FILE_VERSION	(1)
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t nameCount;
+	uint32_t eventCount;
+} TraceFileHeader;
+
+typedef struct
+{
+	uint64_t begin;
+	uint32_t duration;
+	uint32_t thread;
+	uint32_t name;
+	uint32_t object;
+	int32_t arg;
+	uint32_t reserved;
+} TraceFileEvent;
+
+static void freeNames(char **names, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+	{
+		free(names[i]);
+	}
+
+	free(names);
+}
+
+int main(int argc, char **argv)
+{
+	TraceFileHeader header;
+	TraceFileEvent ev;
+	char **names = NULL;
+	uint32_t length = 0;
+	uint32_t i = 0;
+	FILE *in = NULL;
+	FILE *out = NULL;
+
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s <trace.bin> <trace.json>\n", argv[0]);
+		return 1;
+	}
+
+	in = fopen(argv[1], "rb");
+	if (in == NULL)
+	{
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	if (fread(&header, sizeof(header), 1, in) != 1 || header.magic != AL_TRACE_FILE_MAGIC || header.version != AL_TRACE_FILE_VERSION)
+	{
+		fprintf(stderr, "%s is not a trace dump\n", argv[1]);
+		fclose(in);
+		return 1;
+	}
+
+	names = (char **)calloc(header.nameCount ? header.nameCount : 1, sizeof(char *));
+	if (names == NULL)
+	{
+		fclose(in);
+		return 1;
+	}
+
+	for (i = 0; i < header.nameCount; i++)
+	{
+		if (fread(&length, sizeof(length), 1, in) != 1 || length > 4096)
+		{
+			fprintf(stderr, "truncated name table\n");
+			freeNames(names, header.nameCount);
+			fclose(in);
+			return 1;
+		}
+
+		names[i] = (char *)calloc(length + 1, 1);
+		if (names[i] == NULL || fread(names[i], 1, length, in) != length)
+		{
+			fprintf(stderr, "truncated name table\n");
+			freeNames(names, header.nameCount);
+			fclose(in);
+			return 1;
+		}
+	}
+
+	out = fopen(argv[2], "w");
+	if (out == NULL)
+	{
+		fprintf(stderr, "cannot open %s\n", argv[2]);
+		freeNames(names, header.nameCount);
+		fclose(in);
+		return 1;
+	}
+
+	// Timestamps are already microseconds, which is what the trace event format expects
+	fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (i = 0; i < header.eventCount; i++)
+	{
+		if (fread(&ev, sizeof(ev), 1, in) != 1)
+		{
+			fprintf(stderr, "dump ends after %u of %u events\n", i, header.eventCount);
+			break;
+		}
+
+		fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"al\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%u,\"args\":{\"object\":%u,\"arg\":%d}}",
+			(i == 0) ? "" : ",\n",
+			(ev.name < header.nameCount) ? names[ev.name] : "unknown",
+			ev.thread,
+			(unsigned long long)ev.begin,
+			ev.duration,
+			ev.object,
+			ev.arg);
+	}
+
+	fprintf(out, "\n]}\n");
+
+	fclose(out);
+	fclose(in);
+	freeNames(names, header.nameCount);
+
+	return 0;
+}